@@ -0,0 +1,604 @@
+//
+// Created by Shinnosuke Kawai on 4/6/26.
+//
+
+#pragma once
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "postgres_error.h"
+#include "query_future.h"
+#include "internal/type_detail.h"
+#include "result/arrow.h"
+#include "result/colunm.h"
+
+namespace database {
+    // Receives the raw binary COPY stream (header, tuples, trailer) chunk by chunk on the
+    // DB worker thread. An error stops delivery and fails the copy_out() call with it.
+    using copy_sink = std::function<std::expected<void, sql_error>(std::span<const std::byte>)>;
+
+    // Receives each record batch of copy_out_arrow() on the DB worker thread. The batch may be
+    // moved out of schema/array (leaving their release null); whatever is left is released after
+    // the call. An error stops the copy, as for copy_sink.
+    using arrow_batch_handler = std::function<std::expected<void, sql_error>(ArrowSchema*, ArrowArray*)>;
+
+    // Sink writing the raw COPY stream to a file descriptor owned by the caller; the output
+    // can be loaded back with COPY ... FROM (FORMAT binary).
+    inline copy_sink fd_sink(const int fd) {
+        return [fd](std::span<const std::byte> data) -> std::expected<void, sql_error> {
+            while (!data.empty()) {
+#ifdef _WIN32
+                const int n = _write(fd, data.data(), static_cast<unsigned>(data.size()));
+#else
+                const ssize_t n = ::write(fd, data.data(), data.size());
+#endif
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    return std::unexpected(sql_error::CopyFailed("failed to write COPY data to fd"));
+                }
+                data = data.subspan(static_cast<std::size_t>(n));
+            }
+            return {};
+        };
+    }
+}
+
+namespace database::internal {
+    // PostgreSQL binary COPY framing: signature, flags word, header extension length.
+    inline constexpr std::string_view kCopySignature{"PGCOPY\n\377\r\n\0", 11};
+
+    inline void AppendCopyHeader(std::string& out) {
+        out.append(kCopySignature);
+        AppendFixed(out, std::int32_t{0}); // flags: no OIDs
+        AppendFixed(out, std::int32_t{0}); // no header extension
+    }
+
+    inline void AppendCopyTrailer(std::string& out) {
+        AppendFixed(out, std::int16_t{-1});
+    }
+
+    // One field of a binary COPY tuple: int32 length (-1 for NULL) followed by the same
+    // bytes AppendBinary produces for a query parameter.
+    inline void AppendCopyField(std::string& out, const supported_type& value) {
+        if (std::holds_alternative<std::nullptr_t>(value)) {
+            AppendFixed(out, std::int32_t{-1});
+            return;
+        }
+        const std::size_t at = out.size();
+        AppendFixed(out, std::int32_t{0});
+        AppendBinary(out, value);
+        PatchLength(out, at);
+    }
+
+    // Binary COPY carries no type OIDs, so the column a field is decoded as is inferred from
+    // the requested C++ type and the field width, the same pairs colum::as<T>() accepts.
+    template<typename T>
+    constexpr Oid CopyFieldOid(const std::int32_t len) noexcept {
+        namespace oid = result::pg_oid;
+        if constexpr (std::is_same_v<T, bool>)
+            return oid::Bool;
+        else if constexpr (std::is_same_v<T, std::int16_t>)
+            return oid::Int2;
+        else if constexpr (std::is_same_v<T, std::int32_t>)
+            return len == 2 ? oid::Int2 : oid::Int4;
+        else if constexpr (std::is_same_v<T, std::int64_t>)
+            return len == 2 ? oid::Int2 : len == 4 ? oid::Int4 : oid::Int8;
+        else if constexpr (std::is_same_v<T, std::uint16_t>)
+            return oid::Int4;
+        else if constexpr (std::is_same_v<T, std::uint32_t>)
+            return oid::Int8;
+        else if constexpr (std::is_same_v<T, std::uint64_t>)
+            return oid::Numeric;
+        else if constexpr (std::is_same_v<T, float>)
+            return oid::Float4;
+        else if constexpr (std::is_same_v<T, double>)
+            return len == 4 ? oid::Float4 : oid::Float8;
+        else if constexpr (std::is_same_v<T, std::string>)
+            return oid::Text;
+        else if constexpr (std::is_same_v<T, std::vector<std::byte>>)
+            return oid::Bytea;
+        else if constexpr (std::is_same_v<T, result::timestamp>)
+            return oid::Timestamp;
+        else if constexpr (std::is_same_v<T, std::chrono::sys_days>)
+            return oid::Date;
+        else if constexpr (std::is_same_v<T, time_of_day>)
+            return oid::Time;
+        else if constexpr (std::is_same_v<T, interval>)
+            return oid::Interval;
+        else if constexpr (std::is_same_v<T, uuid>)
+            return oid::Uuid;
+        else if constexpr (std::is_same_v<T, inet>)
+            return oid::Inet;
+        else if constexpr (std::is_same_v<T, range<std::int32_t>>)
+            return oid::Int4Range;
+        else if constexpr (std::is_same_v<T, range<std::int64_t>>)
+            return oid::Int8Range;
+        else if constexpr (std::is_same_v<T, range<result::timestamp>>)
+            return oid::TstzRange;
+        else
+            // jsonb is left out on purpose: its text would point into the parse buffer.
+            static_assert(sizeof(T) == 0, "type can't be decoded from a binary COPY field");
+    }
+
+    // One field of a binary COPY tuple, pointing into the stream being parsed.
+    struct copy_field {
+        const std::byte* data;
+        std::int32_t len; // -1 for NULL
+    };
+
+    // Incremental parser for COPY ... TO STDOUT (FORMAT binary). Input may be split anywhere;
+    // only the unparsed tail of a chunk is kept between calls. Subclasses receive whole tuples.
+    class copy_out_parser {
+    public:
+        explicit copy_out_parser(const std::size_t field_count) : m_fields(field_count) {}
+        virtual ~copy_out_parser() = default;
+
+        copy_out_parser(const copy_out_parser&) = delete;
+        copy_out_parser& operator=(const copy_out_parser&) = delete;
+
+        std::expected<void, sql_error> feed(const std::span<const std::byte> data) {
+            std::span<const std::byte> input = data;
+            if (!m_pending.empty()) {
+                m_pending.insert(m_pending.end(), data.begin(), data.end());
+                input = m_pending;
+            }
+            std::size_t pos = 0;
+            auto parsed = Parse(input, pos);
+            if (m_pending.empty())
+                m_pending.assign(input.begin() + static_cast<std::ptrdiff_t>(pos), input.end());
+            else
+                m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(pos));
+            return parsed;
+        }
+
+    protected:
+        // fields are only valid during the call.
+        virtual std::expected<void, sql_error> OnRow(std::span<const copy_field> fields) = 0;
+        virtual std::expected<void, sql_error> OnTrailer() { return {}; }
+
+    private:
+        std::expected<void, sql_error> Parse(const std::span<const std::byte> in, std::size_t& pos) {
+            using result::pg_detail::ReadBigEndian;
+            constexpr std::size_t kHeaderSize = 19; // signature + flags + extension length
+            if (!m_header_done) {
+                if (in.size() < kHeaderSize)
+                    return {};
+                if (std::memcmp(in.data(), kCopySignature.data(), kCopySignature.size()) != 0)
+                    return std::unexpected(sql_error::CopyFailed("invalid binary COPY signature"));
+                const auto ext_len = ReadBigEndian<std::int32_t>(in.data() + 15);
+                if (ext_len < 0)
+                    return std::unexpected(sql_error::CopyFailed("invalid binary COPY header"));
+                if (in.size() < kHeaderSize + static_cast<std::size_t>(ext_len))
+                    return {};
+                pos = kHeaderSize + static_cast<std::size_t>(ext_len);
+                m_header_done = true;
+            }
+
+            while (pos < in.size()) {
+                if (m_trailer_seen)
+                    return std::unexpected(sql_error::CopyFailed("data after binary COPY trailer"));
+                if (in.size() - pos < 2)
+                    return {};
+                const auto count = ReadBigEndian<std::int16_t>(in.data() + pos);
+                if (count == -1) {
+                    pos += 2;
+                    m_trailer_seen = true;
+                    if (auto done = OnTrailer(); !done)
+                        return done;
+                    continue;
+                }
+                if (count != static_cast<std::int16_t>(m_fields.size()))
+                    return std::unexpected(sql_error::CopyFailed("COPY tuple field count doesn't match the requested types"));
+
+                std::size_t p = pos + 2;
+                for (auto& field : m_fields) {
+                    if (in.size() - p < 4)
+                        return {};
+                    field.len = ReadBigEndian<std::int32_t>(in.data() + p);
+                    p += 4;
+                    field.data = in.data() + p;
+                    if (field.len < 0)
+                        continue;
+                    if (in.size() - p < static_cast<std::size_t>(field.len))
+                        return {};
+                    p += static_cast<std::size_t>(field.len);
+                }
+
+                if (auto row = OnRow(m_fields); !row)
+                    return row;
+                pos = p;
+            }
+            return {};
+        }
+
+    private:
+        std::vector<copy_field> m_fields;
+        std::vector<std::byte> m_pending;
+        bool m_header_done = false;
+        bool m_trailer_seen = false;
+    };
+
+    // Decodes every tuple into std::optional<Ts>... for a row callback.
+    template<typename... Ts>
+    class copy_out_decoder final : public copy_out_parser {
+    public:
+        using row_type = std::tuple<std::optional<Ts>...>;
+
+        explicit copy_out_decoder(std::function<void(row_type)> on_row)
+        : copy_out_parser(sizeof...(Ts)), m_on_row(std::move(on_row)) {}
+
+    protected:
+        std::expected<void, sql_error> OnRow(const std::span<const copy_field> fields) override {
+            std::expected<row_type, sql_error> row = DecodeRow(fields, std::index_sequence_for<Ts...>{});
+            if (!row)
+                return std::unexpected(row.error());
+            m_on_row(std::move(*row));
+            return {};
+        }
+
+    private:
+        template<std::size_t... I>
+        static std::expected<row_type, sql_error> DecodeRow(const std::span<const copy_field> fields, std::index_sequence<I...>) {
+            row_type row;
+            const bool ok = (DecodeField<Ts>(fields[I], std::get<I>(row)) && ...);
+            if (!ok)
+                return std::unexpected(sql_error::CopyFailed("COPY field can't be decoded as the requested type"));
+            return row;
+        }
+
+        template<typename T>
+        static bool DecodeField(const copy_field& field, std::optional<T>& out) {
+            if (field.len < 0)
+                return true; // NULL
+            const result::colum column{CopyFieldOid<T>(field.len), reinterpret_cast<const char*>(field.data), field.len, false};
+            out = column.as<T>();
+            return out.has_value();
+        }
+
+    private:
+        std::function<void(row_type)> m_on_row;
+    };
+
+    // The Arrow type a COPY field requested as T is exported as.
+    template<typename T>
+    constexpr result::arrow_type ArrowTypeOf() noexcept {
+        using result::arrow_type;
+        if constexpr (std::is_same_v<T, bool>)
+            return arrow_type::Bool;
+        else if constexpr (std::is_same_v<T, std::int16_t>)
+            return arrow_type::Int16;
+        else if constexpr (std::is_same_v<T, std::int32_t>)
+            return arrow_type::Int32;
+        else if constexpr (std::is_same_v<T, std::int64_t>)
+            return arrow_type::Int64;
+        else if constexpr (std::is_same_v<T, std::uint16_t>)
+            return arrow_type::UInt16;
+        else if constexpr (std::is_same_v<T, std::uint32_t>)
+            return arrow_type::UInt32;
+        else if constexpr (std::is_same_v<T, std::uint64_t>)
+            return arrow_type::UInt64;
+        else if constexpr (std::is_same_v<T, float>)
+            return arrow_type::Float32;
+        else if constexpr (std::is_same_v<T, double>)
+            return arrow_type::Float64;
+        else if constexpr (std::is_same_v<T, result::timestamp>)
+            return arrow_type::Timestamp;
+        else if constexpr (std::is_same_v<T, std::string>)
+            return arrow_type::Utf8;
+        else if constexpr (std::is_same_v<T, std::vector<std::byte>>)
+            return arrow_type::Binary;
+        else
+            static_assert(sizeof(T) == 0, "type has no Arrow export");
+    }
+
+    // Decodes the tuples straight into Arrow column buffers and hands them on every batch_rows
+    // rows, and once more for the rest at the trailer.
+    template<typename... Ts>
+    class copy_out_arrow_decoder final : public copy_out_parser {
+    public:
+        copy_out_arrow_decoder(std::vector<std::string> names, const std::size_t batch_rows, arrow_batch_handler on_batch)
+        : copy_out_parser(sizeof...(Ts)), m_batch_rows(batch_rows == 0 ? 1 : batch_rows), m_on_batch(std::move(on_batch)) {
+            constexpr std::array<result::arrow_type, sizeof...(Ts)> types{ArrowTypeOf<Ts>()...};
+            m_columns.reserve(types.size());
+            for (std::size_t i = 0; i < types.size(); ++i)
+                m_columns.emplace_back(types[i], i < names.size() ? std::move(names[i]) : "f" + std::to_string(i));
+            for (auto& column : m_columns)
+                column.reserve(m_batch_rows);
+        }
+
+    protected:
+        std::expected<void, sql_error> OnRow(const std::span<const copy_field> fields) override {
+            const bool ok = AppendRow(fields, std::index_sequence_for<Ts...>{});
+            if (!ok)
+                return std::unexpected(sql_error::CopyFailed("COPY field can't be decoded as the requested type"));
+            if (++m_rows == m_batch_rows)
+                return Flush();
+            return {};
+        }
+
+        std::expected<void, sql_error> OnTrailer() override {
+            // An empty copy still yields one (empty) batch so the consumer sees the schema.
+            if (m_rows > 0 || !m_flushed)
+                return Flush();
+            return {};
+        }
+
+    private:
+        template<std::size_t... I>
+        bool AppendRow(const std::span<const copy_field> fields, std::index_sequence<I...>) {
+            return (AppendField<Ts>(m_columns[I], fields[I]) && ...);
+        }
+
+        template<typename T>
+        static bool AppendField(result::pg_detail::arrow_column& column, const copy_field& field) {
+            if (field.len < 0) {
+                column.append_null();
+                return true;
+            }
+            if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<std::byte>>) {
+                column.append({field.data, static_cast<std::size_t>(field.len)});
+                return true;
+            } else {
+                const result::colum cell{CopyFieldOid<T>(field.len), reinterpret_cast<const char*>(field.data), field.len, false};
+                const std::optional<T> value = cell.as<T>();
+                if (!value)
+                    return false;
+                if constexpr (std::is_same_v<T, bool>) {
+                    column.append_bool(*value);
+                } else if constexpr (std::is_same_v<T, result::timestamp>) {
+                    const std::int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(value->time_since_epoch()).count();
+                    column.append(std::as_bytes(std::span{&us, 1}));
+                } else {
+                    column.append(std::as_bytes(std::span{&*value, 1}));
+                }
+                return true;
+            }
+        }
+
+        std::expected<void, sql_error> Flush() {
+            ArrowSchema schema{};
+            ArrowArray array{};
+            result::pg_detail::ExportBatch(m_columns, static_cast<std::int64_t>(m_rows), &schema, &array);
+            m_rows = 0;
+            m_flushed = true;
+            std::expected<void, sql_error> handled;
+            try {
+                handled = m_on_batch(&schema, &array);
+            } catch (...) {
+                handled = std::unexpected(sql_error::CopyFailed("Arrow batch handler threw"));
+            }
+            if (array.release)
+                array.release(&array);
+            if (schema.release)
+                schema.release(&schema);
+            for (auto& column : m_columns)
+                column.reserve(m_batch_rows);
+            return handled;
+        }
+
+    private:
+        std::vector<result::pg_detail::arrow_column> m_columns;
+        std::size_t m_batch_rows;
+        std::size_t m_rows = 0;
+        bool m_flushed = false;
+        arrow_batch_handler m_on_batch;
+    };
+
+    // Bounded hand-off of encoded COPY data from a copy_writer to the DB worker running
+    // the COPY. The bound is what throttles a producer that outruns the socket. A writer that
+    // goes idle_timeout without pushing or closing while the worker has nothing to send times
+    // the COPY out, so an abandoned writer can't hold the connection; zero waits forever.
+    class copy_in_channel {
+    public:
+        using clock = std::chrono::steady_clock;
+        enum class pop_status { chunk, finished, aborted, stopped, timed_out };
+
+        explicit copy_in_channel(const std::size_t max_pending, const clock::duration idle_timeout = {}) noexcept
+        : m_max_pending(max_pending), m_idle_timeout(idle_timeout) {}
+
+        // Producer side. Blocks while the worker is max_pending chunks behind.
+        std::expected<void, sql_error> push(std::string&& chunk) {
+            std::unique_lock lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_failure || m_chunks.size() < m_max_pending; });
+            if (m_failure)
+                return std::unexpected(*m_failure);
+            m_chunks.emplace_back(std::move(chunk));
+            m_active = clock::now();
+            std::function<void()> notify = m_notify;
+            lock.unlock();
+            m_cv.notify_all();
+            if (notify)
+                notify();
+            return {};
+        }
+
+        void close(const bool abort) noexcept {
+            std::function<void()> notify;
+            {
+                std::lock_guard lock(m_mutex);
+                (abort ? m_aborted : m_finished) = true;
+                m_active = clock::now();
+                notify = m_notify;
+            }
+            m_cv.notify_all();
+            if (notify)
+                notify();
+        }
+
+        // For an event-loop worker that can't block in pop(): notify runs on the producer's
+        // thread after every push() and close(). Pass nullptr to stop notifications.
+        void set_notify(std::function<void()> notify) {
+            std::lock_guard lock(m_mutex);
+            m_notify = std::move(notify);
+        }
+
+        // Worker side. Pending chunks are handed out before the writer's finish is reported.
+        pop_status pop(std::string& out, const std::stop_token& st) {
+            std::unique_lock lock(m_mutex);
+            const auto ready = [&] { return m_aborted || m_finished || !m_chunks.empty(); };
+            if (m_idle_timeout == clock::duration::zero()) {
+                m_cv.wait(lock, st, ready);
+            } else {
+                while (!m_cv.wait_until(lock, st, m_active + m_idle_timeout, ready) && !st.stop_requested()) {
+                    if (clock::now() >= m_active + m_idle_timeout)
+                        return pop_status::timed_out;
+                }
+            }
+            return Take(lock, out).value_or(pop_status::stopped);
+        }
+
+        // Non-blocking pop; nullopt while the writer has neither sent data nor finished and
+        // idle_deadline() hasn't passed.
+        std::optional<pop_status> try_pop(std::string& out) {
+            std::unique_lock lock(m_mutex);
+            std::optional<pop_status> status = Take(lock, out);
+            if (!status && m_idle_timeout != clock::duration::zero() && clock::now() >= m_active + m_idle_timeout)
+                return pop_status::timed_out;
+            return status;
+        }
+
+        // When an idle writer times the COPY out, as things stand; max() without a timeout.
+        [[nodiscard]] clock::time_point idle_deadline() {
+            std::lock_guard lock(m_mutex);
+            return m_idle_timeout == clock::duration::zero() ? clock::time_point::max() : m_active + m_idle_timeout;
+        }
+
+        // Unblocks the producer for good once the COPY can no longer succeed.
+        void fail(const sql_error& error) noexcept {
+            {
+                std::lock_guard lock(m_mutex);
+                if (!m_failure)
+                    m_failure = error;
+                m_chunks.clear();
+            }
+            m_cv.notify_all();
+        }
+
+    private:
+        std::optional<pop_status> Take(std::unique_lock<std::mutex>& lock, std::string& out) {
+            if (m_aborted)
+                return pop_status::aborted;
+            if (!m_chunks.empty()) {
+                out = std::move(m_chunks.front());
+                m_chunks.pop_front();
+                // The writer's silence counts from when the worker ran out of data, not from
+                // pushes it made while the COPY was still queued.
+                m_active = clock::now();
+                lock.unlock();
+                m_cv.notify_all();
+                return pop_status::chunk;
+            }
+            if (m_finished)
+                return pop_status::finished;
+            return std::nullopt;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable_any m_cv;
+        std::deque<std::string> m_chunks;
+        std::size_t m_max_pending;
+        clock::duration m_idle_timeout;
+        clock::time_point m_active = clock::now(); // last push, close or chunk handed out
+        bool m_finished = false;
+        bool m_aborted = false;
+        std::optional<sql_error> m_failure = std::nullopt;
+        std::function<void()> m_notify;
+    };
+}
+
+namespace database {
+    // Typed writer for COPY ... FROM STDIN (FORMAT binary), obtained from postgres_client::copy_in().
+    // Each write() encodes one tuple with the same encoders used for query parameters, so the
+    // accepted C++ types and their PostgreSQL column types match execute(). The COPY holds the
+    // connection until finish(): don't wait on other queries of the same client in between. A
+    // writer that stays silent for ClientConfig::copy_idle_timeout has its COPY ended with TimeOut.
+    // Dropping the writer without finish() aborts the COPY and nothing is inserted.
+    class copy_writer {
+    public:
+        static constexpr std::size_t kChunkBytes = 64 * 1024;
+        static constexpr std::size_t kMaxPendingChunks = 8;
+
+        copy_writer(std::shared_ptr<internal::copy_in_channel> channel, query_future<std::expected<std::size_t, sql_error>> done)
+        : m_channel(std::move(channel)), m_done(std::move(done)) {
+            m_buffer.reserve(kChunkBytes);
+            internal::AppendCopyHeader(m_buffer);
+        }
+
+        ~copy_writer() {
+            if (m_channel && !m_finished)
+                m_channel->close(true);
+        }
+
+        copy_writer(copy_writer&&) noexcept = default;
+        copy_writer& operator=(copy_writer&&) noexcept = delete;
+        copy_writer(const copy_writer&) = delete;
+        copy_writer& operator=(const copy_writer&) = delete;
+
+        template<typename... Args>
+        std::expected<void, sql_error> write(Args&&... fields) {
+            static_assert(sizeof...(fields) > 0, "a COPY tuple needs at least one field");
+            if (m_finished)
+                return std::unexpected(sql_error::QueryFailed("copy already finished"));
+            internal::AppendFixed(m_buffer, static_cast<std::int16_t>(sizeof...(fields)));
+            (internal::AppendCopyField(m_buffer, internal::CreateSingleData(std::forward<Args>(fields))), ...);
+            if (m_buffer.size() < kChunkBytes)
+                return {};
+            return Flush();
+        }
+
+        template<typename... Args>
+        std::expected<void, sql_error> write_row(const std::tuple<Args...>& row) {
+            return std::apply([this](const auto&... fields) { return write(fields...); }, row);
+        }
+
+        // Sends the trailer and waits for the server; yields the number of rows copied.
+        std::expected<std::size_t, sql_error> finish() {
+            if (m_finished)
+                return std::unexpected(sql_error::QueryFailed("copy already finished"));
+            m_finished = true;
+            internal::AppendCopyTrailer(m_buffer);
+            if (auto flushed = Flush(); !flushed) {
+                m_channel->close(true);
+            } else {
+                m_channel->close(false);
+            }
+            return m_done.get();
+        }
+
+    private:
+        std::expected<void, sql_error> Flush() {
+            std::string chunk;
+            chunk.reserve(kChunkBytes);
+            chunk.swap(m_buffer);
+            return m_channel->push(std::move(chunk));
+        }
+
+    private:
+        std::shared_ptr<internal::copy_in_channel> m_channel;
+        query_future<std::expected<std::size_t, sql_error>> m_done;
+        std::string m_buffer;
+        bool m_finished = false;
+    };
+}
@@ -0,0 +1,74 @@
+//
+// Created by Shinnosuke Kawai on 4/25/26.
+//
+
+#pragma once
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include "postgres_error.h"
+#include "query_future.h"
+#include "result/table.h"
+
+namespace database {
+    class transaction;
+
+    struct cursor_options {
+        // Result size each FETCH aims for; the row count follows from the row width seen so far.
+        std::size_t batch_bytes = 4 * 1024 * 1024;
+        // Rows in the first FETCH, before any row has been seen.
+        std::size_t initial_rows = 1024;
+        std::size_t min_rows = 16;
+        std::size_t max_rows = 1 << 20;
+    };
+
+    // A server-side cursor from transaction::declare_cursor(), read in batches with FETCH. The
+    // next FETCH is always on the connection while the caller works on the current batch, so a
+    // scan costs one round trip up front rather than one per batch. It shares ownership of its
+    // transaction, but the server-side cursor only lives as long as the transaction does: finish
+    // or close it before commit().
+    class cursor {
+    public:
+        cursor(cursor&& other) noexcept;
+        cursor(const cursor&) = delete;
+        cursor& operator=(const cursor&) = delete;
+        cursor& operator=(cursor&&) = delete;
+        ~cursor();
+
+        // Waits for the batch in flight and requests the one after it before returning.
+        // nullopt once the cursor is exhausted. An error ends the cursor, and, as for any failed
+        // statement, aborts the transaction.
+        std::expected<std::optional<result::table>, sql_error> next();
+
+        [[nodiscard]] bool done() const noexcept { return m_done; }
+        // Rows asked for by the FETCH in flight (or the next one).
+        [[nodiscard]] std::size_t fetch_rows() const noexcept { return m_fetch_rows; }
+
+        // Sends CLOSE and waits for it; a DECLARE that failed and wasn't seen by next() is reported
+        // here. The destructor only queues the CLOSE and doesn't wait.
+        std::expected<void, sql_error> close();
+
+    private:
+        friend class transaction;
+        cursor(std::shared_ptr<transaction> txn, std::string name, const cursor_options& options,
+               query_future<std::expected<result::table, sql_error>> declared);
+
+        void Fetch();
+        void Adapt(const result::table& batch) noexcept;
+
+    private:
+        std::shared_ptr<transaction> m_txn;
+        std::string m_name;
+        cursor_options m_options;
+        query_future<std::expected<result::table, sql_error>> m_declared;
+        query_future<std::expected<result::table, sql_error>> m_pending;
+        std::size_t m_pending_rows = 0;
+        std::size_t m_fetch_rows = 0;
+        double m_row_bytes = 0;
+        bool m_declare_ok = false;
+        bool m_done = false;
+        bool m_closed = false;
+    };
+}
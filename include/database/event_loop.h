@@ -0,0 +1,117 @@
+//
+// Created by Shinnosuke Kawai on 4/9/26.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "internal/callback_pool.h"
+
+namespace database {
+    struct EventLoopConfig {
+        // Reactor threads. Every client is pinned to one of them for its whole life.
+        std::size_t num_threads = 1;
+        // Threads running execute_async() callbacks for all clients on the loop.
+        std::size_t num_cb_threads = 2;
+    };
+
+    // Drives many postgres_client connections from a few threads: each reactor thread waits
+    // on the sockets of its clients (epoll on Linux, poll elsewhere) and advances whichever
+    // is ready. Pass it through ClientConfig::loop; clients share ownership of it.
+    class event_loop {
+    public:
+        class reactor;
+
+        explicit event_loop(const EventLoopConfig& config = {});
+        ~event_loop();
+
+        event_loop(const event_loop&) = delete;
+        event_loop& operator=(const event_loop&) = delete;
+
+        // Round-robin pick of the reactor a new client is pinned to.
+        reactor& assign() noexcept;
+        void post_callback(std::function<void()> task) noexcept;
+        [[nodiscard]] std::size_t size() const noexcept { return m_reactors.size(); }
+
+    private:
+        std::vector<std::unique_ptr<reactor>> m_reactors;
+        std::atomic_size_t m_next = 0;
+        // Held by pointer so a loop dropped on one of its own threads can hand it to the thread
+        // that tears it down.
+        std::unique_ptr<internal::callback_pool> m_callbacks = std::make_unique<internal::callback_pool>();
+    };
+
+    // One thread multiplexing socket readiness, posted tasks and timers. Everything but
+    // post() must be called on the reactor's own thread; handlers always run there.
+    class event_loop::reactor {
+    public:
+        using task = std::function<void()>;
+        // Receives the ready events, in poll() terms (POLLIN, POLLOUT, POLLERR, POLLHUP).
+        using io_handler = std::function<void(short revents)>;
+        using timer_id = std::uint64_t;
+        using time_point = std::chrono::steady_clock::time_point;
+
+        reactor();
+        ~reactor();
+
+        reactor(const reactor&) = delete;
+        reactor& operator=(const reactor&) = delete;
+
+        // Thread-safe. Tasks run in posting order.
+        void post(task fn);
+        [[nodiscard]] bool in_loop_thread() const noexcept;
+
+        // A handler may unwatch or re-watch its own fd.
+        void watch(int fd, short events, io_handler handler);
+        void modify(int fd, short events) noexcept;
+        void unwatch(int fd) noexcept;
+
+        timer_id run_at(time_point when, task fn);
+        // Cancelling a timer that already ran (or 0) is a no-op.
+        void cancel(timer_id id) noexcept;
+
+    private:
+        struct watcher {
+            short events;
+            io_handler handler;
+        };
+        using timer_queue = std::multimap<time_point, std::pair<timer_id, task>>;
+
+        void Run(const std::stop_token& st) noexcept;
+        void Wake() noexcept;
+        void RunPosted() noexcept;
+        void RunDueTimers() noexcept;
+        int NextTimeoutMs() const noexcept;
+        void Dispatch(int fd, short revents) noexcept;
+        void WaitForEvents(int timeout_ms) noexcept;
+
+    private:
+        std::mutex m_post_mutex;
+        std::vector<task> m_posted;
+        std::vector<task> m_running; // reactor thread only
+        std::atomic_bool m_wake_pending = false;
+        std::atomic<std::thread::id> m_loop_thread{};
+
+        std::unordered_map<int, std::shared_ptr<watcher>> m_watchers;
+        timer_queue m_timers;
+        std::unordered_map<timer_id, timer_queue::iterator> m_timer_index;
+        timer_id m_last_timer = 0;
+
+#ifdef __linux__
+        int m_epoll_fd = -1;
+        int m_wake_fd = -1;
+#elif !defined(_WIN32)
+        int m_wake_pipe[2] = {-1, -1};
+#endif
+        std::jthread m_thread;
+    };
+}
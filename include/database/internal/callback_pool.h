@@ -0,0 +1,63 @@
+//
+// Created by Shinnosuke Kawai on 4/9/26.
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ring_buffer.h"
+
+namespace database::internal {
+    // Runs execute_async() callbacks off the DB worker. A callback may block on another query
+    // of the same client, so when every worker is busy the task gets a thread of its own
+    // instead of waiting behind the blocked one.
+    class callback_pool {
+    public:
+        callback_pool() = default;
+        ~callback_pool();
+
+        callback_pool(const callback_pool&) = delete;
+        callback_pool& operator=(const callback_pool&) = delete;
+
+        void start(std::size_t num_threads);
+        void post(std::function<void()> task) noexcept;
+        // Runs what is already queued, then joins every worker.
+        void stop() noexcept;
+        // True on one of this pool's threads, where post() runs the task inline.
+        [[nodiscard]] bool on_worker_thread() const noexcept;
+
+    private:
+        struct overflow_callback_thread {
+            std::shared_ptr<std::atomic_bool> done;
+            std::jthread thread;
+        };
+
+        static void reap_overflow_threads(std::list<overflow_callback_thread>& threads) noexcept {
+            for (auto it = threads.begin(); it != threads.end();) {
+                if (it->done->load(std::memory_order_acquire)) {
+                    it = threads.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        void Worker(const std::stop_token& st) noexcept;
+
+    private:
+        std::mutex m_mutex;
+        std::mutex m_temp_mutex;
+        std::condition_variable m_cv;
+        std::atomic_uint32_t m_idle_workers = 0;
+        ring_buffer<std::function<void()>> m_queue;
+        std::list<overflow_callback_thread> m_overflow_threads;
+        std::vector<std::jthread> m_workers;
+    };
+}
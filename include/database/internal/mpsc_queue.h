@@ -0,0 +1,80 @@
+//
+// Created by Shinnosuke Kawai on 4/16/26.
+//
+
+#pragma once
+#include <atomic>
+#include <utility>
+#include "object_pool.h"
+
+namespace database::internal {
+    // Lock-free multi-producer / single-consumer FIFO. Producers push onto an atomic stack with
+    // one CAS; the consumer takes the whole stack with one exchange when its own list runs dry
+    // and reverses it, so items come out in push order. Everything but push() is consumer-only.
+    template<typename T>
+    class mpsc_queue {
+    public:
+        mpsc_queue() = default;
+        ~mpsc_queue() {
+            Free(m_incoming.exchange(nullptr, std::memory_order_acquire));
+            Free(m_ready);
+        }
+
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+        void push(T&& value) {
+            node* item = new node(std::move(value));
+            node* head = m_incoming.load(std::memory_order_relaxed);
+            do {
+                item->next = head;
+            } while (!m_incoming.compare_exchange_weak(head, item, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // nullptr when nothing is queued.
+        [[nodiscard]] T* front() noexcept {
+            if (m_ready == nullptr)
+                Collect();
+            return m_ready != nullptr ? &m_ready->value : nullptr;
+        }
+
+        [[nodiscard]] bool empty() noexcept { return front() == nullptr; }
+
+        // Requires front() != nullptr.
+        T pop_front() noexcept {
+            node* item = m_ready;
+            m_ready = item->next;
+            T value = std::move(item->value);
+            delete item;
+            return value;
+        }
+
+    private:
+        // Recycled through pooled<>, so a warm queue doesn't touch the global allocator.
+        struct node : pooled<node> {
+            explicit node(T&& value) noexcept : value(std::move(value)) {}
+            T value;
+            node* next = nullptr;
+        };
+
+        void Collect() noexcept {
+            node* stack = m_incoming.exchange(nullptr, std::memory_order_acquire);
+            while (stack != nullptr) {
+                node* next = stack->next;
+                stack->next = m_ready;
+                m_ready = stack;
+                stack = next;
+            }
+        }
+
+        static void Free(node* list) noexcept {
+            while (list != nullptr)
+                delete std::exchange(list, list->next);
+        }
+
+    private:
+        // Producers hammer this line; keep the consumer's list off it.
+        alignas(64) std::atomic<node*> m_incoming = nullptr;
+        alignas(64) node* m_ready = nullptr;
+    };
+}
@@ -0,0 +1,72 @@
+//
+// Created by Shinnosuke Kawai on 4/17/26.
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace database::internal {
+    // Gives T a class-level operator new/delete that recycles its blocks instead of returning them
+    // to the global allocator. A freed block goes onto a shared lock-free stack with one CAS; a
+    // thread whose own cache is empty takes that whole stack with one exchange, so there is no
+    // pop race (and no ABA) to guard against. Blocks are kept for the life of the process, so
+    // the pool settles at the peak number of live objects.
+    template<typename T>
+    class pooled {
+    public:
+        static void* operator new(const std::size_t size) {
+            if (size == sizeof(T)) {
+                if (void* block = Acquire())
+                    return block;
+            }
+            return ::operator new(size);
+        }
+
+        static void operator delete(void* ptr, const std::size_t size) noexcept {
+            if (size == sizeof(T)) {
+                Release(ptr);
+                return;
+            }
+            ::operator delete(ptr, size);
+        }
+
+    private:
+        struct free_block {
+            free_block* next;
+        };
+
+        struct local_cache {
+            free_block* head = nullptr;
+            // Thread exit: hand the cached blocks back to the other threads.
+            ~local_cache() {
+                while (head != nullptr)
+                    Release(std::exchange(head, head->next));
+            }
+        };
+
+        static void* Acquire() noexcept {
+            static_assert(sizeof(T) >= sizeof(free_block));
+            static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+            thread_local local_cache cache;
+            if (cache.head == nullptr)
+                cache.head = s_shared.exchange(nullptr, std::memory_order_acquire);
+            if (cache.head == nullptr)
+                return nullptr;
+            return std::exchange(cache.head, cache.head->next);
+        }
+
+        static void Release(void* ptr) noexcept {
+            auto* block = static_cast<free_block*>(ptr);
+            free_block* head = s_shared.load(std::memory_order_relaxed);
+            do {
+                block->next = head;
+            } while (!s_shared.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+    private:
+        static constinit inline std::atomic<free_block*> s_shared = nullptr;
+    };
+}
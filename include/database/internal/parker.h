@@ -0,0 +1,58 @@
+//
+// Created by Shinnosuke Kawai on 4/16/26.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace database::internal {
+    // Parks a single consumer thread until a producer has work for it. unpark() only issues a
+    // wake (futex on Linux, WaitOnAddress on Windows) when the consumer is actually parked; a
+    // busy consumer costs producers one load.
+    class parker {
+    public:
+        using time_point = std::chrono::steady_clock::time_point;
+
+        parker() = default;
+        parker(const parker&) = delete;
+        parker& operator=(const parker&) = delete;
+
+        // Consumer side. Sleeps until unpark() or deadline unless ready() already holds. ready()
+        // is checked after the park is announced, so work published before an unpark() is never
+        // missed. May return spuriously; callers loop.
+        template<typename Ready>
+        void park(Ready&& ready, const time_point deadline = time_point::max()) noexcept {
+            m_state.store(parked, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!ready())
+                Wait(deadline);
+            m_state.store(running, std::memory_order_relaxed);
+        }
+
+        // Producer side, after publishing the work.
+        void unpark() noexcept {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_state.load(std::memory_order_relaxed) == parked
+                && m_state.exchange(running, std::memory_order_acq_rel) == parked)
+                Wake();
+        }
+
+    private:
+        static constexpr std::uint32_t running = 0;
+        static constexpr std::uint32_t parked = 1;
+
+        void Wait(time_point deadline) noexcept;
+        void Wake() noexcept;
+
+    private:
+        std::atomic<std::uint32_t> m_state = running;
+#if !defined(__linux__) && !defined(_WIN32)
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+#endif
+    };
+}
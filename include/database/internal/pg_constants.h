@@ -0,0 +1,49 @@
+//
+// Created by Shinnosuke Kawai on 5/3/26.
+//
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace database::internal {
+    // PostgreSQL epoch starts at 2000-01-01 00:00:00 UTC (Unix epoch + 946684800s).
+    inline constexpr std::int64_t kPgEpochOffsetUs = 946684800LL * 1'000'000LL;
+    inline constexpr std::chrono::sys_days kPgEpochDate{std::chrono::days{10957}};
+
+    // Microseconds since the PostgreSQL epoch, rebased to the Unix epoch. 'infinity' and
+    // '-infinity' (INT64_MAX/MIN) are kept as they are; finite values saturate instead of overflowing.
+    constexpr std::int64_t UnixMicrosFromPg(const std::int64_t us) noexcept {
+        constexpr std::int64_t kMax = std::numeric_limits<std::int64_t>::max();
+        if (us > kMax - kPgEpochOffsetUs)
+            return kMax;
+        if (us == std::numeric_limits<std::int64_t>::min())
+            return us;
+        return us + kPgEpochOffsetUs;
+    }
+
+    // The same as a system_clock time point; infinities and anything outside the clock's range
+    // become time_point::max()/min().
+    constexpr std::chrono::system_clock::time_point TimestampFromPg(const std::int64_t us) noexcept {
+        using namespace std::chrono;
+        using time_point = system_clock::time_point;
+        constexpr std::int64_t kMaxUs = duration_cast<microseconds>(time_point::max().time_since_epoch()).count();
+        constexpr std::int64_t kMinUs = duration_cast<microseconds>(time_point::min().time_since_epoch()).count();
+        const std::int64_t unix_us = UnixMicrosFromPg(us);
+        if (unix_us >= kMaxUs)
+            return time_point::max();
+        if (unix_us <= kMinUs)
+            return time_point::min();
+        return time_point{duration_cast<time_point::duration>(microseconds{unix_us})};
+    }
+
+    // Range flag bits, from PostgreSQL's rangetypes.h.
+    namespace range_flag {
+        inline constexpr std::uint8_t Empty = 0x01;
+        inline constexpr std::uint8_t LowerInclusive = 0x02;
+        inline constexpr std::uint8_t UpperInclusive = 0x04;
+        inline constexpr std::uint8_t LowerInfinite = 0x08;
+        inline constexpr std::uint8_t UpperInfinite = 0x10;
+    }
+}
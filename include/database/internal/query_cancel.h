@@ -0,0 +1,48 @@
+//
+// Created by Shinnosuke Kawai on 4/20/26.
+//
+
+#pragma once
+#include <libpq-fe.h>
+
+namespace database::internal {
+    // Asks the server to stop whatever a connection is running, over a separate short-lived
+    // connection (the protocol's CancelRequest). On libpq 17+ the cancel is non-blocking and is
+    // driven by socket readiness like any other connection. Older libpq only has the blocking
+    // PQcancel(), which start() then runs to completion on the spot.
+    class query_cancel {
+    public:
+        query_cancel() = default;
+        ~query_cancel() { reset(); }
+
+        query_cancel(const query_cancel&) = delete;
+        query_cancel& operator=(const query_cancel&) = delete;
+
+        // Drops any cancel still in flight first. False if libpq couldn't send the cancel.
+        bool start(PGconn* conn) noexcept;
+        // Call once socket() is ready for events(). False once the cancel has finished.
+        bool advance() noexcept;
+        void reset() noexcept;
+
+        [[nodiscard]] bool in_progress() const noexcept;
+        // Only meaningful while in_progress().
+        [[nodiscard]] int socket() const noexcept;
+        [[nodiscard]] short events() const noexcept { return m_events; }
+
+        // Whether start() blocks (libpq before 17). A caller that mustn't block takes a handle
+        // with PQgetCancel() and passes it to send() on another thread instead.
+#ifdef LIBPQ_HAS_ASYNC_CANCEL
+        static constexpr bool kBlocking = false;
+#else
+        static constexpr bool kBlocking = true;
+#endif
+        // Sends the cancel with the blocking PQcancel() and frees the handle.
+        static bool send(PGcancel* cancel) noexcept;
+
+    private:
+#ifdef LIBPQ_HAS_ASYNC_CANCEL
+        PGcancelConn* m_conn = nullptr;
+#endif
+        short m_events = 0;
+    };
+}
@@ -0,0 +1,57 @@
+//
+// Created by Shinnosuke Kawai on 4/17/26.
+//
+
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace database::internal {
+    // FIFO over a power-of-two vector that doubles when full and never shrinks, so a queue
+    // that has reached its working size stops allocating (std::deque frees and reallocates
+    // its blocks as items flow through). Not thread-safe.
+    template<typename T>
+    class ring_buffer {
+    public:
+        [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+        [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+        void push_back(T&& value) {
+            if (m_size == m_slots.size())
+                Grow();
+            m_slots[(m_head + m_size) & (m_slots.size() - 1)] = std::move(value);
+            ++m_size;
+        }
+
+        // front()/back()/pop_front() require !empty().
+        T& front() noexcept { return m_slots[m_head]; }
+        T& back() noexcept { return m_slots[(m_head + m_size - 1) & (m_slots.size() - 1)]; }
+
+        T pop_front() noexcept {
+            T value = std::move(m_slots[m_head]);
+            m_head = (m_head + 1) & (m_slots.size() - 1);
+            --m_size;
+            return value;
+        }
+
+        void clear() noexcept {
+            while (!empty())
+                pop_front();
+        }
+
+    private:
+        void Grow() {
+            std::vector<T> grown(m_slots.empty() ? 16 : m_slots.size() * 2);
+            for (std::size_t i = 0; i < m_size; ++i)
+                grown[i] = std::move(m_slots[(m_head + i) & (m_slots.size() - 1)]);
+            m_slots = std::move(grown);
+            m_head = 0;
+        }
+
+    private:
+        std::vector<T> m_slots;
+        std::size_t m_head = 0;
+        std::size_t m_size = 0;
+    };
+}
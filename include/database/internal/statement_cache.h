@@ -0,0 +1,101 @@
+//
+// Created by Shinnosuke Kawai on 4/2/26.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <postgres_ext.h>
+
+namespace database::internal {
+    // LRU map from query text and parameter types to the name of the server-side prepared
+    // statement holding them. A statement is prepared with its parameters' types, so the same
+    // text sent with other types is a different statement. Owned by a single connection and
+    // only touched by its worker.
+    class statement_cache {
+    public:
+        struct lookup {
+            const std::string& name;
+            // False when the statement still has to be prepared under `name`.
+            bool prepared;
+            // Statement pushed out to make room; the caller DEALLOCATEs it.
+            std::optional<std::string> evicted;
+        };
+
+        explicit statement_cache(const std::size_t capacity) noexcept : m_capacity(capacity) {}
+
+        statement_cache(const statement_cache&) = delete;
+        statement_cache& operator=(const statement_cache&) = delete;
+
+        [[nodiscard]] bool enabled() const noexcept { return m_capacity > 0; }
+        [[nodiscard]] std::size_t size() const noexcept { return m_entries.size(); }
+        [[nodiscard]] std::size_t capacity() const noexcept { return m_capacity; }
+
+        // Returns the statement for query, inserting (and possibly evicting) on a miss.
+        // Requires enabled().
+        lookup acquire(const std::string_view query, const std::span<const Oid> types = {}) {
+            const std::string_view key = Key(query, types);
+            if (const auto it = m_index.find(key); it != m_index.end()) {
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                return {it->second->name, true, std::nullopt};
+            }
+
+            std::optional<std::string> evicted;
+            if (m_entries.size() >= m_capacity) {
+                entry& last = m_entries.back();
+                m_index.erase(last.key);
+                evicted = std::move(last.name);
+                m_entries.pop_back();
+            }
+            m_entries.push_front({std::string{key}, "pgcpp_stmt_" + std::to_string(++m_counter)});
+            m_index.emplace(m_entries.front().key, m_entries.begin());
+            return {m_entries.front().name, false, std::move(evicted)};
+        }
+
+        // Forgets query without deallocating it, e.g. after its PREPARE failed or the
+        // server reported the statement as missing or stale.
+        void erase(const std::string_view query, const std::span<const Oid> types = {}) noexcept {
+            const auto it = m_index.find(Key(query, types));
+            if (it == m_index.end())
+                return;
+            const auto entry_it = it->second;
+            m_index.erase(it);
+            m_entries.erase(entry_it);
+        }
+
+        // Prepared statements live as long as the server session; call after a reset.
+        void clear() noexcept {
+            m_index.clear();
+            m_entries.clear();
+        }
+
+    private:
+        struct entry {
+            std::string key;
+            std::string name;
+        };
+
+        // The query itself when there are no types, else the query, a NUL and the raw OIDs
+        // (which a query can't contain), built in a buffer reused across calls.
+        std::string_view Key(const std::string_view query, const std::span<const Oid> types) {
+            if (types.empty())
+                return query;
+            m_key.assign(query);
+            m_key.push_back('\0');
+            m_key.append(reinterpret_cast<const char*>(types.data()), types.size_bytes());
+            return m_key;
+        }
+
+        std::size_t m_capacity;
+        std::uint64_t m_counter = 0;
+        std::list<entry> m_entries; // most recently used first
+        std::unordered_map<std::string_view, std::list<entry>::iterator> m_index;
+        std::string m_key;
+    };
+}
@@ -3,16 +3,26 @@
 //
 
 #pragma once
+#include <array>
 #include <bit>
 #include <chrono>
 #include <cstring>
+#include <functional>
 #include <iomanip>
 #include <print>
+#include <ranges>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <span>
+#include <utility>
 #include <variant>
 #include <vector>
+#include <postgres_ext.h>
+#include "../pg_types.h"
+#include "../result/colunm.h"
+#include "pg_constants.h"
 
 namespace database {
     using timestamp = std::chrono::system_clock::time_point;
@@ -20,43 +30,179 @@ namespace database {
                                         bool,
                                         int16_t, int32_t, int64_t, uint16_t, uint32_t, uint64_t,
                                         double, float,
-                                        const char*, char*, std::string,
-                                        std::vector<std::byte>,
-                                        timestamp>;
+                                        const char*, char*, std::string, std::string_view,
+                                        std::vector<std::byte>, std::span<const std::byte>,
+                                        timestamp, std::chrono::sys_days, time_of_day, interval,
+                                        uuid, jsonb, inet,
+                                        range<std::int32_t>, range<std::int64_t>, range<timestamp>>;
 
+    // A query and its parameters in the form libpq's PQsendQueryParams/PQsendQueryPrepared take.
+    // The query text (with its terminator) and every non-NULL value's wire bytes live back to back
+    // in one arena string, and the pointer/length/format arrays sit inside the object for up to
+    // kInlineParams parameters, so building one costs a single allocation. Each parameter is
+    // declared with the type OID of its C++ type (see ParamOid), or 0 to leave it to the server.
+    // Large text and bytea values can bypass the arena: borrowed ones are sent from the caller's
+    // memory, and moved-in strings and vectors are kept here and sent from their own buffers.
+    // For execute_many() it holds several parameter sets for the query, back to back in the same
+    // arena and arrays; the sets share one list of declared types.
     struct pg_param_detail {
-        std::string query;
-        std::vector<std::string> text;      // size == n; empty string for NULL
-        std::vector<const char*> buffers;    // size == n; nullptr for NULL
-        std::vector<int> lengths;           // size == n
-        std::vector<int> formats;           // size == n (all 0)
+        static constexpr std::size_t kInlineParams = 16;
 
         pg_param_detail() = default;
-        explicit pg_param_detail(const std::string_view query, const std::size_t n)
-        : query(std::string{query}), text(n), buffers(n, nullptr), lengths(n, 0), formats(n, 0) {}
+        // sets of n parameters each, all NULL until encoded; value_bytes of arena are reserved for
+        // their bytes.
+        explicit pg_param_detail(const std::string_view query, const std::size_t n, const std::size_t value_bytes = 0,
+                                 const std::size_t sets = 1)
+        : m_query_size(query.size()), m_count(n), m_sets(sets) {
+            m_arena.reserve(query.size() + 1 + value_bytes);
+            m_arena.append(query).push_back('\0');
+            Size(n * sets);
+        }
+
+        // Declares parameter i as type and appends its bytes through encode(std::string& arena).
+        // Parameters have to be encoded in order, and finish() called once they all are. i runs
+        // across the sets: parameter i % count() of set i / count().
+        template<typename Encode>
+        void encode(const std::size_t i, const Oid type, Encode&& encode) {
+            Declare(i, type);
+            const std::size_t at = m_arena.size();
+            std::forward<Encode>(encode)(m_arena);
+            Lengths()[i] = static_cast<int>(m_arena.size() - at);
+            Values()[i] = &kInArena; // finish() sets the real address
+        }
+
+        // Declares parameter i as type and sends size bytes at data as it, without copying them.
+        // They have to stay alive and unchanged until the query completes.
+        void borrow(const std::size_t i, const Oid type, const void* data, const std::size_t size) noexcept {
+            Declare(i, type);
+            Lengths()[i] = static_cast<int>(size);
+            // libpq reads a null pointer as SQL NULL, which an empty span may well have.
+            Values()[i] = size == 0 ? "" : static_cast<const char*>(data);
+        }
+
+        // Same, but the bytes are moved in and live as long as this does. A vector's (or a long
+        // string's) buffer doesn't move with it, so the pointer stays good.
+        void adopt(const std::size_t i, const Oid type, std::string&& value) {
+            m_owned_text.push_back(std::move(value));
+            borrow(i, type, m_owned_text.back().data(), m_owned_text.back().size());
+        }
 
-        [[nodiscard]] int count() const noexcept { return static_cast<int>(buffers.size()); }
+        void adopt(const std::size_t i, const Oid type, std::vector<std::byte>&& value) {
+            m_owned_bytes.push_back(std::move(value));
+            borrow(i, type, m_owned_bytes.back().data(), m_owned_bytes.back().size());
+        }
+
+        // The arena won't grow any more, so the values can point into it.
+        void finish() noexcept {
+            const char* next = m_arena.data() + m_query_size + 1;
+            for (std::size_t i = 0; i < m_count * m_sets; ++i) {
+                if (Values()[i] != &kInArena)
+                    continue;
+                Values()[i] = next;
+                next += Lengths()[i];
+            }
+        }
+
+        [[nodiscard]] std::string_view query() const noexcept { return {m_arena.data(), m_query_size}; }
+        [[nodiscard]] const char* query_c_str() const noexcept { return m_arena.c_str(); }
+        // Parameters per set.
+        [[nodiscard]] int count() const noexcept { return static_cast<int>(m_count); }
+        [[nodiscard]] std::size_t sets() const noexcept { return m_sets; }
+        // nullptr for NULL.
+        [[nodiscard]] const char* const* values(const std::size_t set = 0) const noexcept {
+            return (Inline() ? m_values.data() : m_spill_values.data()) + set * m_count;
+        }
+        [[nodiscard]] const int* lengths(const std::size_t set = 0) const noexcept {
+            return (Inline() ? m_lengths.data() : m_spill_lengths.data()) + set * m_count;
+        }
+        [[nodiscard]] const int* formats() const noexcept { return Inline() ? kBinaryFormats.data() : m_spill_formats.data(); }
+        [[nodiscard]] const Oid* types() const noexcept { return Inline() ? m_types.data() : m_spill_types.data(); }
 
         pg_param_detail (const pg_param_detail&) = delete;
         pg_param_detail& operator=(const pg_param_detail&) = delete;
 
-        pg_param_detail(pg_param_detail&& other) noexcept
-        : query(std::move(other.query)),
-          text(std::move(other.text)),
-          buffers(std::move(other.buffers)),
-          lengths(std::move(other.lengths)),
-          formats(std::move(other.formats)) {}
+        pg_param_detail(pg_param_detail&& other) noexcept {
+            *this = std::move(other);
+        }
 
         pg_param_detail& operator=(pg_param_detail&& other) noexcept {
             if (this != &other) {
-                query = std::move(other.query);
-                text = std::move(other.text);
-                buffers = std::move(other.buffers);
-                lengths = std::move(other.lengths);
-                formats = std::move(other.formats);
+                // A short arena lives inside the string and moves with it, so the value pointers
+                // into it are rebased onto wherever the bytes ended up.
+                const char* old_base = other.m_arena.data();
+                const char* old_end = old_base + other.m_arena.size();
+                m_arena = std::move(other.m_arena);
+                m_query_size = std::exchange(other.m_query_size, 0);
+                m_count = std::exchange(other.m_count, 0);
+                m_sets = std::exchange(other.m_sets, 1);
+                m_values = other.m_values;
+                m_lengths = other.m_lengths;
+                m_types = other.m_types;
+                m_spill_values = std::move(other.m_spill_values);
+                m_spill_lengths = std::move(other.m_spill_lengths);
+                m_spill_formats = std::move(other.m_spill_formats);
+                m_spill_types = std::move(other.m_spill_types);
+                m_owned_text = std::move(other.m_owned_text);
+                m_owned_bytes = std::move(other.m_owned_bytes);
+                if (m_arena.data() != old_base) {
+                    for (std::size_t i = 0; i < m_count * m_sets; ++i) {
+                        if (!std::less<>{}(Values()[i], old_base) && std::less<>{}(Values()[i], old_end))
+                            Values()[i] = m_arena.data() + (Values()[i] - old_base);
+                    }
+                }
             }
             return *this;
         }
+
+    private:
+        // Marks a value encoded into the arena until finish() knows where it is.
+        static constexpr char kInArena = 0;
+
+        static constexpr std::array<int, kInlineParams> kBinaryFormats = [] {
+            std::array<int, kInlineParams> formats{};
+            formats.fill(1);
+            return formats;
+        }();
+
+        [[nodiscard]] bool Inline() const noexcept { return m_count * m_sets <= kInlineParams; }
+        [[nodiscard]] const char** Values() noexcept { return Inline() ? m_values.data() : m_spill_values.data(); }
+        [[nodiscard]] int* Lengths() noexcept { return Inline() ? m_lengths.data() : m_spill_lengths.data(); }
+        [[nodiscard]] Oid* Types() noexcept { return Inline() ? m_types.data() : m_spill_types.data(); }
+
+        void Size(const std::size_t slots) {
+            if (slots <= kInlineParams)
+                return;
+            m_spill_values.assign(slots, nullptr);
+            m_spill_lengths.assign(slots, 0);
+            m_spill_formats.assign(m_count, 1);
+            m_spill_types.assign(m_count, 0);
+        }
+
+        // The first set declares the types; a later set whose type differs (inet against cidr)
+        // leaves that parameter to the server instead.
+        void Declare(const std::size_t i, const Oid type) noexcept {
+            Oid& declared = Types()[i % m_count];
+            if (i < m_count)
+                declared = type;
+            else if (declared != type)
+                declared = 0;
+        }
+
+        std::string m_arena;            // query, '\0', then each non-NULL value's bytes in order
+        std::size_t m_query_size = 0;
+        std::size_t m_count = 0;
+        std::size_t m_sets = 1;
+        std::array<const char*, kInlineParams> m_values{};
+        std::array<int, kInlineParams> m_lengths{};
+        std::array<Oid, kInlineParams> m_types{};
+        // Only used past kInlineParams parameters in all; types and formats hold one set.
+        std::vector<const char*> m_spill_values;
+        std::vector<int> m_spill_lengths;
+        std::vector<int> m_spill_formats;
+        std::vector<Oid> m_spill_types;
+        // Moved-in values, see adopt().
+        std::vector<std::string> m_owned_text;
+        std::vector<std::vector<std::byte>> m_owned_bytes;
     };
 }
 
@@ -69,47 +215,45 @@ namespace database::internal {
                                   std::is_same_v<D, std::span<const std::byte>> ||
                                   (std::is_integral_v<D> && !std::is_same_v<D, bool>) ||
                                   std::is_same_v<D, bool> || std::is_same_v<D, float> || std::is_same_v<D, double> ||
-                                  std::is_same_v<D, std::string> || std::is_same_v<D, char*> || std::is_same_v<D, const char*> ||
-                                  std::is_same_v<D, std::chrono::system_clock::time_point>;
+                                  std::is_same_v<D, std::string> || std::is_same_v<D, std::string_view> ||
+                                  std::is_same_v<D, char*> || std::is_same_v<D, const char*> ||
+                                  std::is_same_v<D, std::chrono::system_clock::time_point> ||
+                                  std::is_same_v<D, std::chrono::sys_days> || std::is_same_v<D, time_of_day> ||
+                                  std::is_same_v<D, interval> || std::is_same_v<D, uuid> || std::is_same_v<D, jsonb> ||
+                                  std::is_same_v<D, inet> || std::is_same_v<D, range<std::int32_t>> ||
+                                  std::is_same_v<D, range<std::int64_t>> || std::is_same_v<D, range<timestamp>>;
         return is_valid;
     };
 
+    // The type an integral parameter is sent as. Unsigned types are widened to the next signed
+    // type because PostgreSQL has no native unsigned integers:
+    //   uint8_t → int16_t (SMALLINT, 2 bytes)
+    //   uint16_t → int32_t (INTEGER, 4 bytes)
+    //   uint32_t → int64_t (BIGINT, 8 bytes)
+    //   uint64_t → uint64_t (kept; encoded as NUMERIC binary)
+    template<typename Integral>
+    using normalized_integral_t =
+        std::conditional_t<std::is_signed_v<Integral>,
+            std::conditional_t<(sizeof(Integral) <= 2), std::int16_t,
+                std::conditional_t<(sizeof(Integral) <= 4), std::int32_t, std::int64_t>>,
+            std::conditional_t<(sizeof(Integral) == 1), std::int16_t,
+                std::conditional_t<(sizeof(Integral) == 2), std::int32_t,
+                    std::conditional_t<(sizeof(Integral) == 4), std::int64_t, std::uint64_t>>>>;
+
     template<typename Integral>
     constexpr supported_type NormalizeIntegral(Integral data)
     {
         using D = std::decay_t<Integral>;
         static_assert(std::is_integral_v<D> && !std::is_same_v<D, bool>, "Integral type must be signed or unsigned");
-        if constexpr (std::is_signed_v<D>) {
-            if constexpr (sizeof(D) <= 2)
-                return supported_type{ static_cast<std::int16_t>(data) };
-            else if constexpr (sizeof(D) <= 4)
-                return supported_type{ static_cast<std::int32_t>(data) };
-            else
-                return supported_type{ static_cast<std::int64_t>(data) };
-        }
-        else {
-            // Unsigned types are widened to the next signed type because PostgreSQL
-            // has no native unsigned integers:
-            //   uint8_t → int16_t (SMALLINT, 2 bytes)
-            //   uint16_t → int32_t (INTEGER, 4 bytes)
-            //   uint32_t → int64_t (BIGINT, 8 bytes)
-            //   uint64_t → uint64_t (kept; ToBinary encodes it as NUMERIC binary)
-            if constexpr (sizeof(D) == 1)
-                return supported_type{ static_cast<std::int16_t>(data) };
-            else if constexpr (sizeof(D) == 2)
-                return supported_type{ static_cast<std::int32_t>(data) };
-            else if constexpr (sizeof(D) == 4)
-                return supported_type{ static_cast<std::int64_t>(data) };
-            else
-                return supported_type{ static_cast<std::uint64_t>(data) };
-        }
+        return supported_type{ static_cast<normalized_integral_t<D>>(data) };
     }
 
     template<class Type>
     constexpr supported_type CreateSingleData(Type&& param)
     {
         static_assert(internal::IsSupported<Type>(),
-            "Allowed types: integral (except bool), bool, float, double, std::string, string literal, Timestamp, vector of std::byte");
+            "Allowed types: integral (except bool), bool, float, double, std::string, std::string_view, string literal, Timestamp, "
+            "vector or span of std::byte, sys_days, time_of_day, interval, uuid, jsonb, inet, range<int32_t/int64_t/timestamp>");
         using D = std::decay_t<Type>;
         if constexpr (std::is_integral_v<D> && !std::is_same_v<D, bool>) {
             return NormalizeIntegral(param);
@@ -118,10 +262,8 @@ namespace database::internal {
             return supported_type {std::forward<Type>(param)};
         }
         else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
-            return supported_type {std::string(param)};
-        }
-        else if constexpr (std::is_same_v<D, std::span<const std::byte>>) {
-            return supported_type {std::vector<std::byte>(param.begin(), param.end())};
+            // Borrowed: the bytes are copied into the parameter arena before the call returns.
+            return supported_type {static_cast<const char*>(param)};
         }
         else {
             return supported_type {param};
@@ -166,110 +308,252 @@ namespace database::internal {
         }
     }
 
+    // Appends a fixed-size integer as big-endian bytes.
+    template<typename T>
+    void AppendFixed(std::string& out, T value) {
+        const T net = ToNetworkOrder(value);
+        out.append(reinterpret_cast<const char*>(&net), sizeof(T));
+    }
+
     // Encodes a fixed-size integer/float type as big-endian bytes into a std::string.
     template<typename T>
     std::string EncodeFixed(T value) noexcept {
-        const T net = ToNetworkOrder(value);
-        std::string out(sizeof(T), '\0');
-        std::memcpy(out.data(), &net, sizeof(T));
+        std::string out;
+        AppendFixed(out, value);
         return out;
     }
 
-    // Encodes a uint64_t as a PostgreSQL NUMERIC binary value (big-endian).
+    // Overwrites the int32 placeholder at offset with the number of bytes appended after it.
+    inline void PatchLength(std::string& out, const std::size_t offset) noexcept {
+        const auto net = ToNetworkOrder(static_cast<std::int32_t>(out.size() - offset - sizeof(std::int32_t)));
+        std::memcpy(out.data() + offset, &net, sizeof(net));
+    }
+
+    // Splits a uint64_t into base-10000 groups, least significant first; returns the group count
+    // and how many low groups are zero (a NUMERIC leaves trailing zero digits out).
+    inline std::pair<std::size_t, std::size_t> NumericGroups(std::uint64_t value, std::array<std::uint16_t, 5>& groups) noexcept {
+        std::size_t n = 0;
+        for (; value > 0; value /= 10000)
+            groups[n++] = static_cast<std::uint16_t>(value % 10000);
+        std::size_t zeros = 0;
+        while (zeros + 1 < n && groups[zeros] == 0)
+            ++zeros;
+        return {n, zeros};
+    }
+
+    inline std::size_t NumericUint64Size(const std::uint64_t value) noexcept {
+        std::array<std::uint16_t, 5> groups{};
+        const auto [n, zeros] = NumericGroups(value, groups);
+        return 8 + (n - zeros) * 2;
+    }
+
+    // Appends a uint64_t as a PostgreSQL NUMERIC binary value (big-endian).
     // Layout: ndigits(2) | weight(2) | sign(2) | dscale(2) | digits[ndigits](2 each)
     // Each digit is a base-10000 group, most significant first.
-    inline std::string EncodeNumericUint64(const std::uint64_t value) noexcept {
-        if (value == 0) {
+    inline void AppendNumericUint64(std::string& out, const std::uint64_t value) {
+        std::array<std::uint16_t, 5> groups{};
+        const auto [n, zeros] = NumericGroups(value, groups);
+        if (n == 0) {
             // ndigits=0, weight=0, sign=NUMERIC_POS=0, dscale=0
-            return {8, '\0'};
+            out.append(8, '\0');
+            return;
         }
+        AppendFixed(out, static_cast<std::int16_t>(n - zeros));
+        AppendFixed(out, static_cast<std::int16_t>(n - 1)); // weight
+        AppendFixed(out, std::int16_t{0}); // sign = NUMERIC_POS
+        AppendFixed(out, std::int16_t{0}); // dscale = 0 (integer)
+        for (std::size_t i = n; i-- > zeros;)
+            AppendFixed(out, groups[i]);
+    }
 
-        std::vector<std::uint16_t> raw;
-        std::uint64_t v = value;
-        while (v > 0) {
-            raw.push_back(static_cast<std::uint16_t>(v % 10000));
-            v /= 10000;
+    inline void AppendTimestamp(std::string& out, const timestamp& tp) {
+        using namespace std::chrono;
+        AppendFixed(out, static_cast<std::int64_t>(duration_cast<microseconds>(tp.time_since_epoch()).count() - kPgEpochOffsetUs));
+    }
+
+    // inet/cidr: family (PGSQL_AF_INET 2 / PGSQL_AF_INET6 3) | bits | is_cidr | nb | address[nb]
+    inline void AppendInet(std::string& out, const inet& value) {
+        out += static_cast<char>(value.af == inet::family::V4 ? 2 : 3);
+        out += static_cast<char>(value.prefix);
+        out += static_cast<char>(value.is_cidr ? 1 : 0);
+        out += static_cast<char>(value.address_size());
+        out.append(reinterpret_cast<const char*>(value.address.data()), value.address_size());
+    }
+
+    template<typename T>
+    std::size_t RangeSize(const range<T>& value) noexcept {
+        if (value.empty)
+            return 1;
+        constexpr std::size_t bound = sizeof(std::int32_t) + (std::is_same_v<T, timestamp> ? sizeof(std::int64_t) : sizeof(T));
+        return 1 + (value.lower ? bound : 0) + (value.upper ? bound : 0);
+    }
+
+    // range: flags byte, then each finite bound as int32 length + the bound's own binary form.
+    template<typename T, typename Append>
+    void AppendRange(std::string& out, const range<T>& value, Append append) {
+        if (value.empty) {
+            out += static_cast<char>(range_flag::Empty);
+            return;
+        }
+        std::uint8_t flags = 0;
+        if (!value.lower)
+            flags |= range_flag::LowerInfinite;
+        else if (value.lower_inclusive)
+            flags |= range_flag::LowerInclusive;
+        if (!value.upper)
+            flags |= range_flag::UpperInfinite;
+        else if (value.upper_inclusive)
+            flags |= range_flag::UpperInclusive;
+        out += static_cast<char>(flags);
+        for (const std::optional<T>* bound : {&value.lower, &value.upper}) {
+            if (!*bound)
+                continue;
+            const std::size_t at = out.size();
+            AppendFixed(out, std::int32_t{0});
+            append(out, **bound);
+            PatchLength(out, at);
         }
-        std::reverse(raw.begin(), raw.end()); // most-significant first
+    }
 
-        const auto total_groups = static_cast<std::int16_t>(raw.size());
-        const auto weight = static_cast<int16_t>(total_groups - 1);
+    // Bytes every value of a fixed-width parameter type encodes to; 0 for variable-length types.
+    template<typename T> inline constexpr std::size_t kFixedWidth = 0;
+    template<> inline constexpr std::size_t kFixedWidth<bool> = 1;
+    template<> inline constexpr std::size_t kFixedWidth<std::int16_t> = 2;
+    template<> inline constexpr std::size_t kFixedWidth<std::int32_t> = 4;
+    template<> inline constexpr std::size_t kFixedWidth<std::int64_t> = 8;
+    template<> inline constexpr std::size_t kFixedWidth<std::uint16_t> = 2;
+    template<> inline constexpr std::size_t kFixedWidth<std::uint32_t> = 4;
+    template<> inline constexpr std::size_t kFixedWidth<double> = 8;
+    template<> inline constexpr std::size_t kFixedWidth<float> = 4;
+    template<> inline constexpr std::size_t kFixedWidth<timestamp> = 8;
+    template<> inline constexpr std::size_t kFixedWidth<std::chrono::sys_days> = 4;
+    template<> inline constexpr std::size_t kFixedWidth<time_of_day> = 8;
+    template<> inline constexpr std::size_t kFixedWidth<interval> = 16;
+    template<> inline constexpr std::size_t kFixedWidth<uuid> = 16;
 
-        // Strip trailing zero digits (valid for integer NUMERIC, dscale=0)
-        while (raw.size() > 1 && raw.back() == 0)
-            raw.pop_back();
+    // The type OID a parameter of type T is declared as. Some are left at 0 for the server to
+    // infer: text, so a string still binds to varchar, enum and similar columns; timestamps and
+    // their ranges, whose bytes mean the same instant in a timestamp or a timestamptz column
+    // while a declared type would be converted through the session time zone; and
+    // uint16_t/uint32_t, which only appear when a supported_type is built by hand.
+    template<typename T> inline constexpr Oid kParamOid = 0;
+    template<> inline constexpr Oid kParamOid<bool> = result::pg_oid::Bool;
+    template<> inline constexpr Oid kParamOid<std::int16_t> = result::pg_oid::Int2;
+    template<> inline constexpr Oid kParamOid<std::int32_t> = result::pg_oid::Int4;
+    template<> inline constexpr Oid kParamOid<std::int64_t> = result::pg_oid::Int8;
+    template<> inline constexpr Oid kParamOid<std::uint64_t> = result::pg_oid::Numeric;
+    template<> inline constexpr Oid kParamOid<double> = result::pg_oid::Float8;
+    template<> inline constexpr Oid kParamOid<float> = result::pg_oid::Float4;
+    template<> inline constexpr Oid kParamOid<std::vector<std::byte>> = result::pg_oid::Bytea;
+    template<> inline constexpr Oid kParamOid<std::span<const std::byte>> = result::pg_oid::Bytea;
+    template<> inline constexpr Oid kParamOid<std::chrono::sys_days> = result::pg_oid::Date;
+    template<> inline constexpr Oid kParamOid<time_of_day> = result::pg_oid::Time;
+    template<> inline constexpr Oid kParamOid<interval> = result::pg_oid::Interval;
+    template<> inline constexpr Oid kParamOid<uuid> = result::pg_oid::Uuid;
+    template<> inline constexpr Oid kParamOid<jsonb> = result::pg_oid::Jsonb;
+    template<> inline constexpr Oid kParamOid<inet> = result::pg_oid::Inet;
+    template<> inline constexpr Oid kParamOid<range<std::int32_t>> = result::pg_oid::Int4Range;
+    template<> inline constexpr Oid kParamOid<range<std::int64_t>> = result::pg_oid::Int8Range;
 
-        const auto digitCount = static_cast<std::int16_t>(raw.size());
+    template<typename T>
+    constexpr Oid ParamOid(const T&) noexcept { return kParamOid<T>; }
+    inline Oid ParamOid(const inet& a) noexcept { return a.is_cidr ? result::pg_oid::Cidr : result::pg_oid::Inet; }
 
-        std::string out;
-        out.reserve(8 + digitCount * 2);
-        out += EncodeFixed(digitCount);
-        out += EncodeFixed(weight);
-        out += EncodeFixed(std::int16_t{0}); // sign = NUMERIC_POS
-        out += EncodeFixed(std::int16_t{0}); // dscale = 0 (integer)
-        for (const auto d : raw)
-            out += EncodeFixed(d);
-        return out;
+    // ValueSize(x) is the number of bytes AppendValue(out, x) writes, so a buffer can be sized
+    // once up front. One overload pair per parameter type, in PostgreSQL's binary wire format:
+    // integers/floats: big-endian; text: raw UTF-8 bytes (no null terminator);
+    // bool: 1 byte; timestamp: int64 µs since PostgreSQL epoch (2000-01-01 UTC);
+    // date: int32 days since the same epoch; interval: int64 µs, int32 days, int32 months.
+    template<typename T> requires (kFixedWidth<T> > 0)
+    constexpr std::size_t ValueSize(const T&) noexcept { return kFixedWidth<T>; }
+    inline std::size_t ValueSize(std::nullptr_t) noexcept { return 0; }
+    inline std::size_t ValueSize(const std::uint64_t x) noexcept { return NumericUint64Size(x); }
+    inline std::size_t ValueSize(const std::string& s) noexcept { return s.size(); }
+    inline std::size_t ValueSize(const std::string_view s) noexcept { return s.size(); }
+    inline std::size_t ValueSize(const char* s) noexcept { return s ? std::strlen(s) : 0; }
+    inline std::size_t ValueSize(const std::vector<std::byte>& b) noexcept { return b.size(); }
+    inline std::size_t ValueSize(const std::span<const std::byte> b) noexcept { return b.size(); }
+    inline std::size_t ValueSize(const jsonb& j) noexcept { return 1 + j.text.size(); }
+    inline std::size_t ValueSize(const inet& a) noexcept { return 4 + a.address_size(); }
+    template<typename T>
+    std::size_t ValueSize(const range<T>& r) noexcept { return RangeSize(r); }
+
+    inline void AppendValue(std::string&, std::nullptr_t) noexcept {}
+    inline void AppendValue(std::string& out, const bool b) { out += b ? '\x01' : '\x00'; }
+    inline void AppendValue(std::string& out, const std::int16_t x) { AppendFixed(out, x); }
+    inline void AppendValue(std::string& out, const std::int32_t x) { AppendFixed(out, x); }
+    inline void AppendValue(std::string& out, const std::int64_t x) { AppendFixed(out, x); }
+    inline void AppendValue(std::string& out, const std::uint16_t x) { AppendFixed(out, x); }
+    inline void AppendValue(std::string& out, const std::uint32_t x) { AppendFixed(out, x); }
+    inline void AppendValue(std::string& out, const std::uint64_t x) { AppendNumericUint64(out, x); }
+    inline void AppendValue(std::string& out, const double x) { AppendFixed(out, std::bit_cast<std::uint64_t>(x)); }
+    inline void AppendValue(std::string& out, const float x) { AppendFixed(out, std::bit_cast<std::uint32_t>(x)); }
+    inline void AppendValue(std::string& out, const std::string& s) { out += s; }
+    inline void AppendValue(std::string& out, const std::string_view s) { out += s; }
+    inline void AppendValue(std::string& out, const char* s) { if (s) out += s; }
+    inline void AppendValue(std::string& out, const std::vector<std::byte>& bytes) {
+        out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+    inline void AppendValue(std::string& out, const std::span<const std::byte> bytes) {
+        out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+    inline void AppendValue(std::string& out, const timestamp& tp) { AppendTimestamp(out, tp); }
+    inline void AppendValue(std::string& out, const std::chrono::sys_days d) {
+        AppendFixed(out, static_cast<std::int32_t>((d - kPgEpochDate).count()));
+    }
+    inline void AppendValue(std::string& out, const time_of_day t) { AppendFixed(out, static_cast<std::int64_t>(t.since_midnight.count())); }
+    inline void AppendValue(std::string& out, const interval& i) {
+        AppendFixed(out, static_cast<std::int64_t>(i.time.count()));
+        AppendFixed(out, i.days);
+        AppendFixed(out, i.months);
+    }
+    inline void AppendValue(std::string& out, const uuid& u) { out.append(reinterpret_cast<const char*>(u.bytes.data()), u.bytes.size()); }
+    inline void AppendValue(std::string& out, const jsonb& j) {
+        out += '\x01'; // jsonb binary format version
+        out += j.text;
+    }
+    inline void AppendValue(std::string& out, const inet& a) { AppendInet(out, a); }
+    inline void AppendValue(std::string& out, const range<std::int32_t>& r) {
+        AppendRange(out, r, [](std::string& o, const std::int32_t x) { AppendFixed(o, x); });
+    }
+    inline void AppendValue(std::string& out, const range<std::int64_t>& r) {
+        AppendRange(out, r, [](std::string& o, const std::int64_t x) { AppendFixed(o, x); });
+    }
+    inline void AppendValue(std::string& out, const range<timestamp>& r) { AppendRange(out, r, AppendTimestamp); }
+
+    inline std::size_t BinarySize(const supported_type& v) noexcept
+    {
+        return std::visit([](const auto& x) { return ValueSize(x); }, v);
     }
 
-    // Encodes a SupportedType value into its PostgreSQL binary wire format.
-    // Integers/floats: big-endian; text: raw UTF-8 bytes (no null terminator);
-    // bool: 1 byte; byte: 1 byte; timestamp: int64 µs since PostgreSQL epoch (2000-01-01 UTC).
+    // Appends a SupportedType value in its PostgreSQL binary wire format; see AppendValue.
+    inline void AppendBinary(std::string& out, const supported_type& v)
+    {
+        std::visit([&](const auto& x) { AppendValue(out, x); }, v);
+    }
+
+    // The binary wire form of v as a string of its own; see AppendBinary.
     inline std::string ToBinary(const supported_type& v)
     {
-        return std::visit(Overloaded{
-            [](std::nullptr_t)          -> std::string { return {}; },
-            [](const bool b)     { return std::string(1, b ? '\x01' : '\x00'); },
-            [](const std::int16_t x)    -> std::string { return EncodeFixed(x); },
-            [](const std::int32_t x)    -> std::string { return EncodeFixed(x); },
-            [](const std::int64_t x)    -> std::string { return EncodeFixed(x); },
-            [](const std::uint16_t x)   -> std::string { return EncodeFixed(x); },
-            [](const std::uint32_t x)   -> std::string { return EncodeFixed(x); },
-            [](const std::uint64_t x)   -> std::string { return EncodeNumericUint64(x); },
-            [](const double x)          -> std::string {
-                std::uint64_t bits;
-                std::memcpy(&bits, &x, sizeof(uint64_t));
-                return EncodeFixed(bits);
-            },
-            [](const float x)           -> std::string {
-                std::uint32_t bits;
-                std::memcpy(&bits, &x, sizeof(uint32_t));
-                return EncodeFixed(bits);
-            },
-            [](const std::string& s)    -> std::string { return s; },
-            [](const char* s)           -> std::string { return s ? std::string{s} : std::string{}; },
-            [](const std::vector<std::byte>& bytes) -> std::string {
-                std::string out(bytes.size(), '\0');
-                std::memcpy(out.data(), bytes.data(), bytes.size());
-                return out;
-            },
-            [](const timestamp& tp)     -> std::string {
-                using namespace std::chrono;
-                // PostgreSQL epoch starts at 2000-01-01 00:00:00 UTC (Unix epoch + 946684800s).
-                constexpr std::int64_t kPgEpochOffsetUs = 946684800LL * 1'000'000LL;
-                const auto us = duration_cast<microseconds>(tp.time_since_epoch()).count() - kPgEpochOffsetUs;
-                return EncodeFixed(us);
-            }
-        }, v);
+        std::string out;
+        out.reserve(BinarySize(v));
+        AppendBinary(out, v);
+        return out;
     }
 
     inline pg_param_detail MakePgParamBuffer(const std::string_view query, const std::span<const supported_type> params)
     {
-        pg_param_detail out(query, params.size());
-
+        std::size_t bytes = 0;
+        for (const supported_type& param : params)
+            bytes += BinarySize(param);
+        pg_param_detail out(query, params.size(), bytes);
         for (std::size_t i = 0; i < params.size(); ++i) {
-            out.formats[i] = 1; // binary format for all params
-            if (std::holds_alternative<std::nullptr_t>(params[i])) {
-                out.buffers[i] = nullptr; // SQL NULL — length and format are ignored by libpq
-                out.lengths[i] = 0;
-                continue;
-            }
-
-            out.text[i]     = ToBinary(params[i]);
-            out.buffers[i]  = out.text[i].data();
-            out.lengths[i]  = static_cast<int>(out.text[i].size());
+            // SQL NULL keeps a null pointer; libpq ignores its length and format.
+            if (!std::holds_alternative<std::nullptr_t>(params[i]))
+                out.encode(i, std::visit([](const auto& x) { return ParamOid(x); }, params[i]),
+                           [&](std::string& arena) { AppendBinary(arena, params[i]); });
         }
-
+        out.finish();
         return out;
     }
 
@@ -279,4 +563,108 @@ namespace database::internal {
         return MakePgParamBuffer(query,std::span<const supported_type>(params.data(), params.size()));
     }
 
+    // A parameter as the type it is encoded as, the same one CreateSingleData would store, but
+    // without going through supported_type.
+    template<typename Param>
+    decltype(auto) ParamValue(const Param& param) noexcept {
+        using D = std::decay_t<Param>;
+        if constexpr (std::is_integral_v<D> && !std::is_same_v<D, bool>)
+            return static_cast<normalized_integral_t<D>>(param);
+        else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>)
+            return static_cast<const char*>(param);
+        else
+            return (param);
+    }
+
+    template<typename Param>
+    using param_value_t = std::decay_t<decltype(ParamValue(std::declval<const Param&>()))>;
+
+    // Parameters sent from the caller's memory instead of being copied; see pg_param_detail::borrow().
+    template<typename D>
+    inline constexpr bool kBorrowed = std::is_same_v<D, std::string_view> || std::is_same_v<D, std::span<const std::byte>>;
+
+    // Strings and byte vectors handed over as rvalues; see pg_param_detail::adopt().
+    template<typename Param>
+    inline constexpr bool kAdoptable = !std::is_lvalue_reference_v<Param> && !std::is_const_v<std::remove_reference_t<Param>> &&
+                                       (std::is_same_v<std::remove_cvref_t<Param>, std::string> ||
+                                        std::is_same_v<std::remove_cvref_t<Param>, std::vector<std::byte>>);
+
+    // Adoptable values at least this long are moved in whole; shorter ones cost less to copy into
+    // the arena than to keep (and a short string's bytes would move with it anyway).
+    inline constexpr std::size_t kAdoptBytes = 4096;
+
+    // The bytes param adds to the arena beyond its fixed width.
+    template<typename Param>
+    std::size_t ArenaSize(const std::remove_reference_t<Param>& param) noexcept {
+        if constexpr (kFixedWidth<param_value_t<Param>> > 0 || kBorrowed<param_value_t<Param>>)
+            return 0;
+        else if constexpr (kAdoptable<Param>)
+            return param.size() >= kAdoptBytes ? 0 : param.size();
+        else
+            return ValueSize(ParamValue(param));
+    }
+
+    template<typename Param>
+    void BindParam(pg_param_detail& out, const std::size_t i, Param&& param) {
+        using D = param_value_t<Param>;
+        if constexpr (std::is_same_v<D, std::nullptr_t>) {
+            return; // SQL NULL keeps a null pointer; libpq ignores its length and format.
+        }
+        else if constexpr (kBorrowed<D>) {
+            out.borrow(i, ParamOid(param), param.data(), param.size());
+        }
+        else {
+            if constexpr (kAdoptable<Param>) {
+                if (param.size() >= kAdoptBytes) {
+                    out.adopt(i, ParamOid(param), std::move(param));
+                    return;
+                }
+            }
+            out.encode(i, ParamOid(ParamValue(param)), [&](std::string& arena) { AppendValue(arena, ParamValue(param)); });
+        }
+    }
+
+    // MakePgParamBuffer for parameters whose types are known at compile time: each is encoded
+    // straight from its own type, and the fixed-width ones are sized with a constant, so only
+    // variable-length parameters are measured at run time. string_view and span<const byte>
+    // parameters are borrowed, and large strings and byte vectors passed as rvalues are moved in.
+    template<typename... Params>
+    pg_param_detail MakePgParams(const std::string_view query, Params&&... params)
+    {
+        static_assert((IsSupported<Params>() && ...),
+            "Allowed types: integral (except bool), bool, float, double, std::string, std::string_view, string literal, Timestamp, "
+            "vector or span of std::byte, sys_days, time_of_day, interval, uuid, jsonb, inet, range<int32_t/int64_t/timestamp>");
+        constexpr std::size_t kFixedBytes = (kFixedWidth<param_value_t<Params>> + ... + 0);
+        pg_param_detail out(query, sizeof...(Params), kFixedBytes + (ArenaSize<Params>(params) + ... + 0));
+        std::size_t i = 0;
+        (BindParam(out, i++, std::forward<Params>(params)), ...);
+        out.finish();
+        return out;
+    }
+
+    // MakePgParams for execute_many(): a parameter set per tuple-like row (std::tuple, std::pair,
+    // std::array), all encoded into one detail so the batch reuses a single arena and set of
+    // arrays. rows is walked twice, once to size the arena and once to encode.
+    template<std::ranges::forward_range Rows>
+    pg_param_detail MakePgBatch(const std::string_view query, Rows&& rows)
+    {
+        using Row = std::remove_cvref_t<std::ranges::range_reference_t<Rows>>;
+        std::size_t bytes = 0;
+        for (auto&& row : rows) {
+            std::apply([&](const auto&... params) {
+                static_assert((IsSupported<decltype(params)>() && ...),
+                    "Allowed types: integral (except bool), bool, float, double, std::string, std::string_view, string literal, Timestamp, "
+                    "vector or span of std::byte, sys_days, time_of_day, interval, uuid, jsonb, inet, range<int32_t/int64_t/timestamp>");
+                bytes += ((kFixedWidth<param_value_t<decltype(params)>> + ArenaSize<decltype(params)>(params)) + ... + 0);
+            }, row);
+        }
+        const auto sets = static_cast<std::size_t>(std::ranges::distance(rows));
+        pg_param_detail out(query, std::tuple_size_v<Row>, bytes, sets);
+        std::size_t i = 0;
+        for (auto&& row : rows)
+            std::apply([&](const auto&... params) { (BindParam(out, i++, params), ...); }, row);
+        out.finish();
+        return out;
+    }
+
 } // namespace Database::internal
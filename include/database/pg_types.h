@@ -0,0 +1,128 @@
+//
+// Created by Shinnosuke Kawai on 4/24/26.
+//
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Value types for PostgreSQL types without a natural C++ counterpart. Each is accepted as a query
+// parameter and read back with colum::as<T>(), both in binary format. date columns use
+// std::chrono::sys_days directly.
+namespace database {
+    // uuid, the 16 bytes in wire (RFC 4122) order.
+    struct uuid {
+        std::array<std::byte, 16> bytes{};
+
+        // Accepts the canonical 8-4-4-4-12 hex form, with or without the dashes.
+        static std::optional<uuid> parse(const std::string_view text) noexcept {
+            uuid out;
+            std::size_t n = 0;
+            int high = -1;
+            for (const char ch : text) {
+                if (ch == '-')
+                    continue;
+                int nibble;
+                if (ch >= '0' && ch <= '9')
+                    nibble = ch - '0';
+                else if (ch >= 'a' && ch <= 'f')
+                    nibble = ch - 'a' + 10;
+                else if (ch >= 'A' && ch <= 'F')
+                    nibble = ch - 'A' + 10;
+                else
+                    return std::nullopt;
+                if (high < 0) {
+                    high = nibble;
+                    continue;
+                }
+                if (n == out.bytes.size())
+                    return std::nullopt;
+                out.bytes[n++] = static_cast<std::byte>(high << 4 | nibble);
+                high = -1;
+            }
+            if (n != out.bytes.size() || high >= 0)
+                return std::nullopt;
+            return out;
+        }
+
+        [[nodiscard]] std::string to_string() const {
+            constexpr char kHex[] = "0123456789abcdef";
+            std::string out;
+            out.reserve(36);
+            for (std::size_t i = 0; i < bytes.size(); ++i) {
+                if (i == 4 || i == 6 || i == 8 || i == 10)
+                    out += '-';
+                const auto b = static_cast<unsigned>(bytes[i]);
+                out += kHex[b >> 4];
+                out += kHex[b & 0xf];
+            }
+            return out;
+        }
+
+        friend auto operator<=>(const uuid&, const uuid&) = default;
+    };
+
+    // A jsonb (or json) value as JSON text. Read from a result it points into the result's buffer
+    // and lives as long as the table; as a parameter the text must outlive the execute() call.
+    struct jsonb {
+        std::string_view text;
+
+        friend bool operator==(const jsonb&, const jsonb&) = default;
+    };
+
+    // time (without time zone): time since midnight, microsecond resolution.
+    struct time_of_day {
+        std::chrono::microseconds since_midnight{};
+
+        friend auto operator<=>(const time_of_day&, const time_of_day&) = default;
+    };
+
+    // interval, kept in PostgreSQL's three fields: months and days don't have a fixed length, so
+    // they can't be folded into the time part.
+    struct interval {
+        std::int32_t months = 0;
+        std::int32_t days = 0;
+        std::chrono::microseconds time{};
+
+        friend bool operator==(const interval&, const interval&) = default;
+    };
+
+    // inet or cidr. IPv4 addresses use the first 4 bytes of address.
+    struct inet {
+        enum class family : std::uint8_t { V4, V6 };
+
+        family af = family::V4;
+        std::uint8_t prefix = 32;       // netmask length in bits
+        bool is_cidr = false;           // sent as cidr instead of inet
+        std::array<std::uint8_t, 16> address{};
+
+        [[nodiscard]] std::size_t address_size() const noexcept { return af == family::V4 ? 4 : 16; }
+
+        friend bool operator==(const inet&, const inet&) = default;
+    };
+
+    // int4range, int8range and tsrange/tstzrange as range<int32_t>, range<int64_t> and
+    // range<timestamp>. A missing bound is unbounded on that side.
+    template<typename T>
+    struct range {
+        std::optional<T> lower;
+        std::optional<T> upper;
+        bool lower_inclusive = true;
+        bool upper_inclusive = false;
+        bool empty = false;
+
+        static range make_empty() noexcept {
+            range r;
+            r.empty = true;
+            return r;
+        }
+
+        friend bool operator==(const range&, const range&) = default;
+    };
+}
@@ -22,7 +22,17 @@
 #include <thread>
 #include <deque>
 #include <functional>
+#include <span>
+#include <vector>
 #include "transaction.h"
+#include "query_awaitable.h"
+#include "copy.h"
+#include "event_loop.h"
+#include "internal/callback_pool.h"
+#include "internal/mpsc_queue.h"
+#include "internal/parker.h"
+#include "internal/query_cancel.h"
+#include "internal/statement_cache.h"
 
 namespace database {
     struct PGOptions {
@@ -31,6 +41,39 @@ namespace database {
         uint32_t keepalive_interval = 10;
         uint32_t keepalive_idle = 30;
     };
+
+    struct ClientConfig {
+        std::size_t num_cb_threads = 2;
+        bool heartbeat_enabled = false;
+        // Upper bound on queued requests the worker sends back-to-back in one
+        // libpq pipeline before it starts reading their results. 1 disables pipelining.
+        std::size_t pipeline_depth = 64;
+        // Number of server-side prepared statements kept per connection, keyed by query
+        // text and evicted least-recently-used. 0 sends every query unnamed.
+        std::size_t statement_cache_size = 256;
+        // Rows per batch handed to execute_stream callbacks when libpq supports chunked
+        // rows mode (PostgreSQL 17+). Older libpq streams one row per batch.
+        int stream_chunk_rows = 1000;
+        // Shared event loop to run on instead of this client's own worker and callback
+        // threads (num_cb_threads is then unused). Give every client of a ConnectionPool the
+        // same loop to serve all of them from a handful of threads.
+        std::shared_ptr<event_loop> loop = nullptr;
+        // Limits on one buffered result (execute, query, execute_async); 0 means none. A result
+        // that would pass one fails with ResultTooLarge and its query is cancelled, before the
+        // rest of it is received. For bigger results use execute_stream() or a cursor.
+        // Setting any of them reads buffered results in stream_chunk_rows chunks (single rows
+        // before libpq 17) and gathers them, which costs a copy of every row.
+        std::size_t max_result_bytes = 0;
+        std::size_t max_result_rows = 0;
+        // Cap on result_memory's current_bytes: a buffered result that would take it past this
+        // fails the same way. Share result_memory between clients to budget a whole pool.
+        std::size_t result_memory_budget = 0;
+        // Counts the bytes held by live tables from this client; made per client when null.
+        std::shared_ptr<result::memory_tracker> result_memory = nullptr;
+        // How long a copy_in() writer may send nothing before its COPY is ended and fails with
+        // TimeOut, freeing the connection. 0 waits forever.
+        std::chrono::milliseconds copy_idle_timeout = std::chrono::seconds(60);
+    };
     inline std::optional<std::string> GetDatabaseUrl(const std::optional<PGOptions> &options = std::nullopt) {
         char* db_url = std::getenv("POSTGRES_DB_URL");
 
@@ -68,6 +111,7 @@ namespace database {
     public:
         explicit postgres_client(std::string&& uri, std::size_t num_cb_threads = 2);
         postgres_client(std::string&& uri, bool heartbeat_enabled, std::size_t num_cb_threads = 2);
+        postgres_client(std::string&& uri, const ClientConfig& config);
         ~postgres_client() override;
 
         postgres_client() = delete;
@@ -81,29 +125,157 @@ namespace database {
 
         std::shared_ptr<transaction> create_transaction();
 
+        // Bytes held by live result tables, see ClientConfig::result_memory.
+        [[nodiscard]] result::memory_stats result_memory() const noexcept { return m_memory->stats(); }
+
+        // Starts COPY table (columns...) FROM STDIN (FORMAT binary). table and columns are
+        // inserted verbatim, like query text; an empty column list copies every column.
+        copy_writer copy_in(std::string_view table, std::initializer_list<std::string_view> columns = {}) const;
+
+        // Runs COPY source TO STDOUT (FORMAT binary) and hands the raw stream to sink on the DB
+        // worker thread. source is inserted verbatim: a table, "table (cols)" or "(SELECT ...)".
+        // The future yields the number of rows copied.
+        query_future<std::expected<std::size_t, sql_error>> copy_out(std::string_view source, copy_sink sink) const;
+
+        // Same as above but decodes every tuple into Ts... (NULL -> nullopt) before calling on_row.
+        // A field that can't be decoded as its requested type fails the copy with CopyFailed.
+        template<typename... Ts>
+        query_future<std::expected<std::size_t, sql_error>> copy_out(std::string_view source, std::type_identity_t<std::function<void(std::tuple<std::optional<Ts>...>)>> on_row) const {
+            auto decoder = std::make_shared<internal::copy_out_decoder<Ts...>>(std::move(on_row));
+            return copy_out(source, [decoder](std::span<const std::byte> data) { return decoder->feed(data); });
+        }
+
+        // Same again, but the tuples are decoded straight into Arrow column buffers and handed to
+        // on_batch as record batches of up to batch_rows rows. Ts... fix the Arrow type of each
+        // column and names name them, "f0", "f1", ... where missing.
+        template<typename... Ts>
+        query_future<std::expected<std::size_t, sql_error>> copy_out_arrow(std::string_view source, std::vector<std::string> names, std::size_t batch_rows, arrow_batch_handler on_batch) const {
+            auto decoder = std::make_shared<internal::copy_out_arrow_decoder<Ts...>>(std::move(names), batch_rows, std::move(on_batch));
+            return copy_out(source, [decoder](std::span<const std::byte> data) { return decoder->feed(data); });
+        }
+
+        // Parameters are sent in binary format. std::string_view and std::span<const std::byte>
+        // ones are sent straight from the caller's memory, which has to stay alive until the
+        // query completes; large std::string and std::vector<std::byte> rvalues are moved in
+        // rather than copied. The same holds for every overload below that takes parameters.
         template<typename... Args>
-        std::future<std::expected<result::table, sql_error>> execute(std::string_view query, Args&& ...params) const {
-            constexpr size_t n = sizeof...(params);
-            const std::array<supported_type, n> param_arr = { internal::CreateSingleData(std::forward<Args>(params))... };
-            pg_param_detail param_buffer = internal::MakePgParamBuffer(query, param_arr);
-            return SendToWorker(std::move(param_buffer));
+        query_future<std::expected<result::table, sql_error>> execute(std::string_view query, Args&& ...params) const {
+            pg_param_detail param_buffer = internal::MakePgParams(query, std::forward<Args>(params)...);
+            return SendToWorker(std::move(param_buffer), no_deadline);
+        }
+
+        // Same as above, but the query gets timeout from now to finish. Once it is up the server is
+        // asked to cancel the query and the future yields a TimeOut error; the connection stays
+        // usable. A query still queued by then fails without being sent. If the query finished just
+        // before the cancel arrived, its result is returned as usual. Such a query is never
+        // pipelined with others, so the cancel can't stop another request instead.
+        template<typename Rep, typename Period, typename... Args>
+        query_future<std::expected<result::table, sql_error>> execute(const std::chrono::duration<Rep, Period> timeout, std::string_view query, Args&& ...params) const {
+            return SendToWorker(internal::MakePgParams(query, std::forward<Args>(params)...), internal::DeadlineAfter(timeout));
+        }
+
+        // execute() decoded into Rows, see result::mappable_row.
+        template<result::mappable_row Row, typename... Args>
+        query_future<std::expected<std::vector<Row>, sql_error>> execute(std::string_view query, Args&& ...params) const {
+            return SendMappedToWorker<Row>(internal::MakePgParams(query, std::forward<Args>(params)...), no_deadline);
+        }
+
+        template<result::mappable_row Row, typename Rep, typename Period, typename... Args>
+        query_future<std::expected<std::vector<Row>, sql_error>> execute(const std::chrono::duration<Rep, Period> timeout, std::string_view query, Args&& ...params) const {
+            return SendMappedToWorker<Row>(internal::MakePgParams(query, std::forward<Args>(params)...), internal::DeadlineAfter(timeout));
         }
 
         template<typename... Params>
         void execute_async(std::string_view query, result_callback callback, error_callback err_callback, Params&& ...params) const noexcept {
-            constexpr size_t SIZE = sizeof...(params);
-            const std::array<supported_type, SIZE> param_arr = { internal::CreateSingleData(std::forward<Params>(params))... };
-            EnqueueAsync(internal::MakePgParamBuffer(query, param_arr), std::move(callback), std::move(err_callback));
+            EnqueueAsync(internal::MakePgParams(query, std::forward<Params>(params)...), std::move(callback), std::move(err_callback), no_deadline);
+        }
+
+        // execute_async() bounded by timeout, see execute(timeout, ...).
+        template<typename Rep, typename Period, typename... Params>
+        void execute_async(const std::chrono::duration<Rep, Period> timeout, std::string_view query, result_callback callback, error_callback err_callback, Params&& ...params) const noexcept {
+            EnqueueAsync(internal::MakePgParams(query, std::forward<Params>(params)...), std::move(callback), std::move(err_callback), internal::DeadlineAfter(timeout));
+        }
+
+        // co_await client.query(sql, params...) yields the same result as execute(); the coroutine
+        // is resumed on the callback pool, like an execute_async() callback.
+        template<typename... Args>
+        query_awaitable query(std::string_view query, Args&& ...params) const {
+            return query_awaitable{*this, internal::MakePgParams(query, std::forward<Args>(params)...)};
+        }
+
+        template<typename Rep, typename Period, typename... Args>
+        query_awaitable query(const std::chrono::duration<Rep, Period> timeout, std::string_view query, Args&& ...params) const {
+            return query_awaitable{*this, internal::MakePgParams(query, std::forward<Args>(params)...), internal::DeadlineAfter(timeout)};
+        }
+
+        // Streams the result set to on_rows as it arrives instead of materialising it, so memory
+        // stays bounded by one batch. on_rows runs on the DB worker thread and must not wait on
+        // other queries of this client. The future yields the number of rows streamed.
+        template<typename... Args>
+        query_future<std::expected<std::size_t, sql_error>> execute_stream(std::string_view query, row_batch_callback on_rows, Args&& ...params) const {
+            return SendStreamToWorker(internal::MakePgParams(query, std::forward<Args>(params)...), std::move(on_rows));
+        }
+
+        // Runs query once for each tuple of parameters in rows (std::tuple, std::pair or
+        // std::array, encoded like execute()'s parameters). The statement is prepared once and every
+        // execution goes out in one pipeline behind a single sync, so the batch costs one round
+        // trip and runs as one implicit transaction: see result::batch_result for how a failing
+        // item is reported. All parameter sets share one buffer. An empty rows completes at once.
+        template<std::ranges::forward_range Rows>
+        query_future<std::expected<result::batch_result, sql_error>> execute_many(std::string_view query, Rows&& rows) const {
+            return SendBatchToWorker(internal::MakePgBatch(query, std::forward<Rows>(rows)));
         }
 
     private:
+        // execute_stream(): where the row batches go, and how many rows they have held so far.
+        struct row_stream {
+            row_batch_callback deliver;
+            std::size_t rows = 0;
+
+            void push(result::table batch) {
+                rows += batch.size();
+                deliver(std::move(batch));
+            }
+            explicit operator bool() const noexcept { return static_cast<bool>(deliver); }
+        };
+
+        using table_promise = smart_ptr::intrusive_ptr<internal::oneshot_state<std::expected<result::table, sql_error>>>;
+        using count_promise = smart_ptr::intrusive_ptr<internal::oneshot_state<std::expected<std::size_t, sql_error>>>;
+        using batch_promise = smart_ptr::intrusive_ptr<internal::oneshot_state<std::expected<result::batch_result, sql_error>>>;
+
+        // execute_many(): the batch's outcome, filled in item by item as the results arrive.
+        struct batch_tally {
+            batch_promise promise;
+            result::batch_result summary;
+            std::size_t items = 0; // parameter sets whose results have been read
+            // The PREPARE failed, which fails the batch as a whole.
+            std::optional<sql_error> failure = std::nullopt;
+            bool stale_statement = false;
+
+            explicit operator bool() const noexcept { return static_cast<bool>(promise); }
+        };
+
         struct query_request {
             pg_param_detail detail;
             result_callback on_success;
             error_callback on_error;
-            // When true the DB worker calls on_success/on_error directly (execute() path).
+            // Set for execute(): completed in place of on_success/on_error.
+            table_promise table_result;
+            // Set for execute_stream() and COPY: receives the streamed rows or the COPY's row count.
+            count_promise count_result;
+            // Set for execute_stream(): row batches go here, the final status goes to count_result.
+            row_stream on_rows;
+            // Set for execute_many(): detail holds every parameter set, the result goes here.
+            batch_tally tally;
+            // Set for copy_in(): detail holds the COPY statement, the data comes from here.
+            std::shared_ptr<internal::copy_in_channel> copy_in;
+            // Set for copy_out(): detail holds the COPY statement, the data goes here.
+            copy_sink copy_out;
+            // When true the DB worker calls on_success/on_error directly (query() awaitables).
             // When false they are dispatched through the callback pool (execute_async() path).
             bool direct_callback = false;
+            // Set by the timed execute() overloads.
+            query_deadline deadline = no_deadline;
 
             query_request() = default;
             explicit query_request(pg_param_detail&& detail) noexcept: detail(std::move(detail)) {}
@@ -111,72 +283,179 @@ namespace database {
             : detail(std::move(other.detail)),
               on_success(std::move(other.on_success)),
               on_error(std::move(other.on_error)),
-              direct_callback(other.direct_callback) {
+              table_result(std::move(other.table_result)),
+              count_result(std::move(other.count_result)),
+              on_rows(std::move(other.on_rows)),
+              tally(std::move(other.tally)),
+              copy_in(std::move(other.copy_in)),
+              copy_out(std::move(other.copy_out)),
+              direct_callback(other.direct_callback),
+              deadline(other.deadline) {
                 other.on_success = nullptr;
                 other.on_error = nullptr;
+                other.on_rows = {};
+                other.copy_out = nullptr;
             }
             query_request& operator=(query_request&& other) noexcept {
                 if (this != &other) {
                     detail = std::move(other.detail);
                     on_success = std::move(other.on_success);
                     on_error = std::move(other.on_error);
+                    table_result = std::move(other.table_result);
+                    count_result = std::move(other.count_result);
+                    on_rows = std::move(other.on_rows);
+                    tally = std::move(other.tally);
+                    copy_in = std::move(other.copy_in);
+                    copy_out = std::move(other.copy_out);
                     direct_callback = other.direct_callback;
+                    deadline = other.deadline;
                     other.on_success = nullptr;
                     other.on_error = nullptr;
+                    other.on_rows = {};
+                    other.copy_out = nullptr;
                 }
                 return *this;
             }
             query_request(const query_request&) = delete;
             query_request& operator=(const query_request&) = delete;
+
+            // COPY can't run in pipeline mode, so these requests always run on their own.
+            [[nodiscard]] bool is_copy() const noexcept { return copy_in || copy_out; }
+            // These take their own path through the worker thread rather than ExecutePipeline.
+            [[nodiscard]] bool runs_alone() const noexcept { return is_copy() || tally; }
+            // A cancel stops whatever the server is running when it arrives, so a request that may
+            // be cancelled on its deadline is never pipelined behind or ahead of another.
+            [[nodiscard]] bool timed() const noexcept { return deadline != no_deadline; }
+            // Neither the worker thread nor the event loop pipelines these with other requests.
+            [[nodiscard]] bool exclusive() const noexcept { return runs_alone() || timed(); }
         };
 
-    private:
-        struct overflow_callback_thread {
-            std::shared_ptr<std::atomic_bool> done;
-            std::jthread thread;
+        // An execute_async() result on its way to the callback pool.
+        struct async_delivery : internal::pooled<async_delivery> {
+            async_delivery(result_callback&& callback, result::unique_pg_result&& res, std::shared_ptr<result::memory_tracker> memory)
+            : callback(std::move(callback)), table(std::move(res), std::move(memory)) {}
+            result_callback callback;
+            result::table table;
         };
 
-        static void reap_overflow_threads(std::list<overflow_callback_thread>& threads) noexcept {
-            for (auto it = threads.begin(); it != threads.end();) {
-                if (it->done->load(std::memory_order_acquire)) {
-                    it = threads.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-        }
+        // Event-loop mode state, see postgres_loop.cpp.
+        struct loop_state;
+
+        // Ends a COPY FROM whose writer stayed silent for copy_idle_timeout; the request fails
+        // with TimeOut.
+        static constexpr const char* kCopyIdleTimeout = "COPY writer sent no data within copy_idle_timeout";
+
+        // How a request was laid out in the pipeline, so its results can be read back in order.
+        struct statement_plan {
+            bool deallocate = false; // a DEALLOCATE segment for an evicted statement precedes it
+            bool prepare = false;    // its PREPARE shares the request's segment
+            bool cached = false;     // executed through the statement cache
+        };
+
+        struct command_outcome {
+            result::unique_pg_result result = nullptr;
+            std::optional<sql_error> error = std::nullopt;
+            bool stale_statement = false;
+            // error is the server's 57014: a cancel request stopped the statement.
+            bool cancelled = false;
+            // A buffered command under result limits: its rows arrive in chunks and are gathered
+            // into result. over_limit is set once they passed a limit; the command is then cancelled.
+            bool gather = false;
+            bool over_limit = false;
+        };
+
+        // Threaded mode: the deadline of the command whose results AwaitResult() is waiting for.
+        struct command_deadline {
+            query_deadline at = no_deadline;
+            bool cancel_sent = false;
+            // Nothing is pipelined behind the command, so a cancel can only stop this one.
+            bool alone = true;
+        };
 
     private:
-        std::future<std::expected<result::table, sql_error>> SendToWorker(pg_param_detail&&) const override;
-        void EnqueueAsync(pg_param_detail&&, result_callback&&, error_callback&&) const noexcept override;
+        query_future<std::expected<result::table, sql_error>> SendToWorker(pg_param_detail&&, query_deadline) const override;
+        void EnqueueAsync(pg_param_detail&&, result_callback&&, error_callback&&, query_deadline) const noexcept override;
+        query_future<std::expected<std::size_t, sql_error>> SendStreamToWorker(pg_param_detail&&, row_batch_callback&&) const override;
+        void EnqueueDirect(pg_param_detail&&, result_callback&&, error_callback&&, query_deadline) const noexcept override;
+        query_future<std::expected<result::batch_result, sql_error>> SendBatchToWorker(pg_param_detail&&) const override;
+        query_future<std::expected<std::size_t, sql_error>> SendCopyToWorker(query_request&& request) const;
+        void Enqueue(query_request&& request) const;
         void QueryWorker(const std::stop_token &st) const noexcept;
+        void CompleteRequest(query_request& item, std::expected<result::unique_pg_result, sql_error>&& result) const noexcept;
+        bool FailIfExpired(query_request& item) const noexcept;
         void PostCallback(std::function<void()> task) const noexcept;
-        void CallbackWorker(const std::stop_token &st) const noexcept;
-        std::expected<result::unique_pg_result, sql_error> ExecuteWithRetry(const pg_param_detail& param_detail, std::chrono::milliseconds reconnect_timeout) const noexcept;
-        std::expected<result::unique_pg_result, sql_error> ExecuteQuery(const pg_param_detail& param_detail) const noexcept;
+        std::expected<result::unique_pg_result, sql_error> ExecuteWithRetry(const pg_param_detail& param_detail, std::chrono::milliseconds reconnect_timeout, row_stream* on_rows = nullptr, query_deadline deadline = no_deadline) const noexcept;
+        std::expected<result::unique_pg_result, sql_error> ExecuteQuery(const pg_param_detail& param_detail, row_stream* on_rows, query_deadline deadline) const noexcept;
+        void ExecutePipeline(std::span<query_request> batch) const noexcept;
+        std::expected<result::unique_pg_result, sql_error> ExecuteBatch(const pg_param_detail& param_detail, batch_tally& tally) const noexcept;
+        std::expected<result::unique_pg_result, sql_error> ExecuteCopyIn(internal::copy_in_channel& channel, const pg_param_detail& copy_cmd, const std::stop_token& st) const noexcept;
+        std::expected<result::unique_pg_result, sql_error> ExecuteCopyOut(const copy_sink& sink, const pg_param_detail& copy_cmd, const std::stop_token& st) const noexcept;
+        void DeliverCopyData(const copy_sink& sink, std::span<const std::byte> data, std::optional<sql_error>& sink_error) const noexcept;
+        std::expected<result::unique_pg_result, sql_error> StartCopy(const int& socket, const pg_param_detail& copy_cmd, ExecStatusType expected) const noexcept;
+        std::expected<void, sql_error> PutCopyData(const int& socket, std::string_view data) const noexcept;
+        std::expected<void, sql_error> PutCopyEnd(const int& socket, const char* error_msg) const noexcept;
+        std::expected<statement_plan, sql_error> SendPipelined(const pg_param_detail& param_detail) const noexcept;
+        std::expected<result::unique_pg_result, sql_error> ConsumePipelineResult(const int& socket, const pg_param_detail& param_detail, const statement_plan& plan, row_stream* on_rows, query_deadline deadline, bool alone = true) const noexcept;
+        std::expected<result::unique_pg_result, sql_error> ReadPipelineResult(const int& socket, const pg_param_detail& param_detail, const statement_plan& plan, row_stream* on_rows) const noexcept;
+        std::expected<void, sql_error> ReadBatchResult(const int& socket, const pg_param_detail& param_detail, const statement_plan& plan, batch_tally& tally) const noexcept;
+        std::expected<void, sql_error> ReadEvictedDeallocate(const int& socket) const noexcept;
+        static void TallyBatchPrepare(batch_tally& tally, command_outcome&& outcome) noexcept;
+        static void TallyBatchItem(batch_tally& tally, command_outcome&& outcome) noexcept;
+        std::expected<result::unique_pg_result, sql_error> FinishBatch(const pg_param_detail& param_detail, const statement_plan& plan, batch_tally& tally) const noexcept;
+        static void ReportCancelled(command_outcome& outcome) noexcept;
+        std::expected<void, sql_error> ReadCommand(const int& socket, command_outcome& outcome, row_stream* on_rows = nullptr) const noexcept;
+        void AbsorbResult(command_outcome& outcome, result::unique_pg_result&& res, row_stream* on_rows) const noexcept;
+        void GatherRows(command_outcome& outcome, const PGresult* chunk) const noexcept;
+        bool HasResultLimits() const noexcept;
+        std::expected<result::unique_pg_result, sql_error> FinishCommand(const pg_param_detail& param_detail, const statement_plan& plan, command_outcome&& outcome) const noexcept;
+        bool EnterStreamingMode() const noexcept;
+        std::expected<void, sql_error> ReadPipelineSync(const int& socket) const noexcept;
+        bool IsSessionIdle() const noexcept;
 
         std::optional<sql_error> AttemptReconnect(std::chrono::milliseconds timeout) const noexcept;
         std::expected<void, sql_error> CheckForPollOut(const int& socket) const noexcept;
-        std::expected<void, sql_error> CheckForPollIn(const int& socket) const noexcept;
-        std::expected<result::unique_pg_result, sql_error> ConsumeResult() const noexcept;
+        std::expected<void, sql_error> AwaitResult(const int& socket) const noexcept;
+        void FinishCancel() const noexcept;
+
+        // Event-loop mode (postgres_loop.cpp). All of these run on the client's reactor thread.
+        void AttachToLoop();
+        void DetachFromLoop() const noexcept;
+        void LoopWake() const noexcept;
+        void LoopOnReady(short revents) const noexcept;
+        void LoopPump() const noexcept;
+        bool LoopSend(bool& progress) const noexcept;
+        bool LoopReadResults(bool& progress) const noexcept;
+        bool LoopReadCopyOut(bool& progress) const noexcept;
+        bool LoopWriteCopyIn(bool& progress) const noexcept;
+        void LoopWatch(short events) const noexcept;
+        void LoopConnectionLost(const sql_error& error) const noexcept;
+        void LoopStartReconnect() const noexcept;
+        void LoopContinueReconnect() const noexcept;
+        void LoopReconnectFailed(const char* reason) const noexcept;
+        void LoopScheduleHeartbeat() const noexcept;
+        void LoopArmDeadline() const noexcept;
+        void LoopDeadlinePassed() const noexcept;
+        void LoopCancelFront() const noexcept;
+        void LoopWatchCancel() const noexcept;
+        void LoopAdvanceCancel() const noexcept;
+        void LoopStopCancel() const noexcept;
+        void LoopCancelDone() const noexcept;
 
     private:
         friend class transaction;
         std::string m_uri;
-        bool m_heartbeat_enabled = false;
+        ClientConfig m_config;
         unique_pg_conn m_connection = nullptr;
-        mutable std::mutex m_mutex;
-        mutable std::condition_variable m_cv;
-        mutable std::deque<query_request> m_requests;
+        mutable internal::statement_cache m_statements;
+        mutable command_deadline m_deadline;
+        mutable internal::query_cancel m_cancel;
+        // Submitted requests; the DB worker (or the reactor) is the single consumer.
+        mutable internal::mpsc_queue<query_request> m_requests;
+        mutable internal::parker m_worker_parker;
         mutable std::jthread m_worker_thread;
-
-        std::size_t m_num_cb_threads;
-        mutable std::mutex m_cb_mutex;
-        mutable std::mutex m_temp_cb_mutex;
-        mutable std::condition_variable m_cb_cv;
-        mutable std::atomic_uint32_t m_idle_cb_workers = 0;
-        mutable std::deque<std::function<void()>> m_cb_queue;
-        mutable std::list<overflow_callback_thread> m_overflow_cb_threads;
-        mutable std::vector<std::jthread> m_cb_workers;
+        mutable internal::callback_pool m_callbacks;
+        std::shared_ptr<result::memory_tracker> m_memory;
+        // Set while running on ClientConfig::loop; shared with tasks queued on the reactor.
+        std::shared_ptr<loop_state> m_loop;
     };
 }
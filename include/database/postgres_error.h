@@ -12,7 +12,7 @@ namespace database {
         enum class type {
             ConnectionFailed, ReconnectFailed, QueryFailed, FlushFailed, PollFailed,
             ConsumeFailed, SocketFailed, Busy, TimeOut, ShuttingDown,
-            BadConnection, SqlFileError, TransactionRolledBack,
+            BadConnection, SqlFileError, TransactionRolledBack, CopyFailed, ResultMismatch, ResultTooLarge,
         };
 
         static sql_error SqlFileError(const char* str) noexcept {return sql_error{type::SqlFileError, str};}
@@ -23,6 +23,10 @@ namespace database {
         static sql_error QueryFailed(const char* str) noexcept { return sql_error{type::QueryFailed, str};}
         static sql_error ShuttingDown(const char* str) noexcept { return sql_error{type::ShuttingDown, str};}
         static sql_error TransactionRolledBack() noexcept { return sql_error{type::TransactionRolledBack, "transaction already rolled back"};}
+        static sql_error CopyFailed(const char* str) noexcept { return sql_error{type::CopyFailed, str};}
+        static sql_error QueryTimedOut(const char* str) noexcept { return sql_error{type::TimeOut, str};}
+        static sql_error ResultMismatch(const char* str) noexcept { return sql_error{type::ResultMismatch, str};}
+        static sql_error ResultTooLarge(const char* str) noexcept { return sql_error{type::ResultTooLarge, str};}
 
         type get_type() const noexcept {return err;}
 
@@ -68,6 +72,15 @@ namespace database {
                 case type::TransactionRolledBack:
                     code_str = "TransactionRolledBack";
                     break;
+                case type::CopyFailed:
+                    code_str = "CopyFailed";
+                    break;
+                case type::ResultMismatch:
+                    code_str = "ResultMismatch";
+                    break;
+                case type::ResultTooLarge:
+                    code_str = "ResultTooLarge";
+                    break;
             }
             std::erase(message, '\n');
             return std::format("Postgres: {} {}", code_str, message);
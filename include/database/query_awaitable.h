@@ -0,0 +1,60 @@
+//
+// Created by Shinnosuke Kawai on 4/14/26.
+//
+
+#pragma once
+#include <coroutine>
+#include <expected>
+#include <utility>
+#include "query_executor.h"
+#include "internal/type_detail.h"
+
+namespace database {
+    // Returned by postgres_client::query() and transaction::query(). The query is queued when the
+    // coroutine suspends, and the coroutine is resumed on the callback pool with no future or
+    // shared state in between. Never on the DB worker (or event loop) thread, so the resumed code
+    // may block on the client: wait on a future, commit(), or drop the last transaction reference.
+    class [[nodiscard]] query_awaitable {
+    public:
+        using result_type = std::expected<result::table, sql_error>;
+
+        query_awaitable(const query_executor& executor, pg_param_detail&& detail, const query_deadline deadline = no_deadline) noexcept
+        : m_executor(&executor), m_detail(std::move(detail)), m_deadline(deadline) {}
+        // Already complete; co_await returns error without suspending.
+        explicit query_awaitable(sql_error error) noexcept
+        : m_result(std::unexpected(std::move(error))) {}
+
+        query_awaitable(query_awaitable&&) noexcept = default;
+        query_awaitable(const query_awaitable&) = delete;
+        query_awaitable& operator=(const query_awaitable&) = delete;
+        query_awaitable& operator=(query_awaitable&&) = delete;
+
+        [[nodiscard]] bool await_ready() const noexcept { return m_executor == nullptr; }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            m_handle = handle;
+            // The callbacks only capture this, so they fit std::function's small buffer. Nothing
+            // here may be touched after resume(): the frame holding *this can be gone by then.
+            m_executor->EnqueueAsync(
+                std::move(m_detail),
+                [this](result::table table) {
+                    m_result = std::move(table);
+                    m_handle.resume();
+                },
+                [this](const sql_error& error) {
+                    m_result = std::unexpected(error);
+                    m_handle.resume();
+                },
+                m_deadline);
+        }
+
+        result_type await_resume() noexcept { return std::move(m_result); }
+
+    private:
+        const query_executor* m_executor = nullptr;
+        pg_param_detail m_detail;
+        query_deadline m_deadline = no_deadline;
+        std::coroutine_handle<> m_handle;
+        result_type m_result = std::unexpected(sql_error::QueryFailed("query was not awaited"));
+    };
+}
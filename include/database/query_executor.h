@@ -3,23 +3,58 @@
 //
 
 #pragma once
-#include <future>
+#include <chrono>
 #include <expected>
 #include <functional>
+#include <vector>
 #include "internal/type_detail.h"
+#include "result/batch.h"
 #include "result/table.h"
 #include "postgres_error.h"
+#include "query_future.h"
 
 namespace database {
     using result_callback = std::function<void(result::table)>;
     using error_callback  = std::function<void(const sql_error&)>;
+    // Receives the rows of a streamed query batch by batch, in order, on the DB worker thread.
+    using row_batch_callback = std::function<void(result::table)>;
+
+    // When a query has to be finished by; no_deadline for no limit.
+    using query_deadline = std::chrono::steady_clock::time_point;
+    inline constexpr query_deadline no_deadline = query_deadline::max();
+
+    namespace internal {
+        template<typename Rep, typename Period>
+        query_deadline DeadlineAfter(const std::chrono::duration<Rep, Period>& timeout) noexcept {
+            return std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(timeout);
+        }
+    }
 
     class query_executor {
     public:
         virtual ~query_executor() = default;
+    protected:
+        // execute<Row>(): the table is decoded into Rows on the completing thread, so the caller
+        // receives the vector and the PGresult is freed right away.
+        template<result::mappable_row Row>
+        query_future<std::expected<std::vector<Row>, sql_error>> SendMappedToWorker(pg_param_detail&& detail, const query_deadline deadline) const {
+            auto state = smart_ptr::make_intrusive<internal::oneshot_state<std::expected<std::vector<Row>, sql_error>>>();
+            EnqueueDirect(
+                std::move(detail),
+                [state](result::table table) { state->set(table.as<Row>()); },
+                [state](const sql_error& error) { state->set(std::unexpected(error)); },
+                deadline);
+            return query_future{std::move(state)};
+        }
     private:
         friend class transaction;
-        virtual std::future<std::expected<result::table, sql_error>> SendToWorker(pg_param_detail&&) const = 0;
-        virtual void EnqueueAsync(pg_param_detail&&, result_callback&&, error_callback&&) const noexcept = 0;
+        friend class query_awaitable;
+        virtual query_future<std::expected<result::table, sql_error>> SendToWorker(pg_param_detail&&, query_deadline) const = 0;
+        virtual void EnqueueAsync(pg_param_detail&&, result_callback&&, error_callback&&, query_deadline) const noexcept = 0;
+        virtual query_future<std::expected<std::size_t, sql_error>> SendStreamToWorker(pg_param_detail&&, row_batch_callback&&) const = 0;
+        // Like EnqueueAsync but the callbacks run on the completing thread, not the callback pool.
+        virtual void EnqueueDirect(pg_param_detail&&, result_callback&&, error_callback&&, query_deadline) const noexcept = 0;
+        // execute_many(): detail holds every parameter set of the batch.
+        virtual query_future<std::expected<result::batch_result, sql_error>> SendBatchToWorker(pg_param_detail&&) const = 0;
     };
 }
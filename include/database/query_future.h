@@ -0,0 +1,113 @@
+//
+// Created by Shinnosuke Kawai on 4/17/26.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <utility>
+#include <core/memory/intrusive_ptr.h>
+#include "internal/object_pool.h"
+#include "internal/parker.h"
+
+namespace database {
+    namespace internal {
+        // Shared between one query_future and the DB worker completing it. Intrusively counted
+        // and pooled, so a query costs no allocation here once the pool is warm.
+        template<typename T>
+        class oneshot_state final : public core::ref_counted<oneshot_state<T>>, public pooled<oneshot_state<T>> {
+        public:
+            // Completing side; called exactly once. Builds T in place from args; if that throws, the
+            // state stays not ready.
+            template<typename... Args>
+            void set(Args&&... args) {
+                m_value.emplace(std::forward<Args>(args)...);
+                m_ready.store(true, std::memory_order_release);
+                m_parker.unpark();
+            }
+
+            [[nodiscard]] bool ready() const noexcept { return m_ready.load(std::memory_order_acquire); }
+
+            // Waiting side. False if deadline passed first.
+            bool wait_until(const parker::time_point deadline) noexcept {
+                while (!ready()) {
+                    if (deadline != parker::time_point::max() && std::chrono::steady_clock::now() >= deadline)
+                        return false;
+                    m_parker.park([this] { return ready(); }, deadline);
+                }
+                return true;
+            }
+
+            // Requires ready().
+            T take() { return std::move(*m_value); }
+
+        private:
+            std::optional<T> m_value;
+            std::atomic_bool m_ready = false;
+            parker m_parker;
+        };
+    }
+
+    // One-shot, single-waiter replacement for std::future returned by execute(), execute_stream()
+    // and the COPY calls: same get()/wait()/wait_for() surface, but the shared state is a pooled
+    // intrusive object rather than a fresh promise/shared_ptr pair per query.
+    template<typename T>
+    class [[nodiscard]] query_future {
+    public:
+        query_future() = default;
+        explicit query_future(smart_ptr::intrusive_ptr<internal::oneshot_state<T>> state) noexcept
+        : m_state(std::move(state)) {}
+
+        // A future that already holds value, e.g. for a call rejected before it was queued.
+        static query_future ready(T value) {
+            auto state = smart_ptr::make_intrusive<internal::oneshot_state<T>>();
+            state->set(std::move(value));
+            return query_future{std::move(state)};
+        }
+
+        query_future(query_future&&) noexcept = default;
+        query_future& operator=(query_future&&) noexcept = default;
+        query_future(const query_future&) = delete;
+        query_future& operator=(const query_future&) = delete;
+
+        [[nodiscard]] bool valid() const noexcept { return static_cast<bool>(m_state); }
+
+        // wait(), wait_for(), wait_until() and get() throw std::future_error(no_state) unless valid().
+        void wait() const {
+            CheckState();
+            m_state->wait_until(internal::parker::time_point::max());
+        }
+
+        template<typename Rep, typename Period>
+        std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+            return wait_until(std::chrono::steady_clock::now() + timeout);
+        }
+
+        template<typename Clock, typename Duration>
+        std::future_status wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const {
+            CheckState();
+            const auto steady_deadline = std::chrono::steady_clock::now()
+                + std::chrono::ceil<std::chrono::steady_clock::duration>(deadline - Clock::now());
+            return m_state->wait_until(steady_deadline) ? std::future_status::ready : std::future_status::timeout;
+        }
+
+        // Waits, then hands over the value; the future is no longer valid() afterwards.
+        T get() {
+            CheckState();
+            m_state->wait_until(internal::parker::time_point::max());
+            T value = m_state->take();
+            m_state.reset();
+            return value;
+        }
+
+    private:
+        void CheckState() const {
+            if (!m_state)
+                throw std::future_error(std::future_errc::no_state);
+        }
+
+        smart_ptr::intrusive_ptr<internal::oneshot_state<T>> m_state;
+    };
+}
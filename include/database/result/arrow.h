@@ -0,0 +1,109 @@
+//
+// Created by Shinnosuke Kawai on 4/23/26.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+#include <libpq-fe.h>
+#include "row.h"
+#include "../postgres_error.h"
+
+// Apache Arrow C Data Interface, copied verbatim from the specification so that no Arrow library
+// is needed. The guard is the one the specification prescribes, so it coexists with arrow/c/abi.h.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+}
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace database::result {
+    // The Arrow types results are exported as. Timestamps are microseconds since the Unix epoch.
+    enum class arrow_type {
+        Bool, Int16, Int32, Int64, UInt16, UInt32, UInt64, Float32, Float64,
+        Timestamp, TimestampUtc, Utf8, Binary
+    };
+
+    // The Arrow type a column of PostgreSQL type oid is exported as. Types without a natural
+    // Arrow counterpart (numeric, ...) are exported as binary holding their wire bytes.
+    arrow_type ArrowTypeFor(Oid oid) noexcept;
+
+    namespace pg_detail {
+        // One Arrow column being filled, in the buffer layout the C Data Interface hands over:
+        // validity bits, then fixed-width values or int32 offsets plus bytes.
+        struct arrow_column {
+            arrow_column(arrow_type type, std::string name);
+
+            void reserve(std::size_t rows);
+            void append_null();
+            // Adds a non-null cell. For the fixed-width types bytes holds the value in host byte
+            // order; for Utf8/Binary it is the value itself.
+            void append(std::span<const std::byte> bytes);
+            void append_bool(bool value);
+
+            // Hands the buffers to a freshly made schema/array pair and starts over empty.
+            void export_to(ArrowSchema* schema, ArrowArray* array);
+
+            arrow_type type;
+            std::string name;
+            std::int64_t length = 0;
+            std::int64_t null_count = 0;
+            std::vector<std::uint8_t> validity;
+            std::vector<std::byte> values;     // fixed-width values, bools as bits, or Utf8/Binary bytes
+            std::vector<std::int32_t> offsets; // Utf8/Binary only, length + 1 entries
+        };
+
+        // Bytes per value of the fixed-width types, 0 for Bool/Utf8/Binary.
+        std::size_t ArrowWidth(arrow_type type) noexcept;
+
+        // Exports columns, length rows each, as one record batch: a struct array with a child per
+        // column. The columns are left empty for the next batch.
+        void ExportBatch(std::span<arrow_column> columns, std::int64_t length, ArrowSchema* schema, ArrowArray* array);
+
+        // The whole of a query result as a record batch; see table::to_arrow().
+        std::expected<void, sql_error> ExportResult(const PGresult* res, std::span<const column_info> columns,
+                                                    ArrowSchema* schema, ArrowArray* array);
+    }
+}
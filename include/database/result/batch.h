@@ -0,0 +1,27 @@
+//
+// Created by Shinnosuke Kawai on 5/2/26.
+//
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "../postgres_error.h"
+
+namespace database::result {
+    // A parameter set of an execute_many() batch that failed, by its position in the batch.
+    struct batch_error {
+        std::size_t index = 0;
+        sql_error error;
+    };
+
+    // What an execute_many() batch did. The whole batch is one implicit transaction (or part of
+    // the caller's), so once an item fails the ones before it are rolled back and the ones after
+    // it are skipped: errors then holds the failure and an "aborted" error for each later item,
+    // and nothing of the batch is applied.
+    struct batch_result {
+        std::size_t affected_rows = 0; // summed over the items; 0 once any item failed
+        std::vector<batch_error> errors;
+
+        [[nodiscard]] bool ok() const noexcept { return errors.empty(); }
+    };
+}
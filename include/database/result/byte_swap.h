@@ -0,0 +1,15 @@
+//
+// Created by Shinnosuke Kawai on 4/22/26.
+//
+
+#pragma once
+#include <cstddef>
+
+namespace database::result::pg_detail {
+    // Reverse the byte order of count consecutive 2/4/8-byte values in place; data needn't be
+    // aligned. Picks the widest shuffle the CPU has (AVX2, then SSSE3) and falls back to a scalar
+    // loop elsewhere.
+    void SwapBytes16(std::byte* data, std::size_t count) noexcept;
+    void SwapBytes32(std::byte* data, std::size_t count) noexcept;
+    void SwapBytes64(std::byte* data, std::size_t count) noexcept;
+}
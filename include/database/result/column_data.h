@@ -0,0 +1,162 @@
+//
+// Created by Shinnosuke Kawai on 4/22/26.
+//
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include <libpq-fe.h>
+#include "byte_swap.h"
+#include "colunm.h"
+
+namespace database::result {
+    // Bytes needed for the null bitmap of a column with rows values.
+    constexpr std::size_t BitmapBytes(const std::size_t rows) noexcept { return (rows + 7) / 8; }
+
+    // One column of a result pulled out by table::column<T>(). The bitmap uses Arrow's validity
+    // layout: bit i (least significant first) is set when row i has a value. NULL rows hold T{}.
+    template<typename T, typename Allocator = std::allocator<T>>
+    struct column_data {
+        using allocator_type = Allocator;
+
+        std::vector<T, Allocator> values;
+        std::vector<std::uint8_t, typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint8_t>> validity;
+        std::size_t null_count = 0;
+
+        [[nodiscard]] std::size_t size() const noexcept { return values.size(); }
+        [[nodiscard]] bool is_null(const std::size_t index) const noexcept {
+            return (validity[index / 8] >> (index % 8) & 1) == 0;
+        }
+    };
+
+    namespace pmr {
+        // column_data whose buffers come from a std::pmr::memory_resource.
+        template<typename T>
+        using column_data = result::column_data<T, std::pmr::polymorphic_allocator<T>>;
+    }
+
+    namespace pg_detail {
+        // Types with a fixed-width wire form that a whole column can be gathered and swapped for.
+        template<typename T>
+        inline constexpr bool kBulkDecodable =
+            std::is_same_v<T, int16_t> || std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t> ||
+            std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, timestamp>;
+
+        // Whether T is stored exactly as the wire value of columns of type oid, give or take byte
+        // order; a narrower column (Int4 read as int64_t) still goes cell by cell.
+        template<typename T>
+        constexpr bool FixedWidth(const Oid oid) noexcept {
+            if constexpr (std::is_same_v<T, int16_t>)
+                return oid == pg_oid::Int2;
+            else if constexpr (std::is_same_v<T, int32_t>)
+                return oid == pg_oid::Int4;
+            else if constexpr (std::is_same_v<T, int64_t>)
+                return oid == pg_oid::Int8;
+            else if constexpr (std::is_same_v<T, float>)
+                return oid == pg_oid::Float4;
+            else if constexpr (std::is_same_v<T, double>)
+                return oid == pg_oid::Float8;
+            else if constexpr (std::is_same_v<T, timestamp>)
+                return oid == pg_oid::Timestamp || oid == pg_oid::Timestamptz;
+            else
+                return false;
+        }
+
+        template<std::size_t Width>
+        void SwapBytes(std::byte* data, const std::size_t count) noexcept {
+            if constexpr (Width == 2)
+                SwapBytes16(data, count);
+            else if constexpr (Width == 4)
+                SwapBytes32(data, count);
+            else
+                SwapBytes64(data, count);
+        }
+
+        // Fills out[0, rows) and validity from column c. Cell pointers are scattered across the
+        // PGresult, so the wire bytes are first gathered into out as they are and then byte-swapped
+        // in one vector pass. Returns the number of NULLs, or -1 if a cell has the wrong width.
+        template<typename T>
+        std::ptrdiff_t ExtractFixed(const PGresult* res, const int c, const std::span<T> out,
+                                    const std::span<std::uint8_t> validity) noexcept {
+            static_assert(kBulkDecodable<T>);
+            constexpr std::size_t width = std::is_same_v<T, timestamp> ? sizeof(int64_t) : sizeof(T);
+            static_assert(sizeof(T) == width, "values are swapped in place in out");
+            const int rows = PQntuples(res);
+            auto* raw = reinterpret_cast<std::byte*>(out.data());
+            std::ptrdiff_t nulls = 0;
+            std::uint8_t bits = 0;
+            for (int r = 0; r < rows; ++r) {
+                std::byte* dst = raw + static_cast<std::size_t>(r) * width;
+                if (PQgetisnull(res, r, c)) {
+                    std::memset(dst, 0, width);
+                    ++nulls;
+                } else {
+                    if (PQgetlength(res, r, c) != static_cast<int>(width))
+                        return -1;
+                    std::memcpy(dst, PQgetvalue(res, r, c), width);
+                    bits |= static_cast<std::uint8_t>(1u << (r % 8));
+                }
+                if (r % 8 == 7 || r + 1 == rows) {
+                    if (!validity.empty())
+                        validity[r / 8] = bits;
+                    bits = 0;
+                }
+            }
+            SwapBytes<width>(raw, static_cast<std::size_t>(rows));
+
+            if constexpr (std::is_same_v<T, timestamp>) {
+                // The swapped words are microseconds since 2000-01-01; rebase them in place. NULL
+                // rows stay T{}.
+                for (int r = 0; r < rows; ++r) {
+                    if (PQgetisnull(res, r, c)) {
+                        out[r] = timestamp{};
+                        continue;
+                    }
+                    int64_t us;
+                    std::memcpy(&us, raw + static_cast<std::size_t>(r) * width, sizeof(us));
+                    out[r] = internal::TimestampFromPg(us);
+                }
+            }
+            return nulls;
+        }
+
+        // Any other type colum::as<T>() decodes, one cell at a time; with a resource, what the
+        // values allocate comes from it.
+        template<typename T>
+        std::ptrdiff_t ExtractCells(const PGresult* res, const int c, const std::span<T> out,
+                                    const std::span<std::uint8_t> validity,
+                                    std::pmr::memory_resource* resource = nullptr) {
+            const int rows = PQntuples(res);
+            const Oid oid = PQftype(res, c);
+            std::ptrdiff_t nulls = 0;
+            std::uint8_t bits = 0;
+            for (int r = 0; r < rows; ++r) {
+                const bool is_null = PQgetisnull(res, r, c);
+                if (is_null) {
+                    out[r] = T{};
+                    ++nulls;
+                } else {
+                    const colum cell{oid, PQgetvalue(res, r, c), PQgetlength(res, r, c), false};
+                    std::optional<T> value = resource ? cell.as<T>(resource) : cell.as<T>();
+                    if (!value)
+                        return -1;
+                    out[r] = std::move(*value);
+                    bits |= static_cast<std::uint8_t>(1u << (r % 8));
+                }
+                if (r % 8 == 7 || r + 1 == rows) {
+                    if (!validity.empty())
+                        validity[r / 8] = bits;
+                    bits = 0;
+                }
+            }
+            return nulls;
+        }
+    }
+}
@@ -3,12 +3,22 @@
 //
 
 #pragma once
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
+#include <memory_resource>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <postgres_ext.h>
+#include "../pg_types.h"
+#include "../internal/pg_constants.h"
 
 namespace database::result {
     namespace pg_oid {
@@ -25,6 +35,55 @@ namespace database::result {
         constexpr Oid Numeric     = 1700;
         constexpr Oid Timestamp   = 1114;
         constexpr Oid Timestamptz = 1184;
+        constexpr Oid Date        = 1082;
+        constexpr Oid Time        = 1083;
+        constexpr Oid Interval    = 1186;
+        constexpr Oid Uuid        = 2950;
+        constexpr Oid Json        = 114;
+        constexpr Oid Jsonb       = 3802;
+        constexpr Oid Inet        = 869;
+        constexpr Oid Cidr        = 650;
+        constexpr Oid Int4Range   = 3904;
+        constexpr Oid Int8Range   = 3926;
+        constexpr Oid TsRange     = 3908;
+        constexpr Oid TstzRange   = 3910;
+        constexpr Oid Record      = 2249;
+
+        // Types created by CREATE TYPE / CREATE TABLE get OIDs from here on.
+        constexpr Oid FirstUserOid = 16384;
+
+        // The element type of a built-in array type, 0 for anything else.
+        constexpr Oid ArrayElement(const Oid array) noexcept {
+            switch (array) {
+                case 1000: return Bool;
+                case 1005: return Int2;
+                case 1007: return Int4;
+                case 1016: return Int8;
+                case 1021: return Float4;
+                case 1022: return Float8;
+                case 1009: return Text;
+                case 1015: return Varchar;
+                case 1014: return Bpchar;
+                case 1001: return Bytea;
+                case 1231: return Numeric;
+                case 1115: return Timestamp;
+                case 1185: return Timestamptz;
+                case 1182: return Date;
+                case 1183: return Time;
+                case 1187: return Interval;
+                case 2951: return Uuid;
+                case 199:  return Json;
+                case 3807: return Jsonb;
+                case 1041: return Inet;
+                case 651:  return Cidr;
+                case 3905: return Int4Range;
+                case 3927: return Int8Range;
+                case 3909: return TsRange;
+                case 3911: return TstzRange;
+                case 2287: return Record;
+                default:   return 0;
+            }
+        }
     }
 
     namespace pg_detail {
@@ -42,25 +101,83 @@ namespace database::result {
 
 
 namespace database::result {
+    struct colum;
+
+    namespace pg_detail {
+        template<typename T>
+        struct is_array_target : std::false_type {};
+        // std::vector<std::byte> stays bytea, as does its std::pmr counterpart.
+        template<typename T, typename Allocator>
+        struct is_array_target<std::vector<T, Allocator>> : std::bool_constant<!std::is_same_v<T, std::byte>> {};
+
+        template<typename T>
+        struct is_optional : std::false_type {};
+        template<typename T>
+        struct is_optional<std::optional<T>> : std::true_type {};
+
+        template<typename T>
+        struct is_tuple : std::false_type {};
+        template<typename... Ts>
+        struct is_tuple<std::tuple<Ts...>> : std::true_type {};
+
+        template<typename Vector>
+        std::optional<Vector> DecodeArray(const colum& column, std::pmr::memory_resource* resource = nullptr);
+        template<typename Tuple>
+        std::optional<Tuple> DecodeRecord(const colum& column);
+    }
+
+    // One cell: a view of its wire bytes in the owning PGresult (or COPY buffer), decoded by as<T>().
     struct colum {
         colum() = default;
-        colum(const Oid oid, const char* val, const int val_len, const bool is_null) : is_null(is_null), oid(oid) {
-            if (!is_null && val && val_len > 0) {
-                data.resize(val_len);
-                std::memcpy(data.data(), val, val_len);
-            }
+        colum(const Oid oid, const char* val, const int val_len, const bool is_null) noexcept : is_null(is_null), oid(oid) {
+            if (!is_null && val && val_len > 0)
+                data = {reinterpret_cast<const std::byte*>(val), static_cast<std::size_t>(val_len)};
+        }
+
+        // Scalars are explicit specializations below. std::vector<T> reads an array column (all
+        // dimensions flattened in row-major order) and std::tuple<Ts...> a composite column,
+        // element by element through as<T>(); use std::optional<U> for elements that may be NULL.
+        template<typename T>
+        std::optional<T> as() const {
+            if constexpr (pg_detail::is_array_target<T>::value)
+                return pg_detail::DecodeArray<T>(*this);
+            else if constexpr (pg_detail::is_tuple<T>::value)
+                return pg_detail::DecodeRecord<T>(*this);
+            else
+                return std::nullopt;
         }
-        colum(colum&& other) noexcept = default;
-        colum& operator=(colum&& other) noexcept = default;
-        colum(const colum&) = delete;
-        colum& operator=(const colum&) = delete;
 
+        // The same, with whatever T allocates taken from resource: std::pmr::string (text),
+        // std::pmr::vector<std::byte> (bytea) and std::pmr::vector<U> (arrays, U's own storage
+        // included). Types that don't allocate ignore resource. A null resource means the default.
         template<typename T>
-        std::optional<T> as() const { return std::nullopt; }
+        std::optional<T> as(std::pmr::memory_resource* resource) const {
+            if (resource == nullptr)
+                resource = std::pmr::get_default_resource();
+            if constexpr (std::is_same_v<T, std::pmr::string>) {
+                const std::optional<std::string_view> text = as<std::string_view>();
+                if (!text)
+                    return std::nullopt;
+                return std::pmr::string(*text, resource);
+            } else if constexpr (std::is_same_v<T, std::pmr::vector<std::byte>>) {
+                if (is_null || oid != pg_oid::Bytea)
+                    return std::nullopt;
+                return std::pmr::vector<std::byte>(data.begin(), data.end(), resource);
+            } else if constexpr (pg_detail::is_array_target<T>::value) {
+                return pg_detail::DecodeArray<T>(*this, resource);
+            } else {
+                return as<T>();
+            }
+        }
+
+        [[nodiscard]] bool null() const noexcept { return is_null; }
+        [[nodiscard]] Oid type_oid() const noexcept { return oid; }
+        // The wire bytes, empty for NULL.
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return data; }
     private:
         bool is_null = true;
         Oid  oid = 0;
-        std::vector<std::byte> data;
+        std::span<const std::byte> data;
     };
 }
 
@@ -146,6 +263,21 @@ namespace database::result {
         return std::nullopt;
     }
 
+    // Text without the copy: views the result buffer, valid as long as the table.
+    template<>
+    inline std::optional<std::string_view> colum::as<std::string_view>() const {
+        if (is_null)
+            return std::nullopt;
+        if (oid == pg_oid::Text || oid == pg_oid::Varchar || oid == pg_oid::Bpchar)
+            return std::string_view(reinterpret_cast<const char*>(data.data()), data.size());
+        return std::nullopt;
+    }
+
+    template<>
+    inline std::optional<std::pmr::string> colum::as<std::pmr::string>() const {
+        return as<std::pmr::string>(std::pmr::get_default_resource());
+    }
+
     using timestamp = std::chrono::system_clock::time_point;
 
     template<>
@@ -154,9 +286,7 @@ namespace database::result {
             return std::nullopt;
         if ((oid == pg_oid::Timestamp || oid == pg_oid::Timestamptz) && data.size() == 8) {
             const auto us = pg_detail::ReadBigEndian<int64_t>(data.data());
-            // PostgreSQL epoch starts at 2000-01-01 UTC (Unix epoch + 946684800s)
-            constexpr int64_t kPgEpochUs = 946684800LL * 1'000'000LL;
-            return timestamp{std::chrono::microseconds(us + kPgEpochUs)};
+            return internal::TimestampFromPg(us);
         }
         return std::nullopt;
     }
@@ -224,7 +354,487 @@ namespace database::result {
         if (is_null)
             return std::nullopt;
         if (oid == pg_oid::Bytea)
-            return data;  // binary result format: raw bytes, no hex encoding
+            return std::vector<std::byte>(data.begin(), data.end());  // binary result format: raw bytes, no hex encoding
+        return std::nullopt;
+    }
+
+    template<>
+    inline std::optional<std::pmr::vector<std::byte>> colum::as<std::pmr::vector<std::byte>>() const {
+        return as<std::pmr::vector<std::byte>>(std::pmr::get_default_resource());
+    }
+
+    template<>
+    inline std::optional<uuid> colum::as<uuid>() const {
+        if (is_null || oid != pg_oid::Uuid || data.size() != 16)
+            return std::nullopt;
+        uuid out;
+        std::memcpy(out.bytes.data(), data.data(), out.bytes.size());
+        return out;
+    }
+
+    // jsonb's binary form is a version byte (1) and the JSON text; json's is the text alone.
+    // The text is not copied: it views the result buffer.
+    template<>
+    inline std::optional<jsonb> colum::as<jsonb>() const {
+        if (is_null)
+            return std::nullopt;
+        const auto* text = reinterpret_cast<const char*>(data.data());
+        if (oid == pg_oid::Jsonb && !data.empty() && data[0] == std::byte{1})
+            return jsonb{{text + 1, data.size() - 1}};
+        if (oid == pg_oid::Json)
+            return jsonb{{text, data.size()}};
         return std::nullopt;
     }
-}
\ No newline at end of file
+
+    // date: int32 days since 2000-01-01.
+    template<>
+    inline std::optional<std::chrono::sys_days> colum::as<std::chrono::sys_days>() const {
+        if (is_null || oid != pg_oid::Date || data.size() != 4)
+            return std::nullopt;
+        return internal::kPgEpochDate + std::chrono::days{pg_detail::ReadBigEndian<int32_t>(data.data())};
+    }
+
+    template<>
+    inline std::optional<time_of_day> colum::as<time_of_day>() const {
+        if (is_null || oid != pg_oid::Time || data.size() != 8)
+            return std::nullopt;
+        return time_of_day{std::chrono::microseconds{pg_detail::ReadBigEndian<int64_t>(data.data())}};
+    }
+
+    // interval: int64 microseconds | int32 days | int32 months.
+    template<>
+    inline std::optional<interval> colum::as<interval>() const {
+        if (is_null || oid != pg_oid::Interval || data.size() != 16)
+            return std::nullopt;
+        interval out;
+        out.time = std::chrono::microseconds{pg_detail::ReadBigEndian<int64_t>(data.data())};
+        out.days = pg_detail::ReadBigEndian<int32_t>(data.data() + 8);
+        out.months = pg_detail::ReadBigEndian<int32_t>(data.data() + 12);
+        return out;
+    }
+
+    // inet/cidr: family (2 = IPv4, 3 = IPv6) | bits | is_cidr | nb | address[nb].
+    template<>
+    inline std::optional<inet> colum::as<inet>() const {
+        if (is_null || (oid != pg_oid::Inet && oid != pg_oid::Cidr) || data.size() < 4)
+            return std::nullopt;
+        const auto family = static_cast<uint8_t>(data[0]);
+        const auto nb = static_cast<std::size_t>(data[3]);
+        inet out;
+        out.af = family == 2 ? inet::family::V4 : inet::family::V6;
+        if ((family != 2 && family != 3) || nb != out.address_size() || data.size() != 4 + nb)
+            return std::nullopt;
+        out.prefix = static_cast<uint8_t>(data[1]);
+        out.is_cidr = data[2] != std::byte{0};
+        std::memcpy(out.address.data(), data.data() + 4, nb);
+        return out;
+    }
+
+    namespace pg_detail {
+        // range: flags byte, then each finite bound as int32 length + the bound's binary form,
+        // decoded by reading it as a column of type bound_oid.
+        template<typename T>
+        std::optional<range<T>> DecodeRange(const std::span<const std::byte> data, const Oid bound_oid) {
+            namespace range_flag = internal::range_flag;
+            if (data.empty())
+                return std::nullopt;
+            const auto flags = static_cast<uint8_t>(data[0]);
+            if (flags & range_flag::Empty)
+                return range<T>::make_empty();
+
+            range<T> out;
+            out.lower_inclusive = (flags & range_flag::LowerInclusive) != 0;
+            out.upper_inclusive = (flags & range_flag::UpperInclusive) != 0;
+            std::size_t pos = 1;
+            for (const auto& [bound, infinite] : {std::pair{&out.lower, range_flag::LowerInfinite}, std::pair{&out.upper, range_flag::UpperInfinite}}) {
+                if (flags & infinite)
+                    continue;
+                if (data.size() - pos < 4)
+                    return std::nullopt;
+                const auto len = ReadBigEndian<int32_t>(data.data() + pos);
+                pos += 4;
+                if (len < 0 || data.size() - pos < static_cast<std::size_t>(len))
+                    return std::nullopt;
+                *bound = colum{bound_oid, reinterpret_cast<const char*>(data.data() + pos), len, false}.as<T>();
+                if (!*bound)
+                    return std::nullopt;
+                pos += static_cast<std::size_t>(len);
+            }
+            if (pos != data.size())
+                return std::nullopt;
+            return out;
+        }
+    }
+
+    template<>
+    inline std::optional<range<int32_t>> colum::as<range<int32_t>>() const {
+        if (is_null || oid != pg_oid::Int4Range)
+            return std::nullopt;
+        return pg_detail::DecodeRange<int32_t>(data, pg_oid::Int4);
+    }
+
+    template<>
+    inline std::optional<range<int64_t>> colum::as<range<int64_t>>() const {
+        if (is_null || oid != pg_oid::Int8Range)
+            return std::nullopt;
+        return pg_detail::DecodeRange<int64_t>(data, pg_oid::Int8);
+    }
+
+    template<>
+    inline std::optional<range<timestamp>> colum::as<range<timestamp>>() const {
+        if (is_null || (oid != pg_oid::TsRange && oid != pg_oid::TstzRange))
+            return std::nullopt;
+        return pg_detail::DecodeRange<timestamp>(data, pg_oid::Timestamp);
+    }
+
+    // An array value, read in place: iterating yields each element as a colum viewing the same
+    // buffer, NULL elements included. Multi-dimensional arrays iterate in row-major order.
+    // Binary layout: int32 ndim | int32 has_nulls | uint32 element oid | ndim x (int32 extent,
+    // int32 lower bound) | per element int32 length (-1 for NULL) + bytes.
+    class array_view {
+    public:
+        static constexpr int kMaxDimensions = 6; // PostgreSQL's MAXDIM
+
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = colum;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            colum operator*() const noexcept {
+                const auto len = pg_detail::ReadBigEndian<int32_t>(m_pos);
+                return colum{m_oid, reinterpret_cast<const char*>(m_pos + 4), len, len < 0};
+            }
+            iterator& operator++() noexcept {
+                const auto len = pg_detail::ReadBigEndian<int32_t>(m_pos);
+                m_pos += 4 + (len > 0 ? len : 0);
+                --m_left;
+                return *this;
+            }
+            iterator operator++(int) noexcept {
+                iterator copy = *this;
+                ++*this;
+                return copy;
+            }
+            bool operator==(const iterator& other) const noexcept { return m_left == other.m_left; }
+
+        private:
+            friend class array_view;
+            iterator(const std::byte* pos, const std::size_t left, const Oid oid) noexcept : m_pos(pos), m_left(left), m_oid(oid) {}
+            const std::byte* m_pos = nullptr;
+            std::size_t m_left = 0;
+            Oid m_oid = 0;
+        };
+
+        // Checks the header and that every element lies within data; nullopt if not an array.
+        static std::optional<array_view> parse(const std::span<const std::byte> data) noexcept {
+            using pg_detail::ReadBigEndian;
+            if (data.size() < 12)
+                return std::nullopt;
+            array_view out;
+            out.m_dimensions = ReadBigEndian<int32_t>(data.data());
+            const auto has_nulls = ReadBigEndian<int32_t>(data.data() + 4);
+            out.m_element_oid = ReadBigEndian<uint32_t>(data.data() + 8);
+            if (out.m_dimensions < 0 || out.m_dimensions > kMaxDimensions || (has_nulls != 0 && has_nulls != 1))
+                return std::nullopt;
+            std::size_t pos = 12;
+            if (data.size() < pos + 8 * static_cast<std::size_t>(out.m_dimensions))
+                return std::nullopt;
+            out.m_count = out.m_dimensions == 0 ? 0 : 1;
+            for (int d = 0; d < out.m_dimensions; ++d) {
+                out.m_extents[d] = ReadBigEndian<int32_t>(data.data() + pos);
+                out.m_lower_bounds[d] = ReadBigEndian<int32_t>(data.data() + pos + 4);
+                pos += 8;
+                // Every element takes at least its 4-byte length, which bounds the product.
+                if (out.m_extents[d] < 0 || (out.m_extents[d] > 0 && out.m_count > data.size() / 4 / out.m_extents[d]))
+                    return std::nullopt;
+                out.m_count *= static_cast<std::size_t>(out.m_extents[d]);
+            }
+            out.m_elements = data.subspan(pos);
+            std::size_t p = 0;
+            for (std::size_t i = 0; i < out.m_count; ++i) {
+                if (out.m_elements.size() - p < 4)
+                    return std::nullopt;
+                const auto len = ReadBigEndian<int32_t>(out.m_elements.data() + p);
+                p += 4;
+                if (len > 0) {
+                    if (out.m_elements.size() - p < static_cast<std::size_t>(len))
+                        return std::nullopt;
+                    p += static_cast<std::size_t>(len);
+                }
+            }
+            if (p != out.m_elements.size())
+                return std::nullopt;
+            return out;
+        }
+
+        [[nodiscard]] Oid element_oid() const noexcept { return m_element_oid; }
+        // Number of elements over all dimensions.
+        [[nodiscard]] std::size_t size() const noexcept { return m_count; }
+        [[nodiscard]] bool empty() const noexcept { return m_count == 0; }
+        [[nodiscard]] int dimensions() const noexcept { return m_dimensions; }
+        // Requires dim < dimensions().
+        [[nodiscard]] int32_t extent(const int dim) const noexcept { return m_extents[dim]; }
+        [[nodiscard]] int32_t lower_bound(const int dim) const noexcept { return m_lower_bounds[dim]; }
+
+        [[nodiscard]] iterator begin() const noexcept { return {m_elements.data(), m_count, m_element_oid}; }
+        [[nodiscard]] iterator end() const noexcept { return {nullptr, 0, m_element_oid}; }
+
+    private:
+        std::span<const std::byte> m_elements;
+        std::size_t m_count = 0;
+        Oid m_element_oid = 0;
+        int m_dimensions = 0;
+        std::array<int32_t, kMaxDimensions> m_extents{};
+        std::array<int32_t, kMaxDimensions> m_lower_bounds{};
+    };
+
+    // A composite (row type or anonymous ROW(...)) value, read in place: iterating yields each
+    // field as a colum of the field's own type. Binary layout: int32 field count | per field
+    // uint32 oid + int32 length (-1 for NULL) + bytes.
+    class record_view {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = colum;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            colum operator*() const noexcept {
+                const auto oid = pg_detail::ReadBigEndian<uint32_t>(m_pos);
+                const auto len = pg_detail::ReadBigEndian<int32_t>(m_pos + 4);
+                return colum{oid, reinterpret_cast<const char*>(m_pos + 8), len, len < 0};
+            }
+            iterator& operator++() noexcept {
+                const auto len = pg_detail::ReadBigEndian<int32_t>(m_pos + 4);
+                m_pos += 8 + (len > 0 ? len : 0);
+                --m_left;
+                return *this;
+            }
+            iterator operator++(int) noexcept {
+                iterator copy = *this;
+                ++*this;
+                return copy;
+            }
+            bool operator==(const iterator& other) const noexcept { return m_left == other.m_left; }
+
+        private:
+            friend class record_view;
+            iterator(const std::byte* pos, const std::size_t left) noexcept : m_pos(pos), m_left(left) {}
+            const std::byte* m_pos = nullptr;
+            std::size_t m_left = 0;
+        };
+
+        static std::optional<record_view> parse(const std::span<const std::byte> data) noexcept {
+            using pg_detail::ReadBigEndian;
+            if (data.size() < 4)
+                return std::nullopt;
+            const auto count = ReadBigEndian<int32_t>(data.data());
+            if (count < 0 || static_cast<std::size_t>(count) > (data.size() - 4) / 8)
+                return std::nullopt;
+            record_view out;
+            out.m_count = static_cast<std::size_t>(count);
+            out.m_fields = data.subspan(4);
+            std::size_t p = 0;
+            for (std::size_t i = 0; i < out.m_count; ++i) {
+                if (out.m_fields.size() - p < 8)
+                    return std::nullopt;
+                const auto len = ReadBigEndian<int32_t>(out.m_fields.data() + p + 4);
+                p += 8;
+                if (len > 0) {
+                    if (out.m_fields.size() - p < static_cast<std::size_t>(len))
+                        return std::nullopt;
+                    p += static_cast<std::size_t>(len);
+                }
+            }
+            if (p != out.m_fields.size())
+                return std::nullopt;
+            return out;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return m_count; }
+
+        [[nodiscard]] iterator begin() const noexcept { return {m_fields.data(), m_count}; }
+        [[nodiscard]] iterator end() const noexcept { return {nullptr, 0}; }
+
+    private:
+        std::span<const std::byte> m_fields;
+        std::size_t m_count = 0;
+    };
+
+    namespace pg_detail {
+        // Arrays of user-defined types, and composite types, have OIDs assigned at CREATE time.
+        constexpr bool IsArrayOid(const Oid oid) noexcept {
+            return pg_oid::ArrayElement(oid) != 0 || oid >= pg_oid::FirstUserOid;
+        }
+        constexpr bool IsRecordOid(const Oid oid) noexcept {
+            return oid == pg_oid::Record || oid >= pg_oid::FirstUserOid;
+        }
+    }
+
+    template<>
+    inline std::optional<array_view> colum::as<array_view>() const {
+        if (is_null || !pg_detail::IsArrayOid(oid))
+            return std::nullopt;
+        return array_view::parse(data);
+    }
+
+    template<>
+    inline std::optional<record_view> colum::as<record_view>() const {
+        if (is_null || !pg_detail::IsRecordOid(oid))
+            return std::nullopt;
+        return record_view::parse(data);
+    }
+
+    namespace pg_detail {
+        // An element or field read as T, where std::optional<U> lets it be NULL. Stores into out
+        // and reports whether it could.
+        template<typename T>
+        bool DecodeInto(const colum& value, T& out) {
+            if constexpr (is_optional<T>::value) {
+                if (value.null()) {
+                    out.reset();
+                    return true;
+                }
+                out = value.as<typename T::value_type>();
+                return out.has_value();
+            } else {
+                std::optional<T> decoded = value.as<T>();
+                if (!decoded)
+                    return false;
+                out = std::move(*decoded);
+                return true;
+            }
+        }
+
+        // With a resource, the vector and (through uses-allocator construction) its elements
+        // allocate from it; each element is decoded straight into that resource too, so moving it
+        // in doesn't copy.
+        template<typename Vector>
+        std::optional<Vector> DecodeArray(const colum& column, std::pmr::memory_resource* resource) {
+            using element = typename Vector::value_type;
+            const std::optional<array_view> view = column.as<array_view>();
+            if (!view)
+                return std::nullopt;
+            Vector out = [resource] {
+                if constexpr (std::is_same_v<typename Vector::allocator_type, std::pmr::polymorphic_allocator<element>>)
+                    return Vector(resource ? resource : std::pmr::get_default_resource());
+                else
+                    return Vector();
+            }();
+            out.reserve(view->size());
+            for (const colum element_cell : *view) {
+                if constexpr (is_optional<element>::value) {
+                    if (element_cell.null()) {
+                        out.emplace_back();
+                        continue;
+                    }
+                    std::optional<typename element::value_type> value = resource
+                        ? element_cell.as<typename element::value_type>(resource)
+                        : element_cell.as<typename element::value_type>();
+                    if (!value)
+                        return std::nullopt;
+                    out.push_back(std::move(value));
+                } else {
+                    std::optional<element> value = resource ? element_cell.as<element>(resource) : element_cell.as<element>();
+                    if (!value)
+                        return std::nullopt;
+                    out.push_back(std::move(*value));
+                }
+            }
+            return out;
+        }
+
+        template<typename Tuple, std::size_t... I>
+        bool DecodeFields(const std::array<colum, sizeof...(I)>& fields, Tuple& out, std::index_sequence<I...>) {
+            return (DecodeInto(fields[I], std::get<I>(out)) && ...);
+        }
+
+        template<typename Tuple>
+        std::optional<Tuple> DecodeRecord(const colum& column) {
+            constexpr std::size_t n = std::tuple_size_v<Tuple>;
+            const std::optional<record_view> view = column.as<record_view>();
+            if (!view || view->size() != n)
+                return std::nullopt;
+            std::array<colum, n> fields;
+            std::size_t i = 0;
+            for (const colum field : *view)
+                fields[i++] = field;
+            Tuple out;
+            if (!DecodeFields(fields, out, std::make_index_sequence<n>{}))
+                return std::nullopt;
+            return out;
+        }
+    }
+
+    // Whether colum::as<T>() decodes columns of type oid; lets a whole result be checked against a
+    // set of C++ types once instead of per cell. Keep in step with the specializations above.
+    template<typename T>
+    constexpr bool Decodes(const Oid oid) noexcept {
+        if constexpr (std::is_same_v<T, bool>)
+            return oid == pg_oid::Bool;
+        else if constexpr (std::is_same_v<T, int16_t>)
+            return oid == pg_oid::Int2;
+        else if constexpr (std::is_same_v<T, int32_t>)
+            return oid == pg_oid::Int4 || oid == pg_oid::Int2;
+        else if constexpr (std::is_same_v<T, int64_t>)
+            return oid == pg_oid::Int8 || oid == pg_oid::Int4 || oid == pg_oid::Int2;
+        else if constexpr (std::is_same_v<T, float>)
+            return oid == pg_oid::Float4;
+        else if constexpr (std::is_same_v<T, double>)
+            return oid == pg_oid::Float8 || oid == pg_oid::Float4;
+        else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::pmr::string>)
+            return oid == pg_oid::Text || oid == pg_oid::Varchar || oid == pg_oid::Bpchar;
+        else if constexpr (std::is_same_v<T, timestamp>)
+            return oid == pg_oid::Timestamp || oid == pg_oid::Timestamptz;
+        else if constexpr (std::is_same_v<T, uint16_t>)
+            return oid == pg_oid::Int4;
+        else if constexpr (std::is_same_v<T, uint32_t>)
+            return oid == pg_oid::Int8;
+        else if constexpr (std::is_same_v<T, uint64_t>)
+            return oid == pg_oid::Numeric;
+        else if constexpr (std::is_same_v<T, std::vector<std::byte>> || std::is_same_v<T, std::pmr::vector<std::byte>>)
+            return oid == pg_oid::Bytea;
+        else if constexpr (std::is_same_v<T, uuid>)
+            return oid == pg_oid::Uuid;
+        else if constexpr (std::is_same_v<T, jsonb>)
+            return oid == pg_oid::Jsonb || oid == pg_oid::Json;
+        else if constexpr (std::is_same_v<T, std::chrono::sys_days>)
+            return oid == pg_oid::Date;
+        else if constexpr (std::is_same_v<T, time_of_day>)
+            return oid == pg_oid::Time;
+        else if constexpr (std::is_same_v<T, interval>)
+            return oid == pg_oid::Interval;
+        else if constexpr (std::is_same_v<T, inet>)
+            return oid == pg_oid::Inet || oid == pg_oid::Cidr;
+        else if constexpr (std::is_same_v<T, range<int32_t>>)
+            return oid == pg_oid::Int4Range;
+        else if constexpr (std::is_same_v<T, range<int64_t>>)
+            return oid == pg_oid::Int8Range;
+        else if constexpr (std::is_same_v<T, range<timestamp>>)
+            return oid == pg_oid::TsRange || oid == pg_oid::TstzRange;
+        else if constexpr (std::is_same_v<T, std::string_view>)
+            return oid == pg_oid::Text || oid == pg_oid::Varchar || oid == pg_oid::Bpchar;
+        else if constexpr (std::is_same_v<T, array_view>)
+            return pg_detail::IsArrayOid(oid);
+        else if constexpr (std::is_same_v<T, record_view> || pg_detail::is_tuple<T>::value)
+            return pg_detail::IsRecordOid(oid);
+        else if constexpr (pg_detail::is_array_target<T>::value) {
+            // The element check has to wait for the data when the array type is user-defined.
+            using element = typename T::value_type;
+            const Oid element_oid = pg_oid::ArrayElement(oid);
+            if (element_oid == 0)
+                return oid >= pg_oid::FirstUserOid;
+            if constexpr (pg_detail::is_optional<element>::value)
+                return Decodes<typename element::value_type>(element_oid);
+            else
+                return Decodes<element>(element_oid);
+        }
+        else
+            return false;
+    }
+}
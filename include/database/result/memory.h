@@ -0,0 +1,47 @@
+//
+// Created by Shinnosuke Kawai on 4/26/26.
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+namespace database::result {
+    struct memory_stats {
+        std::size_t current_bytes = 0; // held by tables alive right now
+        std::size_t peak_bytes = 0;    // highest current_bytes since start or reset_peak()
+    };
+
+    // Bytes held by the live tables of one client, or of every client sharing it through
+    // ClientConfig::result_memory (a pool). Each table adds its memory_size() when it is made and
+    // takes it back when it is destroyed.
+    class memory_tracker {
+    public:
+        void acquire(const std::size_t bytes) noexcept {
+            const std::size_t now = m_current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            std::size_t peak = m_peak.load(std::memory_order_relaxed);
+            while (now > peak && !m_peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+            }
+        }
+
+        void release(const std::size_t bytes) noexcept {
+            m_current.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::size_t current() const noexcept {
+            return m_current.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] memory_stats stats() const noexcept {
+            return {m_current.load(std::memory_order_relaxed), m_peak.load(std::memory_order_relaxed)};
+        }
+
+        void reset_peak() noexcept {
+            m_peak.store(m_current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<std::size_t> m_current{0};
+        std::atomic<std::size_t> m_peak{0};
+    };
+}
@@ -3,33 +3,191 @@
 //
 
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <libpq-fe.h>
 #include "colunm.h"
 
 namespace database::result {
-    struct row {
-        explicit row() = default;
+    namespace pg_detail {
+        // FNV-1a; constexpr so column_key can hash its literal at compile time.
+        constexpr std::uint64_t HashName(const std::string_view name) noexcept {
+            std::uint64_t hash = 14695981039346656037ULL;
+            for (const char ch : name) {
+                hash ^= static_cast<unsigned char>(ch);
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+    }
+
+    // Name and type of a result column, kept once per result. The name points into the PGresult.
+    struct column_info {
+        std::string_view name;
+        Oid oid = 0;
+        std::uint64_t hash = 0;
+    };
+
+    // A column name fixed at compile time: column_key{"id"} is hashed by the compiler, so looking it
+    // up only compares against the hashes the table computed once for its columns.
+    struct column_key {
+        template<std::size_t N>
+        consteval explicit column_key(const char (&literal)[N]) noexcept
+        : name(literal, N - 1), hash(pg_detail::HashName(name)) {}
+
+        std::string_view name;
+        std::uint64_t hash;
+    };
+
+    // A column's position in one result, from table::handle(). Resolve it before the row loop and
+    // every access is a plain index; it means nothing for a result with a different column list.
+    class column_handle {
+    public:
+        column_handle() = default;
+
+        [[nodiscard]] bool valid() const noexcept { return m_index >= 0; }
+        explicit operator bool() const noexcept { return valid(); }
+        [[nodiscard]] int index() const noexcept { return m_index; }
+
+    private:
+        friend class table;
+        friend class row;
+        explicit column_handle(const int index) noexcept : m_index(index) {}
+        int m_index = -1;
+    };
 
-        row(row&& other) noexcept = default;
-        row& operator=(row&& other) noexcept = default;
-        row(const row&) = delete;
-        row& operator=(const row&) = delete;
+    // One row of a table: a view into the table's PGresult, valid while the table lives. Cells are
+    // decoded only when asked for.
+    class row {
+    public:
+        row() = default;
 
         template<typename T>
         std::optional<T> get(const std::string_view f_name) const {
-            const auto it = m_columns.find(std::string(f_name));
-            if (it == m_columns.end())
-                return std::nullopt;
-            return it->second.as<T>();
+            return At(Find(f_name)).template as<T>();
+        }
+        template<typename T>
+        std::optional<T> get(const column_key key) const {
+            return At(Find(key)).template as<T>();
+        }
+        template<typename T>
+        std::optional<T> get(const column_handle column) const {
+            return At(column.m_index).template as<T>();
+        }
+        template<typename T>
+        std::optional<T> get(const std::size_t index) const {
+            return At(Position(index)).template as<T>();
         }
 
-        const colum& operator[](const std::string_view f_name) const {
-            static const colum kNull{};
-            const auto it = m_columns.find(std::string(f_name));
-            return it != m_columns.end() ? it->second : kNull;
+        // Any of the above keys, decoding what T allocates into resource; see colum::as().
+        template<typename T, typename Key>
+        std::optional<T> get(const Key key, std::pmr::memory_resource* resource) const {
+            return (*this)[key].template as<T>(resource);
         }
 
+        // Each of these reads as a NULL column when the result has no such column.
+        colum operator[](const std::string_view f_name) const { return At(Find(f_name)); }
+        colum operator[](const column_key key) const { return At(Find(key)); }
+        colum operator[](const column_handle column) const { return At(column.m_index); }
+        colum operator[](const std::size_t index) const { return At(Position(index)); }
+
+        // Number of columns.
+        [[nodiscard]] std::size_t size() const noexcept { return m_columns.size(); }
+
     private:
         friend class table;
-        std::unordered_map<std::string, colum> m_columns = {};
+        friend class row_range;
+
+        row(const PGresult* res, const std::span<const column_info> columns, const int index) noexcept
+        : m_res(res), m_columns(columns), m_index(index) {}
+
+        // Wide rows are a few dozen columns at most: a scan over the shared names beats hashing.
+        [[nodiscard]] int Find(const std::string_view f_name) const noexcept {
+            for (std::size_t c = 0; c < m_columns.size(); ++c) {
+                if (m_columns[c].name == f_name)
+                    return static_cast<int>(c);
+            }
+            return -1;
+        }
+
+        [[nodiscard]] int Find(const column_key key) const noexcept {
+            for (std::size_t c = 0; c < m_columns.size(); ++c) {
+                if (m_columns[c].hash == key.hash && m_columns[c].name == key.name)
+                    return static_cast<int>(c);
+            }
+            return -1;
+        }
+
+        [[nodiscard]] int Position(const std::size_t index) const noexcept {
+            return index < m_columns.size() ? static_cast<int>(index) : -1;
+        }
+
+        [[nodiscard]] colum At(const int c) const noexcept {
+            if (c < 0 || static_cast<std::size_t>(c) >= m_columns.size())
+                return colum{};
+            if (PQgetisnull(m_res, m_index, c))
+                return colum{m_columns[c].oid, nullptr, 0, true};
+            return colum{m_columns[c].oid, PQgetvalue(m_res, m_index, c), PQgetlength(m_res, m_index, c), false};
+        }
+
+    private:
+        const PGresult* m_res = nullptr;
+        std::span<const column_info> m_columns;
+        int m_index = 0;
+    };
+
+    // What table::rows() returns: indexable and iterable like a container of rows, but the rows
+    // are made on the fly from the result instead of being stored.
+    class row_range {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = row;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            // The row lives in the iterator, so it stays valid until the iterator moves on.
+            const row& operator*() const noexcept { return m_row; }
+            const row* operator->() const noexcept { return &m_row; }
+            iterator& operator++() noexcept {
+                ++m_row.m_index;
+                return *this;
+            }
+            iterator operator++(int) noexcept {
+                iterator copy = *this;
+                ++m_row.m_index;
+                return copy;
+            }
+            bool operator==(const iterator& other) const noexcept { return m_row.m_index == other.m_row.m_index; }
+
+        private:
+            friend class row_range;
+            explicit iterator(const row& at) noexcept : m_row(at) {}
+            row m_row;
+        };
+
+        [[nodiscard]] std::size_t size() const noexcept { return static_cast<std::size_t>(m_count); }
+        [[nodiscard]] bool empty() const noexcept { return m_count == 0; }
+
+        // Requires index < size().
+        row operator[](const std::size_t index) const noexcept { return row{m_res, m_columns, static_cast<int>(index)}; }
+
+        [[nodiscard]] iterator begin() const noexcept { return iterator{row{m_res, m_columns, 0}}; }
+        [[nodiscard]] iterator end() const noexcept { return iterator{row{m_res, m_columns, m_count}}; }
+
+    private:
+        friend class table;
+        row_range(const PGresult* res, const std::span<const column_info> columns, const int count) noexcept
+        : m_res(res), m_columns(columns), m_count(count) {}
+
+        const PGresult* m_res = nullptr;
+        std::span<const column_info> m_columns;
+        int m_count = 0;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,282 @@
+//
+// Created by Shinnosuke Kawai on 4/21/26.
+//
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <expected>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "row.h"
+#include "../postgres_error.h"
+
+namespace database::result {
+    namespace pg_detail {
+        // Converts to any field type; only ever used unevaluated, to count an aggregate's fields.
+        struct any_field {
+            template<typename T>
+            operator T() const noexcept;
+        };
+
+        template<typename T, std::size_t... I>
+        constexpr bool BraceConstructible(std::index_sequence<I...>) noexcept {
+            return requires { T{(void(I), any_field{})...}; };
+        }
+
+        inline constexpr std::size_t kMaxRowFields = 32;
+
+        template<typename T, std::size_t N = 0>
+        constexpr std::size_t FieldCount() noexcept {
+            if constexpr (N <= kMaxRowFields && BraceConstructible<T>(std::make_index_sequence<N + 1>{}))
+                return FieldCount<T, N + 1>();
+            else
+                return N;
+        }
+
+        template<typename T>
+        struct optional_traits {
+            using value_type = T;
+            static constexpr bool nullable = false;
+        };
+        template<typename T>
+        struct optional_traits<std::optional<T>> {
+            using value_type = T;
+            static constexpr bool nullable = true;
+        };
+
+        // The fields of value as a tuple of references, in declaration order.
+        template<std::size_t N, typename T>
+        auto TieFields(T& value) noexcept {
+            if constexpr (N == 32) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30, f31] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30, f31);
+            } else if constexpr (N == 31) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30);
+            } else if constexpr (N == 30) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29);
+            } else if constexpr (N == 29) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28);
+            } else if constexpr (N == 28) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27);
+            } else if constexpr (N == 27) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26);
+            } else if constexpr (N == 26) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25);
+            } else if constexpr (N == 25) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24);
+            } else if constexpr (N == 24) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23);
+            } else if constexpr (N == 23) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22);
+            } else if constexpr (N == 22) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21);
+            } else if constexpr (N == 21) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20);
+            } else if constexpr (N == 20) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19);
+            } else if constexpr (N == 19) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18);
+            } else if constexpr (N == 18) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17);
+            } else if constexpr (N == 17) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16);
+            } else if constexpr (N == 16) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15);
+            } else if constexpr (N == 15) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14);
+            } else if constexpr (N == 14) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13);
+            } else if constexpr (N == 13) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12);
+            } else if constexpr (N == 12) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11);
+            } else if constexpr (N == 11) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10);
+            } else if constexpr (N == 10) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9);
+            } else if constexpr (N == 9) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8);
+            } else if constexpr (N == 8) {
+                auto& [f0, f1, f2, f3, f4, f5, f6, f7] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6, f7);
+            } else if constexpr (N == 7) {
+                auto& [f0, f1, f2, f3, f4, f5, f6] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5, f6);
+            } else if constexpr (N == 6) {
+                auto& [f0, f1, f2, f3, f4, f5] = value;
+                return std::tie(f0, f1, f2, f3, f4, f5);
+            } else if constexpr (N == 5) {
+                auto& [f0, f1, f2, f3, f4] = value;
+                return std::tie(f0, f1, f2, f3, f4);
+            } else if constexpr (N == 4) {
+                auto& [f0, f1, f2, f3] = value;
+                return std::tie(f0, f1, f2, f3);
+            } else if constexpr (N == 3) {
+                auto& [f0, f1, f2] = value;
+                return std::tie(f0, f1, f2);
+            } else if constexpr (N == 2) {
+                auto& [f0, f1] = value;
+                return std::tie(f0, f1);
+            } else if constexpr (N == 1) {
+                auto& [f0] = value;
+                return std::tie(f0);
+            }
+        }
+    }
+
+    // A plain aggregate whose fields are each a type colum::as<T>() decodes, or an std::optional of
+    // one (NULL -> nullopt). Fields map to result columns by position, or by name when the struct
+    // lists them as a static constexpr column_names array of the same length:
+    //
+    //     struct user_row {
+    //         int64_t id;
+    //         std::string name;
+    //         std::optional<double> score;
+    //         static constexpr std::array<std::string_view, 3> column_names = {"id", "name", "score"};
+    //     };
+    template<typename T>
+    concept mappable_row = std::is_aggregate_v<T> && std::is_default_constructible_v<T> &&
+                           pg_detail::FieldCount<T>() > 0 && pg_detail::FieldCount<T>() <= pg_detail::kMaxRowFields;
+
+    template<typename T>
+    concept named_row = mappable_row<T> && requires {
+        { T::column_names.size() } -> std::convertible_to<std::size_t>;
+        { std::string_view{T::column_names[0]} };
+    };
+
+    // Matches Row's fields to a result's columns and checks their types once; decode() then reads
+    // each row straight from the wire bytes with no lookups left.
+    template<mappable_row Row>
+    class row_mapper {
+    public:
+        static constexpr std::size_t kFields = pg_detail::FieldCount<Row>();
+
+        static std::expected<row_mapper, sql_error> bind(const std::span<const column_info> columns) {
+            row_mapper mapper;
+            if constexpr (named_row<Row>) {
+                static_assert(Row::column_names.size() == kFields, "column_names must name every field");
+                for (std::size_t f = 0; f < kFields; ++f) {
+                    const std::string_view name = Row::column_names[f];
+                    int found = -1;
+                    for (std::size_t c = 0; c < columns.size() && found < 0; ++c) {
+                        if (columns[c].name == name)
+                            found = static_cast<int>(c);
+                    }
+                    if (found < 0)
+                        return std::unexpected(sql_error::ResultMismatch("result has no column for a row field"));
+                    mapper.m_columns[f] = found;
+                }
+            } else {
+                if (columns.size() != kFields)
+                    return std::unexpected(sql_error::ResultMismatch("result column count differs from the row's field count"));
+                for (std::size_t f = 0; f < kFields; ++f)
+                    mapper.m_columns[f] = static_cast<int>(f);
+            }
+            if (!mapper.TypesMatch(columns, std::make_index_sequence<kFields>{}))
+                return std::unexpected(sql_error::ResultMismatch("column type can't be decoded into its row field"));
+            return mapper;
+        }
+
+        // False on a NULL in a non-optional field or a value of the wrong width.
+        bool decode(const row& source, Row& out) const {
+            auto fields = pg_detail::TieFields<kFields>(out);
+            return DecodeFields(source, fields, std::make_index_sequence<kFields>{});
+        }
+
+        // The same, with the fields that allocate (std::pmr::string, std::pmr::vector) decoded into
+        // resource. The Row is built from the decoded values rather than assigned into, as a
+        // std::pmr container assigned from another resource copies.
+        std::optional<Row> decode(const row& source, std::pmr::memory_resource* resource) const {
+            return Build(source, resource, std::make_index_sequence<kFields>{});
+        }
+
+    private:
+        using field_types = decltype(pg_detail::TieFields<kFields>(std::declval<Row&>()));
+
+        template<std::size_t I>
+        using field_type = std::remove_cvref_t<std::tuple_element_t<I, field_types>>;
+
+        template<std::size_t... I>
+        bool TypesMatch(const std::span<const column_info> columns, std::index_sequence<I...>) const noexcept {
+            return (Decodes<typename pg_detail::optional_traits<std::remove_cvref_t<std::tuple_element_t<I, field_types>>>::value_type>(
+                        columns[m_columns[I]].oid) && ...);
+        }
+
+        template<typename Fields, std::size_t... I>
+        bool DecodeFields(const row& source, Fields& fields, std::index_sequence<I...>) const {
+            return (DecodeField(source[static_cast<std::size_t>(m_columns[I])], std::get<I>(fields)) && ...);
+        }
+
+        template<typename F>
+        static bool DecodeField(const colum& cell, F& out) {
+            using traits = pg_detail::optional_traits<F>;
+            if (cell.null())
+                return traits::nullable;
+            auto decoded = cell.as<typename traits::value_type>();
+            if (!decoded)
+                return false;
+            out = std::move(*decoded);
+            return true;
+        }
+
+        template<std::size_t... I>
+        std::optional<Row> Build(const row& source, std::pmr::memory_resource* resource, std::index_sequence<I...>) const {
+            std::tuple<std::optional<field_type<I>>...> fields;
+            const bool decoded = (DecodeField(source[static_cast<std::size_t>(m_columns[I])], std::get<I>(fields), resource) && ...);
+            if (!decoded)
+                return std::nullopt;
+            return Row{std::move(*std::get<I>(fields))...};
+        }
+
+        template<typename F>
+        static bool DecodeField(const colum& cell, std::optional<F>& out, std::pmr::memory_resource* resource) {
+            using traits = pg_detail::optional_traits<F>;
+            if (cell.null()) {
+                if constexpr (traits::nullable)
+                    out.emplace();
+                return traits::nullable;
+            }
+            auto decoded = cell.as<typename traits::value_type>(resource);
+            if (!decoded)
+                return false;
+            if constexpr (traits::nullable)
+                out.emplace(std::move(decoded));
+            else
+                out.emplace(std::move(*decoded));
+            return true;
+        }
+
+    private:
+        std::array<int, kFields> m_columns{};
+    };
+}
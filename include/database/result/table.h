@@ -3,11 +3,16 @@
 //
 
 #pragma once
-#include <deque>
+#include <charconv>
+#include <memory>
+#include <span>
 #include <string>
-#include <unordered_map>
 #include <vector>
+#include "arrow.h"
+#include "column_data.h"
+#include "memory.h"
 #include "row.h"
+#include "row_mapping.h"
 #include <libpq-fe.h>
 
 namespace database::result {
@@ -20,51 +25,219 @@ namespace database::result {
 
     using unique_pg_result = std::unique_ptr<PGresult, result_deleter>;
 
+    // A query result. Rows and cells are views into the PGresult, decoded only on access; the
+    // column names and types are gathered once. Building one costs a single allocation.
     class table {
     public:
         explicit table(unique_pg_result pg_res) : m_pg_res(std::move(pg_res)) {
-            const int n_rows = PQntuples(m_pg_res.get());
             const int n_cols = PQnfields(m_pg_res.get());
+            m_columns.reserve(n_cols);
+            for (int c = 0; c < n_cols; ++c) {
+                const std::string_view name = PQfname(m_pg_res.get(), c);
+                m_columns.push_back({name, PQftype(m_pg_res.get(), c), pg_detail::HashName(name)});
+            }
+        }
 
-            std::vector<std::string> col_names(n_cols);
-            for (int c = 0; c < n_cols; ++c)
-                col_names[c] = PQfname(m_pg_res.get(), c);
-
-            for (int r = 0; r < n_rows; ++r) {
-                row row{};
-                row.m_columns.reserve(n_cols);
-                for (int c = 0; c < n_cols; ++c) {
-                    const Oid oid = PQftype(m_pg_res.get(), c);
-                    int val_len = 0;
-                    char* val = nullptr;
-                    const bool is_null = PQgetisnull(m_pg_res.get(), r, c);
-                    if (!is_null) {
-                        val_len = PQgetlength(m_pg_res.get(), r, c);
-                        val = PQgetvalue(m_pg_res.get(), r, c);
-                    }
-                    colum column{oid, val, val_len, is_null};
-                    row.m_columns[col_names[c]] = std::move(column);
-                }
-                m_table.emplace_back(std::move(row));
+        // Counted in tracker for as long as it lives.
+        table(unique_pg_result pg_res, std::shared_ptr<memory_tracker> tracker) : table(std::move(pg_res)) {
+            if (tracker) {
+                m_tracked = memory_size();
+                tracker->acquire(m_tracked);
+                m_tracker = std::move(tracker);
             }
         }
 
+        ~table() {
+            if (m_tracker)
+                m_tracker->release(m_tracked);
+        }
+
         table(const table&) = delete;
         table& operator=(const table&) = delete;
 
         table(table&& other) noexcept = default;
-        table& operator=(table&& other) noexcept = default;
+        table& operator=(table&& other) noexcept {
+            if (this != &other) {
+                if (m_tracker)
+                    m_tracker->release(m_tracked);
+                m_pg_res = std::move(other.m_pg_res);
+                m_columns = std::move(other.m_columns);
+                m_tracker = std::move(other.m_tracker);
+                m_tracked = other.m_tracked;
+            }
+            return *this;
+        }
 
-        const std::deque<row>& rows() const noexcept {
-            return m_table;
+        // Rows stay valid while this table lives, also across a move of it.
+        row_range rows() const noexcept {
+            return row_range{m_pg_res.get(), m_columns, PQntuples(m_pg_res.get())};
         }
 
         size_t size() const noexcept {
-            return m_table.size();
+            return static_cast<size_t>(PQntuples(m_pg_res.get()));
+        }
+
+        // Bytes this table keeps alive: the PGresult, headers and all, plus the column index.
+        std::size_t memory_size() const noexcept {
+            return PQresultMemorySize(m_pg_res.get()) + m_columns.capacity() * sizeof(column_info);
+        }
+
+        std::span<const column_info> columns() const noexcept {
+            return m_columns;
+        }
+
+        // Resolves a column once for use on every row of this table; invalid when there is none.
+        column_handle handle(const std::string_view name) const noexcept {
+            return handle(pg_detail::HashName(name), name);
+        }
+        column_handle handle(const column_key key) const noexcept {
+            return handle(key.hash, key.name);
+        }
+
+        // Every row decoded into a Row, see mappable_row. Fields are matched to columns and
+        // type-checked once up front; a mismatch, or a NULL in a non-optional field, fails the
+        // whole call with ResultMismatch.
+        template<mappable_row Row>
+        std::expected<std::vector<Row>, sql_error> as() const {
+            std::expected<row_mapper<Row>, sql_error> mapper = row_mapper<Row>::bind(m_columns);
+            if (!mapper)
+                return std::unexpected(std::move(mapper.error()));
+            std::vector<Row> out;
+            out.reserve(size());
+            for (const row& source : rows()) {
+                if (!mapper->decode(source, out.emplace_back()))
+                    return std::unexpected(sql_error::ResultMismatch("NULL or malformed value for a row field"));
+            }
+            return out;
+        }
+
+        // The same into a vector allocating from resource, e.g. a per-request arena. Fields of
+        // type std::pmr::string or std::pmr::vector are decoded into resource as well.
+        template<mappable_row Row>
+        std::expected<std::pmr::vector<Row>, sql_error> as(std::pmr::memory_resource* resource) const {
+            std::expected<row_mapper<Row>, sql_error> mapper = row_mapper<Row>::bind(m_columns);
+            if (!mapper)
+                return std::unexpected(std::move(mapper.error()));
+            std::pmr::vector<Row> out(resource);
+            out.reserve(size());
+            for (const row& source : rows()) {
+                std::optional<Row> decoded = mapper->decode(source, resource);
+                if (!decoded)
+                    return std::unexpected(sql_error::ResultMismatch("NULL or malformed value for a row field"));
+                out.push_back(std::move(*decoded));
+            }
+            return out;
+        }
+
+        // A whole column at once, with NULLs in a separate bitmap. int16/32/64, float, double and
+        // timestamp columns of the matching PostgreSQL type are copied and byte-swapped in bulk;
+        // any other type colum::as<T>() decodes goes cell by cell. ResultMismatch when there is no
+        // such column or T can't be read from it.
+        template<typename T>
+        std::expected<column_data<T>, sql_error> column(const std::string_view name) const {
+            return column<T>(handle(name));
+        }
+        template<typename T>
+        std::expected<column_data<T>, sql_error> column(const column_handle col) const {
+            return ExtractColumn(col, column_data<T>{}, nullptr);
+        }
+
+        // The same with the buffers, and whatever the values allocate, taken from resource.
+        template<typename T>
+        std::expected<pmr::column_data<T>, sql_error> column(const std::string_view name, std::pmr::memory_resource* resource) const {
+            return column<T>(handle(name), resource);
+        }
+        template<typename T>
+        std::expected<pmr::column_data<T>, sql_error> column(const column_handle col, std::pmr::memory_resource* resource) const {
+            pmr::column_data<T> data{.values = std::pmr::vector<T>(resource), .validity = std::pmr::vector<std::uint8_t>(resource)};
+            return ExtractColumn(col, std::move(data), resource);
+        }
+
+        // The same into caller-owned storage: out needs size() elements and validity, unless left
+        // empty, BitmapBytes(size()). Returns the number of NULLs.
+        template<typename T>
+        std::expected<std::size_t, sql_error> column(const std::string_view name, const std::span<T> out,
+                                                     const std::span<std::uint8_t> validity = {}) const {
+            return column<T>(handle(name), out, validity);
+        }
+        template<typename T>
+        std::expected<std::size_t, sql_error> column(const column_handle col, const std::span<T> out,
+                                                     const std::span<std::uint8_t> validity = {}) const {
+            return ExtractInto(col, out, validity, nullptr);
+        }
+
+        // Exports the result as one Arrow record batch (a struct array with a child per column)
+        // through the C Data Interface; the caller owns schema and array and must release them.
+        // Fixed-width columns are byte-swapped straight into the Arrow buffers; see ArrowTypeFor()
+        // for the type mapping.
+        std::expected<void, sql_error> to_arrow(ArrowSchema* schema, ArrowArray* array) const {
+            return pg_detail::ExportResult(m_pg_res.get(), m_columns, schema, array);
+        }
+
+        // Rows touched by an INSERT/UPDATE/DELETE/COPY etc., 0 when the command reports none.
+        size_t affected_rows() const noexcept {
+            const char* tuples = PQcmdTuples(m_pg_res.get());
+            const std::string_view str = tuples ? tuples : "";
+            // A result gathered from chunks under a memory budget has no command tag; rows were
+            // only chunked if the command returned some, and then it touched exactly those.
+            if (const char* tag = PQcmdStatus(m_pg_res.get()); tag && *tag == '\0' && PQresultStatus(m_pg_res.get()) == PGRES_TUPLES_OK)
+                return size();
+            size_t n = 0;
+            std::from_chars(str.data(), str.data() + str.size(), n);
+            return n;
+        }
+
+    private:
+        template<typename T>
+        std::expected<std::size_t, sql_error> ExtractInto(const column_handle col, const std::span<T> out,
+                                                          const std::span<std::uint8_t> validity,
+                                                          std::pmr::memory_resource* resource) const {
+            if (!col)
+                return std::unexpected(sql_error::ResultMismatch("no such column in the result"));
+            const Oid oid = m_columns[col.index()].oid;
+            if (!Decodes<T>(oid))
+                return std::unexpected(sql_error::ResultMismatch("column type can't be read as the requested type"));
+            if (out.size() < size() || (!validity.empty() && validity.size() < BitmapBytes(size())))
+                return std::unexpected(sql_error::ResultMismatch("output buffer is smaller than the column"));
+
+            std::ptrdiff_t nulls;
+            if constexpr (pg_detail::kBulkDecodable<T>) {
+                nulls = pg_detail::FixedWidth<T>(oid)
+                    ? pg_detail::ExtractFixed<T>(m_pg_res.get(), col.index(), out, validity)
+                    : pg_detail::ExtractCells<T>(m_pg_res.get(), col.index(), out, validity);
+            } else {
+                nulls = pg_detail::ExtractCells<T>(m_pg_res.get(), col.index(), out, validity, resource);
+            }
+            if (nulls < 0)
+                return std::unexpected(sql_error::ResultMismatch("malformed value in column"));
+            return static_cast<std::size_t>(nulls);
+        }
+
+        template<typename Data>
+        std::expected<Data, sql_error> ExtractColumn(const column_handle col, Data data, std::pmr::memory_resource* resource) const {
+            using T = typename decltype(data.values)::value_type;
+            static_assert(!std::is_same_v<T, bool>, "std::vector<bool> has no span; use the span overload");
+            data.values.resize(size());
+            data.validity.resize(BitmapBytes(size()));
+            std::expected<std::size_t, sql_error> nulls = ExtractInto<T>(col, data.values, data.validity, resource);
+            if (!nulls)
+                return std::unexpected(std::move(nulls.error()));
+            data.null_count = *nulls;
+            return data;
+        }
+
+        column_handle handle(const std::uint64_t hash, const std::string_view name) const noexcept {
+            for (std::size_t c = 0; c < m_columns.size(); ++c) {
+                if (m_columns[c].hash == hash && m_columns[c].name == name)
+                    return column_handle{static_cast<int>(c)};
+            }
+            return {};
         }
 
     private:
-        std::deque<row> m_table;
         unique_pg_result  m_pg_res;
+        std::vector<column_info> m_columns;
+        std::shared_ptr<memory_tracker> m_tracker;
+        std::size_t m_tracked = 0;
     };
 }
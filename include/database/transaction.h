@@ -3,14 +3,21 @@
 //
 
 #pragma once
-#include <future>
 #include <expected>
 #include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "cursor.h"
 #include "query_executor.h"
+#include "query_awaitable.h"
 #include "internal/type_detail.h"
 
 namespace database {
-    class transaction {
+    class transaction;
+    using shared_transaction = std::shared_ptr<transaction>;
+
+    class transaction : public std::enable_shared_from_this<transaction> {
     public:
         explicit transaction(query_executor& executor) noexcept;
         ~transaction();
@@ -21,34 +28,95 @@ namespace database {
         transaction& operator=(transaction&&) = delete;
 
         template<typename... param>
-        std::future<std::expected<result::table, sql_error>> execute(std::string_view query, param&&... params) {
-            const std::array<supported_type, sizeof...(params)> arr = {
-                internal::CreateSingleData(std::forward<param>(params))...
-            };
+        query_future<std::expected<result::table, sql_error>> execute(std::string_view query, param&&... params) {
+            return Execute(no_deadline, query, std::forward<param>(params)...);
+        }
+
+        // See postgres_client::execute(timeout, ...). A statement cancelled on its deadline
+        // aborts the transaction like any other failed statement.
+        template<typename Rep, typename Period, typename... param>
+        query_future<std::expected<result::table, sql_error>> execute(const std::chrono::duration<Rep, Period> timeout, std::string_view query, param&&... params) {
+            return Execute(internal::DeadlineAfter(timeout), query, std::forward<param>(params)...);
+        }
+
+        // See postgres_client::execute<Row>().
+        template<result::mappable_row Row, typename... param>
+        query_future<std::expected<std::vector<Row>, sql_error>> execute(std::string_view query, param&&... params) {
+            pg_param_detail detail = internal::MakePgParams(query, std::forward<param>(params)...);
             std::unique_lock lock(m_mutex);
             if (m_state != state::active) {
-                std::promise<std::expected<result::table, sql_error>> p;
-                p.set_value(std::unexpected(sql_error::TransactionRolledBack()));
-                return p.get_future();
+                return query_future<std::expected<std::vector<Row>, sql_error>>::ready(std::unexpected(sql_error::TransactionRolledBack()));
             }
-            return m_executor->SendToWorker(internal::MakePgParamBuffer(query, arr));
+            return m_executor->SendMappedToWorker<Row>(std::move(detail), no_deadline);
         }
 
         template<typename... Args>
         void execute_async(std::string_view query, result_callback&& on_success, error_callback&& on_error, Args&&... params) {
-            const std::array<supported_type, sizeof...(params)> arr = {
-                internal::CreateSingleData(std::forward<Args>(params))...
-            };
+            ExecuteAsync(no_deadline, query, std::move(on_success), std::move(on_error), std::forward<Args>(params)...);
+        }
+
+        template<typename Rep, typename Period, typename... Args>
+        void execute_async(const std::chrono::duration<Rep, Period> timeout, std::string_view query, result_callback&& on_success, error_callback&& on_error, Args&&... params) {
+            ExecuteAsync(internal::DeadlineAfter(timeout), query, std::move(on_success), std::move(on_error), std::forward<Args>(params)...);
+        }
+
+        // See postgres_client::execute_stream().
+        template<typename... Args>
+        query_future<std::expected<std::size_t, sql_error>> execute_stream(std::string_view query, row_batch_callback on_rows, Args&&... params) {
+            pg_param_detail detail = internal::MakePgParams(query, std::forward<Args>(params)...);
             std::unique_lock lock(m_mutex);
             if (m_state != state::active) {
-                lock.unlock();
-                on_error(sql_error::TransactionRolledBack());
-                return;
+                return query_future<std::expected<std::size_t, sql_error>>::ready(std::unexpected(sql_error::TransactionRolledBack()));
             }
-            m_executor->EnqueueAsync(
-                internal::MakePgParamBuffer(query, arr),
-                std::move(on_success),
-                std::move(on_error));
+            return m_executor->SendStreamToWorker(std::move(detail), std::move(on_rows));
+        }
+
+        // See postgres_client::execute_many(). A failed item aborts the transaction like any other
+        // failed statement.
+        template<std::ranges::forward_range Rows>
+        query_future<std::expected<result::batch_result, sql_error>> execute_many(std::string_view query, Rows&& rows) {
+            pg_param_detail detail = internal::MakePgBatch(query, std::forward<Rows>(rows));
+            std::unique_lock lock(m_mutex);
+            if (m_state != state::active) {
+                return query_future<std::expected<result::batch_result, sql_error>>::ready(std::unexpected(sql_error::TransactionRolledBack()));
+            }
+            return m_executor->SendBatchToWorker(std::move(detail));
+        }
+
+        // co_await txn->query(...); see postgres_client::query(). The resumed coroutine runs on the
+        // callback pool, so it may commit(), rollback() or drop the last reference.
+        template<typename... Args>
+        query_awaitable query(std::string_view query, Args&&... params) {
+            return Query(no_deadline, query, std::forward<Args>(params)...);
+        }
+
+        template<typename Rep, typename Period, typename... Args>
+        query_awaitable query(const std::chrono::duration<Rep, Period> timeout, std::string_view query, Args&&... params) {
+            return Query(internal::DeadlineAfter(timeout), query, std::forward<Args>(params)...);
+        }
+
+        // DECLARE ... NO SCROLL CURSOR FOR query, read back with cursor::next(). Doesn't wait: the
+        // DECLARE and the first FETCH are pipelined, and a failed DECLARE shows up in next(). The
+        // transaction must be owned by a shared_transaction, which the cursor holds on to.
+        template<typename... Args>
+        cursor declare_cursor(std::string_view query, Args&&... params) {
+            return declare_cursor(cursor_options{}, query, std::forward<Args>(params)...);
+        }
+
+        template<typename... Args>
+        cursor declare_cursor(const cursor_options& options, std::string_view query, Args&&... params) {
+            shared_transaction self = shared_from_this();
+            std::string name;
+            {
+                std::unique_lock lock(m_mutex);
+                // Names only need to be unique within the transaction; reusing them across
+                // transactions lets the DECLARE stay in the statement cache.
+                name = "pgcpp_cursor_" + std::to_string(++m_cursors);
+            }
+            std::string declare = "DECLARE " + name + " NO SCROLL CURSOR FOR ";
+            declare += query;
+            auto declared = Execute(no_deadline, declare, std::forward<Args>(params)...);
+            return cursor{std::move(self), std::move(name), options, std::move(declared)};
         }
 
         void commit() noexcept;
@@ -58,11 +126,46 @@ namespace database {
         enum class state {
             active, commit, rollback
         };
+
+        template<typename... param>
+        query_future<std::expected<result::table, sql_error>> Execute(const query_deadline deadline, std::string_view query, param&&... params) {
+            pg_param_detail detail = internal::MakePgParams(query, std::forward<param>(params)...);
+            std::unique_lock lock(m_mutex);
+            if (m_state != state::active) {
+                return query_future<std::expected<result::table, sql_error>>::ready(std::unexpected(sql_error::TransactionRolledBack()));
+            }
+            return m_executor->SendToWorker(std::move(detail), deadline);
+        }
+
+        template<typename... Args>
+        void ExecuteAsync(const query_deadline deadline, std::string_view query, result_callback&& on_success, error_callback&& on_error, Args&&... params) {
+            pg_param_detail detail = internal::MakePgParams(query, std::forward<Args>(params)...);
+            std::unique_lock lock(m_mutex);
+            if (m_state != state::active) {
+                lock.unlock();
+                on_error(sql_error::TransactionRolledBack());
+                return;
+            }
+            m_executor->EnqueueAsync(
+                std::move(detail),
+                std::move(on_success),
+                std::move(on_error),
+                deadline);
+        }
+
+        template<typename... Args>
+        query_awaitable Query(const query_deadline deadline, std::string_view query, Args&&... params) {
+            pg_param_detail detail = internal::MakePgParams(query, std::forward<Args>(params)...);
+            std::unique_lock lock(m_mutex);
+            if (m_state != state::active) {
+                return query_awaitable{sql_error::TransactionRolledBack()};
+            }
+            return query_awaitable{*m_executor, std::move(detail), deadline};
+        }
     private:
         std::mutex m_mutex;
         query_executor* m_executor = nullptr;
         state m_state = state::active;
+        std::uint32_t m_cursors = 0;
     };
-
-    using shared_transaction = std::shared_ptr<transaction>;
 }
@@ -0,0 +1,321 @@
+//
+// Created by Shinnosuke Kawai on 4/23/26.
+//
+#include "database/result/arrow.h"
+#include <array>
+#include <limits>
+#include <memory>
+#include "database/result/column_data.h"
+
+namespace database::result {
+    arrow_type ArrowTypeFor(const Oid oid) noexcept {
+        switch (oid) {
+            case pg_oid::Bool:        return arrow_type::Bool;
+            case pg_oid::Int2:        return arrow_type::Int16;
+            case pg_oid::Int4:        return arrow_type::Int32;
+            case pg_oid::Int8:        return arrow_type::Int64;
+            case pg_oid::Float4:      return arrow_type::Float32;
+            case pg_oid::Float8:      return arrow_type::Float64;
+            case pg_oid::Timestamp:   return arrow_type::Timestamp;
+            case pg_oid::Timestamptz: return arrow_type::TimestampUtc;
+            case pg_oid::Text:
+            case pg_oid::Varchar:
+            case pg_oid::Bpchar:      return arrow_type::Utf8;
+            default:                  return arrow_type::Binary;
+        }
+    }
+}
+
+namespace database::result::pg_detail {
+    namespace {
+        const char* FormatOf(const arrow_type type) noexcept {
+            switch (type) {
+                case arrow_type::Bool:         return "b";
+                case arrow_type::Int16:        return "s";
+                case arrow_type::Int32:        return "i";
+                case arrow_type::Int64:        return "l";
+                case arrow_type::UInt16:       return "S";
+                case arrow_type::UInt32:       return "I";
+                case arrow_type::UInt64:       return "L";
+                case arrow_type::Float32:      return "f";
+                case arrow_type::Float64:      return "g";
+                case arrow_type::Timestamp:    return "tsu:";
+                case arrow_type::TimestampUtc: return "tsu:UTC";
+                case arrow_type::Utf8:         return "u";
+                case arrow_type::Binary:       return "z";
+            }
+            return "z";
+        }
+
+        bool IsVariable(const arrow_type type) noexcept {
+            return type == arrow_type::Utf8 || type == arrow_type::Binary;
+        }
+
+        // What the release callbacks free: the buffers an exported array points at, and for a
+        // batch the child structs themselves.
+        struct array_private {
+            std::vector<std::uint8_t> validity;
+            std::vector<std::byte> values;
+            std::vector<std::int32_t> offsets;
+            std::array<const void*, 3> buffers{};
+            std::vector<ArrowArray> child_arrays;
+            std::vector<ArrowArray*> children;
+        };
+
+        struct schema_private {
+            std::string name;
+            std::vector<ArrowSchema> child_schemas;
+            std::vector<ArrowSchema*> children;
+        };
+
+        void ReleaseArray(ArrowArray* array) {
+            auto* priv = static_cast<array_private*>(array->private_data);
+            // A consumer may have moved children out, leaving their release null.
+            for (ArrowArray* child : priv->children) {
+                if (child->release)
+                    child->release(child);
+            }
+            delete priv;
+            array->release = nullptr;
+        }
+
+        void ReleaseSchema(ArrowSchema* schema) {
+            auto* priv = static_cast<schema_private*>(schema->private_data);
+            for (ArrowSchema* child : priv->children) {
+                if (child->release)
+                    child->release(child);
+            }
+            delete priv;
+            schema->release = nullptr;
+        }
+
+        // Makes room for bit index of a bitmap being appended to; new bits start cleared.
+        template<typename Byte>
+        void GrowBits(std::vector<Byte>& bits, const std::int64_t index) {
+            if (index % 8 == 0)
+                bits.push_back(Byte{0});
+        }
+
+        template<typename Byte>
+        void SetBit(std::vector<Byte>& bits, const std::int64_t index) {
+            GrowBits(bits, index);
+            bits.back() |= static_cast<Byte>(1u << (index % 8));
+        }
+
+        // A column the result holds as fixed-width big-endian values: gather and swap them in
+        // bulk into the Arrow values buffer.
+        template<typename T>
+        bool FillFixed(arrow_column& column, const PGresult* res, const int c, const int rows) {
+            column.values.resize(static_cast<std::size_t>(rows) * sizeof(T));
+            column.validity.resize(BitmapBytes(static_cast<std::size_t>(rows)));
+            const std::span<T> out{reinterpret_cast<T*>(column.values.data()), static_cast<std::size_t>(rows)};
+            const std::ptrdiff_t nulls = ExtractFixed<T>(res, c, out, column.validity);
+            if (nulls < 0)
+                return false;
+            column.length = rows;
+            column.null_count = nulls;
+            return true;
+        }
+
+        bool FillCells(arrow_column& column, const PGresult* res, const int c, const int rows) {
+            if (IsVariable(column.type)) {
+                std::size_t total = 0;
+                for (int r = 0; r < rows; ++r)
+                    total += static_cast<std::size_t>(PQgetlength(res, r, c));
+                if (total > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+                    return false;
+                column.values.reserve(total);
+            }
+            for (int r = 0; r < rows; ++r) {
+                if (PQgetisnull(res, r, c)) {
+                    column.append_null();
+                    continue;
+                }
+                const auto* data = reinterpret_cast<const std::byte*>(PQgetvalue(res, r, c));
+                const auto len = static_cast<std::size_t>(PQgetlength(res, r, c));
+                if (column.type == arrow_type::Bool) {
+                    if (len != 1)
+                        return false;
+                    column.append_bool(data[0] != std::byte{0});
+                } else {
+                    column.append({data, len});
+                }
+            }
+            return true;
+        }
+    }
+
+    std::size_t ArrowWidth(const arrow_type type) noexcept {
+        switch (type) {
+            case arrow_type::Int16:
+            case arrow_type::UInt16:
+                return 2;
+            case arrow_type::Int32:
+            case arrow_type::UInt32:
+            case arrow_type::Float32:
+                return 4;
+            case arrow_type::Int64:
+            case arrow_type::UInt64:
+            case arrow_type::Float64:
+            case arrow_type::Timestamp:
+            case arrow_type::TimestampUtc:
+                return 8;
+            default:
+                return 0;
+        }
+    }
+
+    arrow_column::arrow_column(const arrow_type type, std::string name) : type(type), name(std::move(name)) {
+        if (IsVariable(type))
+            offsets.push_back(0);
+    }
+
+    void arrow_column::reserve(const std::size_t rows) {
+        validity.reserve(BitmapBytes(rows));
+        if (IsVariable(type))
+            offsets.reserve(rows + 1);
+        else if (type == arrow_type::Bool)
+            values.reserve(BitmapBytes(rows));
+        else
+            values.reserve(rows * ArrowWidth(type));
+    }
+
+    void arrow_column::append_null() {
+        GrowBits(validity, length);
+        if (IsVariable(type))
+            offsets.push_back(offsets.back());
+        else if (type == arrow_type::Bool)
+            GrowBits(values, length);
+        else
+            values.resize(values.size() + ArrowWidth(type));
+        ++null_count;
+        ++length;
+    }
+
+    void arrow_column::append(const std::span<const std::byte> bytes) {
+        SetBit(validity, length);
+        values.insert(values.end(), bytes.begin(), bytes.end());
+        if (IsVariable(type))
+            offsets.push_back(static_cast<std::int32_t>(values.size()));
+        ++length;
+    }
+
+    void arrow_column::append_bool(const bool value) {
+        SetBit(validity, length);
+        if (value)
+            SetBit(values, length);
+        else
+            GrowBits(values, length);
+        ++length;
+    }
+
+    void arrow_column::export_to(ArrowSchema* schema, ArrowArray* array) {
+        auto priv = std::make_unique<array_private>();
+        priv->validity = std::move(validity);
+        priv->values = std::move(values);
+        priv->offsets = std::move(offsets);
+        // Consumers may dereference a buffer of a zero-length array, so none is left null.
+        priv->values.reserve(1);
+        priv->buffers[0] = null_count > 0 ? priv->validity.data() : nullptr;
+        if (IsVariable(type)) {
+            priv->buffers[1] = priv->offsets.data();
+            priv->buffers[2] = priv->values.data();
+        } else {
+            priv->buffers[1] = priv->values.data();
+        }
+
+        *array = ArrowArray{};
+        array->length = length;
+        array->null_count = null_count;
+        array->n_buffers = IsVariable(type) ? 3 : 2;
+        array->buffers = priv->buffers.data();
+        array->release = &ReleaseArray;
+        array->private_data = priv.release();
+
+        auto schema_priv = std::make_unique<schema_private>();
+        schema_priv->name = name;
+        *schema = ArrowSchema{};
+        schema->format = FormatOf(type);
+        schema->name = schema_priv->name.c_str();
+        schema->flags = ARROW_FLAG_NULLABLE;
+        schema->release = &ReleaseSchema;
+        schema->private_data = schema_priv.release();
+
+        validity = {};
+        values = {};
+        offsets = {};
+        if (IsVariable(type))
+            offsets.push_back(0);
+        length = 0;
+        null_count = 0;
+    }
+
+    void ExportBatch(const std::span<arrow_column> columns, const std::int64_t length, ArrowSchema* schema, ArrowArray* array) {
+        auto priv = std::make_unique<array_private>();
+        auto schema_priv = std::make_unique<schema_private>();
+        priv->child_arrays.resize(columns.size());
+        schema_priv->child_schemas.resize(columns.size());
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            columns[i].export_to(&schema_priv->child_schemas[i], &priv->child_arrays[i]);
+            priv->children.push_back(&priv->child_arrays[i]);
+            schema_priv->children.push_back(&schema_priv->child_schemas[i]);
+        }
+
+        *array = ArrowArray{};
+        array->length = length;
+        array->n_buffers = 1; // a struct array only has a validity buffer, absent here
+        array->buffers = priv->buffers.data();
+        array->n_children = static_cast<std::int64_t>(columns.size());
+        array->children = priv->children.data();
+        array->release = &ReleaseArray;
+        array->private_data = priv.release();
+
+        *schema = ArrowSchema{};
+        schema->format = "+s";
+        schema->name = "";
+        schema->n_children = static_cast<std::int64_t>(columns.size());
+        schema->children = schema_priv->children.data();
+        schema->release = &ReleaseSchema;
+        schema->private_data = schema_priv.release();
+    }
+
+    std::expected<void, sql_error> ExportResult(const PGresult* res, const std::span<const column_info> columns,
+                                                ArrowSchema* schema, ArrowArray* array) {
+        const int rows = PQntuples(res);
+        std::vector<arrow_column> out;
+        out.reserve(columns.size());
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            arrow_column& column = out.emplace_back(ArrowTypeFor(columns[c].oid), std::string{columns[c].name});
+            const int index = static_cast<int>(c);
+            bool filled;
+            switch (column.type) {
+                case arrow_type::Int16:   filled = FillFixed<int16_t>(column, res, index, rows); break;
+                case arrow_type::Int32:   filled = FillFixed<int32_t>(column, res, index, rows); break;
+                case arrow_type::Int64:   filled = FillFixed<int64_t>(column, res, index, rows); break;
+                case arrow_type::Float32: filled = FillFixed<float>(column, res, index, rows); break;
+                case arrow_type::Float64: filled = FillFixed<double>(column, res, index, rows); break;
+                case arrow_type::Timestamp:
+                case arrow_type::TimestampUtc:
+                    filled = FillFixed<int64_t>(column, res, index, rows);
+                    if (filled) {
+                        // PostgreSQL counts from 2000-01-01, Arrow from 1970-01-01. NULL slots stay
+                        // zero; infinities stay INT64_MAX/MIN.
+                        auto* us = reinterpret_cast<int64_t*>(column.values.data());
+                        for (int r = 0; r < rows; ++r) {
+                            if (column.validity[static_cast<std::size_t>(r) / 8] & (1u << (r % 8)))
+                                us[r] = internal::UnixMicrosFromPg(us[r]);
+                        }
+                    }
+                    break;
+                default:
+                    column.reserve(static_cast<std::size_t>(rows));
+                    filled = FillCells(column, res, index, rows);
+                    break;
+            }
+            if (!filled)
+                return std::unexpected(sql_error::ResultMismatch("column can't be exported to Arrow"));
+        }
+        ExportBatch(out, rows, schema, array);
+        return {};
+    }
+}
@@ -0,0 +1,115 @@
+//
+// Created by Shinnosuke Kawai on 4/22/26.
+//
+#include "database/result/byte_swap.h"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DATABASE_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace database::result::pg_detail {
+    namespace {
+        template<typename U>
+        void SwapScalar(std::byte* data, const std::size_t count) noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                U value;
+                std::memcpy(&value, data + i * sizeof(U), sizeof(U));
+                value = std::byteswap(value);
+                std::memcpy(data + i * sizeof(U), &value, sizeof(U));
+            }
+        }
+
+#ifdef DATABASE_X86_DISPATCH
+        // pshufb masks reversing each 2/4/8-byte lane of a 16-byte block.
+        alignas(16) constexpr std::uint8_t kShuffle16[16] = {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+        alignas(16) constexpr std::uint8_t kShuffle32[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+        alignas(16) constexpr std::uint8_t kShuffle64[16] = {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+        template<typename U>
+        const std::uint8_t* ShuffleMask() noexcept {
+            if constexpr (sizeof(U) == 2)
+                return kShuffle16;
+            else if constexpr (sizeof(U) == 4)
+                return kShuffle32;
+            else
+                return kShuffle64;
+        }
+
+        template<typename U>
+        __attribute__((target("ssse3")))
+        void SwapSsse3(std::byte* data, const std::size_t count) noexcept {
+            const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(ShuffleMask<U>()));
+            const std::size_t bytes = count * sizeof(U);
+            std::size_t i = 0;
+            for (; i + 16 <= bytes; i += 16) {
+                auto* p = reinterpret_cast<__m128i*>(data + i);
+                _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+            }
+            SwapScalar<U>(data + i, (bytes - i) / sizeof(U));
+        }
+
+        template<typename U>
+        __attribute__((target("avx2")))
+        void SwapAvx2(std::byte* data, const std::size_t count) noexcept {
+            // vpshufb works per 128-bit lane, so the same 16-byte mask serves both halves.
+            const __m256i mask = _mm256_broadcastsi128_si256(
+                _mm_load_si128(reinterpret_cast<const __m128i*>(ShuffleMask<U>())));
+            const std::size_t bytes = count * sizeof(U);
+            std::size_t i = 0;
+            for (; i + 64 <= bytes; i += 64) {
+                auto* p = reinterpret_cast<__m256i*>(data + i);
+                const __m256i a = _mm256_loadu_si256(p);
+                const __m256i b = _mm256_loadu_si256(p + 1);
+                _mm256_storeu_si256(p, _mm256_shuffle_epi8(a, mask));
+                _mm256_storeu_si256(p + 1, _mm256_shuffle_epi8(b, mask));
+            }
+            for (; i + 32 <= bytes; i += 32) {
+                auto* p = reinterpret_cast<__m256i*>(data + i);
+                _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+            }
+            SwapScalar<U>(data + i, (bytes - i) / sizeof(U));
+        }
+
+        enum class simd_level { Scalar, Ssse3, Avx2 };
+
+        simd_level DetectSimd() noexcept {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return simd_level::Avx2;
+            if (__builtin_cpu_supports("ssse3"))
+                return simd_level::Ssse3;
+            return simd_level::Scalar;
+        }
+
+        template<typename U>
+        void Swap(std::byte* data, const std::size_t count) noexcept {
+            static const simd_level level = DetectSimd();
+            switch (level) {
+                case simd_level::Avx2:
+                    SwapAvx2<U>(data, count);
+                    break;
+                case simd_level::Ssse3:
+                    SwapSsse3<U>(data, count);
+                    break;
+                default:
+                    SwapScalar<U>(data, count);
+                    break;
+            }
+        }
+#else
+        // Other targets get the scalar loop; compilers turn it into NEON rev/tbl on their own.
+        template<typename U>
+        void Swap(std::byte* data, const std::size_t count) noexcept {
+            SwapScalar<U>(data, count);
+        }
+#endif
+    }
+
+    void SwapBytes16(std::byte* data, const std::size_t count) noexcept { Swap<std::uint16_t>(data, count); }
+    void SwapBytes32(std::byte* data, const std::size_t count) noexcept { Swap<std::uint32_t>(data, count); }
+    void SwapBytes64(std::byte* data, const std::size_t count) noexcept { Swap<std::uint64_t>(data, count); }
+}
@@ -0,0 +1,87 @@
+//
+// Created by Shinnosuke Kawai on 4/9/26.
+//
+#include "database/internal/callback_pool.h"
+
+namespace database::internal {
+    namespace {
+        // The pool whose thread this is. Per pool, so a callback of one pool posting to another
+        // still goes through that pool's queue.
+        thread_local const callback_pool* tl_callback_pool = nullptr;
+    }
+
+    callback_pool::~callback_pool() {
+        stop();
+    }
+
+    void callback_pool::start(const std::size_t num_threads) {
+        m_workers.reserve(num_threads);
+        for (std::size_t i = 0; i < num_threads; ++i)
+            m_workers.emplace_back([this](const std::stop_token& st) { Worker(st); });
+    }
+
+    void callback_pool::post(std::function<void()> task) noexcept {
+        if (on_worker_thread()) {
+            task();
+            return;
+        }
+        if (m_idle_workers.load(std::memory_order_acquire) == 0) {
+            auto done = std::make_shared<std::atomic_bool>(false);
+            std::jthread temp([this, done, task = std::move(task)]() mutable noexcept {
+                tl_callback_pool = this;
+                task();
+                done->store(true, std::memory_order_release);
+            });
+
+            {
+                std::lock_guard lk(m_temp_mutex);
+                reap_overflow_threads(m_overflow_threads);
+                m_overflow_threads.push_back({
+                    .done = done,
+                    .thread = std::move(temp)
+                });
+            }
+            return;
+        }
+        {
+            std::lock_guard lk(m_mutex);
+            m_queue.push_back(std::move(task));
+        }
+        m_cv.notify_one();
+    }
+
+    void callback_pool::stop() noexcept {
+        {
+            std::lock_guard lk(m_temp_mutex);
+            reap_overflow_threads(m_overflow_threads);
+            m_overflow_threads.clear();
+        }
+        for (auto& w : m_workers)
+            w.request_stop();
+        m_cv.notify_all();
+        for (auto& w : m_workers)
+            if (w.joinable()) w.join();
+        m_workers.clear();
+    }
+
+    bool callback_pool::on_worker_thread() const noexcept {
+        return tl_callback_pool == this;
+    }
+
+    void callback_pool::Worker(const std::stop_token& st) noexcept {
+        tl_callback_pool = this;
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lk(m_mutex);
+                m_idle_workers.fetch_add(1, std::memory_order_release);
+                m_cv.wait(lk, [&] { return st.stop_requested() || !m_queue.empty(); });
+                m_idle_workers.fetch_sub(1, std::memory_order_release);
+                if (m_queue.empty())
+                    break; // stop requested and queue fully drained
+                task = m_queue.pop_front();
+            }
+            task();
+        }
+    }
+}
@@ -0,0 +1,123 @@
+//
+// Created by Shinnosuke Kawai on 4/25/26.
+//
+#include "database/cursor.h"
+#include <algorithm>
+#include <bit>
+#include "database/transaction.h"
+
+namespace database {
+    namespace {
+        // Powers of two within the configured bounds. FETCH takes no parameters, so each row
+        // count is its own statement text; this keeps them to a handful in the statement cache.
+        std::size_t FetchRows(const cursor_options& options, const std::size_t wanted) noexcept {
+            const std::size_t lo = std::bit_ceil(std::max<std::size_t>(options.min_rows, 1));
+            const std::size_t hi = std::max(std::bit_floor(std::max<std::size_t>(options.max_rows, 1)), lo);
+            return std::clamp(std::bit_floor(std::max<std::size_t>(wanted, 1)), lo, hi);
+        }
+    }
+
+    cursor::cursor(std::shared_ptr<transaction> txn, std::string name, const cursor_options& options,
+                   query_future<std::expected<result::table, sql_error>> declared)
+    : m_txn(std::move(txn)),
+      m_name(std::move(name)),
+      m_options(options),
+      m_declared(std::move(declared)),
+      m_fetch_rows(FetchRows(options, options.initial_rows)) {
+        // Pipelined behind the DECLARE: the first batch is on its way before anyone asks.
+        Fetch();
+    }
+
+    cursor::cursor(cursor&& other) noexcept
+    : m_txn(std::move(other.m_txn)),
+      m_name(std::move(other.m_name)),
+      m_options(other.m_options),
+      m_declared(std::move(other.m_declared)),
+      m_pending(std::move(other.m_pending)),
+      m_pending_rows(other.m_pending_rows),
+      m_fetch_rows(other.m_fetch_rows),
+      m_row_bytes(other.m_row_bytes),
+      m_declare_ok(other.m_declare_ok),
+      m_done(other.m_done),
+      m_closed(other.m_closed) {
+        other.m_closed = true;
+    }
+
+    cursor::~cursor() {
+        if (m_closed || m_txn == nullptr)
+            return;
+        // Whether the DECLARE worked isn't known without waiting; if it didn't, the transaction is
+        // aborted and the CLOSE just fails along with it. Queued behind any FETCH still in flight.
+        try {
+            static_cast<void>(m_txn->execute("CLOSE " + m_name));
+        } catch (...) {
+            // Left open until the transaction ends.
+        }
+    }
+
+    std::expected<std::optional<result::table>, sql_error> cursor::next() {
+        if (m_done)
+            return std::nullopt;
+        if (m_declared.valid()) {
+            auto declared = m_declared.get();
+            if (!declared) {
+                m_done = true;
+                return std::unexpected(std::move(declared.error()));
+            }
+            m_declare_ok = true;
+        }
+
+        auto batch = m_pending.get();
+        if (!batch) {
+            m_done = true;
+            return std::unexpected(std::move(batch.error()));
+        }
+        const std::size_t rows = batch->size();
+        if (rows < m_pending_rows) {
+            // A short batch is the last one; nothing more to prefetch.
+            m_done = true;
+        } else {
+            Adapt(*batch);
+            Fetch();
+        }
+        if (rows == 0)
+            return std::nullopt;
+        return std::optional<result::table>{std::move(*batch)};
+    }
+
+    std::expected<void, sql_error> cursor::close() {
+        if (m_closed || m_txn == nullptr)
+            return {};
+        m_closed = true;
+        m_done = true;
+        // A cursor whose DECLARE failed doesn't exist; closing it would only fail again.
+        if (m_declared.valid()) {
+            auto declared = m_declared.get();
+            if (!declared)
+                return std::unexpected(std::move(declared.error()));
+            m_declare_ok = true;
+        }
+        if (!m_declare_ok)
+            return {};
+        // Queued behind any FETCH still in flight, so it also waits for that.
+        auto closed = m_txn->execute("CLOSE " + m_name).get();
+        if (!closed)
+            return std::unexpected(std::move(closed.error()));
+        return {};
+    }
+
+    void cursor::Fetch() {
+        m_pending_rows = m_fetch_rows;
+        m_pending = m_txn->execute("FETCH FORWARD " + std::to_string(m_fetch_rows) + " FROM " + m_name);
+    }
+
+    void cursor::Adapt(const result::table& batch) noexcept {
+        const std::size_t rows = batch.size();
+        if (rows == 0 || m_options.batch_bytes == 0)
+            return;
+        const double width = static_cast<double>(batch.memory_size()) / static_cast<double>(rows);
+        // Smoothed, so one batch of unusually wide rows doesn't swing the size by itself.
+        m_row_bytes = m_row_bytes == 0 ? width : (m_row_bytes + width) / 2;
+        m_fetch_rows = FetchRows(m_options, static_cast<std::size_t>(static_cast<double>(m_options.batch_bytes) / m_row_bytes));
+    }
+}
@@ -0,0 +1,293 @@
+//
+// Created by Shinnosuke Kawai on 4/9/26.
+//
+#include "database/event_loop.h"
+#include <algorithm>
+#ifdef _WIN32
+#include <winsock2.h>
+#define poll WSAPoll
+#else
+#include <sys/poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace database {
+    namespace {
+#ifdef __linux__
+        std::uint32_t ToEpoll(const short events) noexcept {
+            std::uint32_t out = 0;
+            if (events & POLLIN)
+                out |= EPOLLIN;
+            if (events & POLLOUT)
+                out |= EPOLLOUT;
+            return out;
+        }
+
+        short FromEpoll(const std::uint32_t events) noexcept {
+            short out = 0;
+            if (events & EPOLLIN)
+                out |= POLLIN;
+            if (events & EPOLLOUT)
+                out |= POLLOUT;
+            if (events & EPOLLERR)
+                out |= POLLERR;
+            if (events & EPOLLHUP)
+                out |= POLLHUP;
+            return out;
+        }
+#endif
+#ifdef _WIN32
+        // WSAPoll can't be woken by another thread, so posted tasks wait at most this long.
+        constexpr int kMaxWaitMs = 10;
+#endif
+    }
+
+    event_loop::event_loop(const EventLoopConfig& config) {
+        const std::size_t n = std::max<std::size_t>(config.num_threads, 1);
+        m_reactors.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            m_reactors.emplace_back(std::make_unique<reactor>());
+        m_callbacks->start(config.num_cb_threads);
+    }
+
+    event_loop::~event_loop() {
+        // The last reference may go on one of the loop's own threads, e.g. with the last client
+        // released in a callback. That thread can't join itself, so a helper thread tears the
+        // loop down once the current task has returned.
+        const bool own_thread = m_callbacks->on_worker_thread() ||
+                                std::ranges::any_of(m_reactors, [](const auto& r) { return r->in_loop_thread(); });
+        if (own_thread) {
+            std::thread([reactors = std::move(m_reactors), callbacks = std::move(m_callbacks)]() mutable {
+                reactors.clear();
+                callbacks->stop();
+            }).detach();
+            return;
+        }
+        // Reactors first: a task still queued there may post a callback.
+        m_reactors.clear();
+        m_callbacks->stop();
+    }
+
+    event_loop::reactor& event_loop::assign() noexcept {
+        return *m_reactors[m_next.fetch_add(1, std::memory_order_relaxed) % m_reactors.size()];
+    }
+
+    void event_loop::post_callback(std::function<void()> task) noexcept {
+        m_callbacks->post(std::move(task));
+    }
+
+    event_loop::reactor::reactor() {
+#ifdef __linux__
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = m_wake_fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &ev);
+#elif !defined(_WIN32)
+        if (pipe(m_wake_pipe) == 0) {
+            for (const int fd : m_wake_pipe) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+        }
+#endif
+        m_thread = std::jthread([this](const std::stop_token& st) { Run(st); });
+    }
+
+    event_loop::reactor::~reactor() {
+        m_thread.request_stop();
+        Wake();
+        if (m_thread.joinable())
+            m_thread.join();
+#ifdef __linux__
+        close(m_wake_fd);
+        close(m_epoll_fd);
+#elif !defined(_WIN32)
+        close(m_wake_pipe[0]);
+        close(m_wake_pipe[1]);
+#endif
+    }
+
+    void event_loop::reactor::post(task fn) {
+        {
+            std::lock_guard lk(m_post_mutex);
+            m_posted.push_back(std::move(fn));
+        }
+        if (!m_wake_pending.exchange(true, std::memory_order_acq_rel))
+            Wake();
+    }
+
+    bool event_loop::reactor::in_loop_thread() const noexcept {
+        return m_loop_thread.load(std::memory_order_acquire) == std::this_thread::get_id();
+    }
+
+    void event_loop::reactor::watch(const int fd, const short events, io_handler handler) {
+        auto w = std::make_shared<watcher>(events, std::move(handler));
+#ifdef __linux__
+        epoll_event ev{};
+        ev.events = ToEpoll(events);
+        ev.data.fd = fd;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+#endif
+        m_watchers[fd] = std::move(w);
+    }
+
+    void event_loop::reactor::modify(const int fd, const short events) noexcept {
+        const auto it = m_watchers.find(fd);
+        if (it == m_watchers.end() || it->second->events == events)
+            return;
+        it->second->events = events;
+#ifdef __linux__
+        epoll_event ev{};
+        ev.events = ToEpoll(events);
+        ev.data.fd = fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+#endif
+    }
+
+    void event_loop::reactor::unwatch(const int fd) noexcept {
+        if (m_watchers.erase(fd) == 0)
+            return;
+#ifdef __linux__
+        // Fails harmlessly when libpq already closed the socket.
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+    }
+
+    event_loop::reactor::timer_id event_loop::reactor::run_at(const time_point when, task fn) {
+        const timer_id id = ++m_last_timer;
+        m_timer_index.emplace(id, m_timers.emplace(when, std::pair{id, std::move(fn)}));
+        return id;
+    }
+
+    void event_loop::reactor::cancel(const timer_id id) noexcept {
+        const auto it = m_timer_index.find(id);
+        if (it == m_timer_index.end())
+            return;
+        m_timers.erase(it->second);
+        m_timer_index.erase(it);
+    }
+
+    void event_loop::reactor::Run(const std::stop_token& st) noexcept {
+        m_loop_thread.store(std::this_thread::get_id(), std::memory_order_release);
+        while (!st.stop_requested()) {
+            RunPosted();
+            RunDueTimers();
+            int timeout = NextTimeoutMs();
+            {
+                std::lock_guard lk(m_post_mutex);
+                if (!m_posted.empty())
+                    timeout = 0;
+            }
+            WaitForEvents(timeout);
+        }
+    }
+
+    void event_loop::reactor::Wake() noexcept {
+#ifdef __linux__
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const auto n = write(m_wake_fd, &one, sizeof(one));
+#elif !defined(_WIN32)
+        const char byte = 0;
+        [[maybe_unused]] const auto n = write(m_wake_pipe[1], &byte, 1);
+#endif
+    }
+
+    void event_loop::reactor::RunPosted() noexcept {
+        m_wake_pending.store(false, std::memory_order_release);
+        // The two vectors trade places each round, so both keep their capacity.
+        {
+            std::lock_guard lk(m_post_mutex);
+            m_running.swap(m_posted);
+        }
+        for (auto& fn : m_running)
+            fn();
+        m_running.clear();
+    }
+
+    void event_loop::reactor::RunDueTimers() noexcept {
+        const auto now = std::chrono::steady_clock::now();
+        while (!m_timers.empty() && m_timers.begin()->first <= now) {
+            task fn = std::move(m_timers.begin()->second.second);
+            m_timer_index.erase(m_timers.begin()->second.first);
+            m_timers.erase(m_timers.begin());
+            fn();
+        }
+    }
+
+    int event_loop::reactor::NextTimeoutMs() const noexcept {
+        if (m_timers.empty()) {
+#ifdef _WIN32
+            return kMaxWaitMs;
+#else
+            return -1;
+#endif
+        }
+        const auto wait = m_timers.begin()->first - std::chrono::steady_clock::now();
+        // Round up so a timer is never woken for just before it is due.
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+        ms = std::clamp<decltype(ms)>(ms, 0, 60'000);
+#ifdef _WIN32
+        ms = std::min<decltype(ms)>(ms, kMaxWaitMs);
+#endif
+        return static_cast<int>(ms);
+    }
+
+    void event_loop::reactor::Dispatch(const int fd, const short revents) noexcept {
+        const auto it = m_watchers.find(fd);
+        if (it == m_watchers.end())
+            return; // unwatched by an earlier handler of this round
+        // Keeps the handler alive even if it unwatches itself.
+        const std::shared_ptr<watcher> w = it->second;
+        w->handler(revents);
+    }
+
+    void event_loop::reactor::WaitForEvents(const int timeout_ms) noexcept {
+#ifdef __linux__
+        epoll_event events[64];
+        const int n = epoll_wait(m_epoll_fd, events, 64, timeout_ms);
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == m_wake_fd) {
+                std::uint64_t drained;
+                [[maybe_unused]] const auto r = read(m_wake_fd, &drained, sizeof(drained));
+                continue;
+            }
+            Dispatch(fd, FromEpoll(events[i].events));
+        }
+#else
+        std::vector<pollfd> fds;
+        fds.reserve(m_watchers.size() + 1);
+#ifndef _WIN32
+        fds.push_back({m_wake_pipe[0], POLLIN, 0});
+#endif
+        for (const auto& [fd, w] : m_watchers)
+            fds.push_back({static_cast<decltype(pollfd::fd)>(fd), w->events, 0});
+        if (fds.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+            return;
+        }
+        if (poll(fds.data(), static_cast<decltype(fds.size())>(fds.size()), timeout_ms) <= 0)
+            return;
+        for (const pollfd& p : fds) {
+            if (p.revents == 0)
+                continue;
+#ifndef _WIN32
+            if (p.fd == m_wake_pipe[0]) {
+                char drained[64];
+                while (read(m_wake_pipe[0], drained, sizeof(drained)) > 0) {}
+                continue;
+            }
+#endif
+            Dispatch(static_cast<int>(p.fd), p.revents);
+        }
+#endif
+    }
+}
@@ -0,0 +1,73 @@
+//
+// Created by Shinnosuke Kawai on 4/16/26.
+//
+#include "database/internal/parker.h"
+#include <algorithm>
+#ifdef __linux__
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace database::internal {
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+#ifdef __linux__
+    void parker::Wait(const time_point deadline) noexcept {
+        timespec timeout{};
+        const timespec* timeout_ptr = nullptr;
+        if (deadline != time_point::max()) {
+            const auto left = deadline - std::chrono::steady_clock::now();
+            if (left <= time_point::duration::zero())
+                return;
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+            timeout.tv_sec = static_cast<time_t>(ns / 1'000'000'000);
+            timeout.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+            timeout_ptr = &timeout;
+        }
+        // Returns at once if unpark() already flipped the state.
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_state), FUTEX_WAIT_PRIVATE, parked, timeout_ptr, nullptr, 0);
+    }
+
+    void parker::Wake() noexcept {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+#elif defined(_WIN32)
+    void parker::Wait(const time_point deadline) noexcept {
+        DWORD timeout_ms = INFINITE;
+        if (deadline != time_point::max()) {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0)
+                return;
+            timeout_ms = static_cast<DWORD>(std::min<long long>(left.count(), INFINITE - 1));
+        }
+        std::uint32_t expected = parked;
+        WaitOnAddress(&m_state, &expected, sizeof(expected), timeout_ms);
+    }
+
+    void parker::Wake() noexcept {
+        WakeByAddressSingle(&m_state);
+    }
+#else
+    void parker::Wait(const time_point deadline) noexcept {
+        std::unique_lock lock(m_mutex);
+        const auto woken = [this] { return m_state.load(std::memory_order_acquire) != parked; };
+        if (deadline == time_point::max())
+            m_cv.wait(lock, woken);
+        else
+            m_cv.wait_until(lock, deadline, woken);
+    }
+
+    void parker::Wake() noexcept {
+        // Taking the lock orders the state change before the waiter's predicate check.
+        { std::lock_guard lock(m_mutex); }
+        m_cv.notify_one();
+    }
+#endif
+}
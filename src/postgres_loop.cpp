@@ -0,0 +1,748 @@
+//
+// Created by Shinnosuke Kawai on 4/9/26.
+//
+// Event-loop mode of postgres_client: the same requests the worker thread runs in
+// postgres_priv.cpp, driven by socket readiness on a shared reactor instead of blocking
+// polls. Requests are written into one long-lived pipeline as soon as they are queued and
+// their results are matched back in order, so nothing ever waits on a single connection.
+//
+#include "database/postgres_client.h"
+
+namespace database {
+    namespace {
+        constexpr auto kReconnectTimeout = std::chrono::milliseconds(5000);
+        // How long a cancelled query may keep the server quiet before the connection is dropped.
+        constexpr auto kCancelTimeout = std::chrono::milliseconds(5000);
+    }
+
+    struct postgres_client::loop_state {
+        // Where a sent request is in its result sequence; mirrors ConsumePipelineResult.
+        enum class stage { deallocate, deallocate_sync, prepare, command, sync, copy_start, copy_out, copy_in };
+
+        struct pending_request {
+            query_request request;
+            statement_plan plan{};
+            stage at = stage::command;
+            command_outcome outcome{};
+            bool streaming = false;
+            // COPY FROM: chunk handed to libpq but not yet accepted, and the writer's verdict.
+            std::string chunk;
+            bool chunk_pending = false;
+            bool input_done = false;
+            const char* abort_msg = nullptr;
+            // COPY TO: first sink failure; the stream is drained regardless.
+            std::optional<sql_error> sink_error = std::nullopt;
+            // Its deadline passed while it was at the front and the server was asked to cancel it.
+            bool cancel_sent = false;
+            std::uint64_t id = 0;
+        };
+
+        loop_state(event_loop::reactor& reactor, const postgres_client& client) noexcept
+        : reactor(reactor), client(&client) {}
+
+        event_loop::reactor& reactor;
+        // Cleared by DetachFromLoop(); tasks still queued on the reactor check it first.
+        const postgres_client* client;
+        std::atomic_bool wake_pending = false;
+        // Sent requests, oldest first. Only the front one is receiving results.
+        internal::ring_buffer<pending_request> inflight;
+        // Requests that failed to send, so never reached the server; re-sent ahead of new ones.
+        std::deque<query_request> retry;
+        int fd = -1;
+        short events = 0;
+        bool reconnecting = false;
+        bool write_blocked = false;
+        event_loop::reactor::timer_id reconnect_timer = 0;
+        event_loop::reactor::timer_id heartbeat_timer = 0;
+        // Fires at the front request's deadline; deadline_due is what it is set for.
+        event_loop::reactor::timer_id deadline_timer = 0;
+        query_deadline deadline_due = no_deadline;
+        // Drops the connection if a cancelled request stays unanswered.
+        event_loop::reactor::timer_id cancel_timer = 0;
+        // Wakes a COPY FROM whose writer has gone quiet, see copy_in_channel::idle_deadline().
+        event_loop::reactor::timer_id copy_idle_timer = 0;
+        // Socket of the cancel connection while it is being watched.
+        int cancel_fd = -1;
+        // From LoopCancelFront() until the cancel has reached the server or was given up on.
+        // Nothing is sent meanwhile, so a late cancel can't stop the next request.
+        bool cancel_pending = false;
+        // Bumped by LoopStopCancel(); a cancel sent from the callback pool reports back with it.
+        std::uint64_t cancel_generation = 0;
+        std::uint64_t next_id = 0;
+    };
+
+    void postgres_client::AttachToLoop() {
+        m_loop = std::make_shared<loop_state>(m_config.loop->assign(), *this);
+        m_loop->reactor.post([state = m_loop] {
+            if (!state->client)
+                return;
+            state->client->LoopScheduleHeartbeat();
+            state->client->LoopPump();
+        });
+    }
+
+    void postgres_client::DetachFromLoop() const noexcept {
+        const auto detach = [this] {
+            loop_state& loop = *m_loop;
+            loop.client = nullptr;
+            loop.reactor.cancel(loop.reconnect_timer);
+            loop.reactor.cancel(loop.heartbeat_timer);
+            loop.reactor.cancel(loop.deadline_timer);
+            loop.reactor.cancel(loop.cancel_timer);
+            loop.reactor.cancel(loop.copy_idle_timer);
+            LoopStopCancel();
+            // LoopWake() posts hold a raw pointer; this runs after any still queued and keeps the
+            // state alive until then.
+            loop.reactor.post([keep_alive = m_loop] {});
+            if (loop.fd >= 0)
+                loop.reactor.unwatch(loop.fd);
+            loop.fd = -1;
+
+            std::deque<query_request> pending;
+            while (!loop.inflight.empty())
+                pending.emplace_back(loop.inflight.pop_front().request);
+            std::ranges::move(loop.retry, std::back_inserter(pending));
+            loop.retry.clear();
+            while (m_requests.front() != nullptr)
+                pending.emplace_back(m_requests.pop_front());
+            for (auto& item : pending) {
+                if (item.copy_in)
+                    item.copy_in->set_notify(nullptr);
+                CompleteRequest(item, std::unexpected(sql_error::ShuttingDown("worker thread stopped")));
+            }
+        };
+        if (m_loop->reactor.in_loop_thread()) {
+            detach();
+            return;
+        }
+        std::promise<void> done;
+        m_loop->reactor.post([&] {
+            detach();
+            done.set_value();
+        });
+        done.get_future().wait();
+    }
+
+    void postgres_client::LoopWake() const noexcept {
+        // One queued pump picks up everything enqueued before it runs.
+        if (m_loop->wake_pending.exchange(true, std::memory_order_acq_rel))
+            return;
+        // A raw pointer keeps the closure inside std::function's inline buffer: no allocation per
+        // wake. DetachFromLoop() keeps the state alive until this has run.
+        m_loop->reactor.post([state = m_loop.get()] {
+            state->wake_pending.store(false, std::memory_order_release);
+            if (state->client)
+                state->client->LoopPump();
+        });
+    }
+
+    void postgres_client::LoopOnReady(const short revents) const noexcept {
+        if (m_loop->reconnecting) {
+            LoopContinueReconnect();
+            return;
+        }
+        PGconn* conn = m_connection.get();
+        if ((revents & POLLNVAL) != 0) {
+            LoopConnectionLost(sql_error::SocketFailed("Socket failed"));
+            return;
+        }
+        if ((revents & (POLLIN | POLLERR | POLLHUP)) != 0 && PQconsumeInput(conn) == 0) {
+            LoopConnectionLost(sql_error::BadConnection(PQerrorMessage(conn)));
+            return;
+        }
+        LoopPump();
+    }
+
+    void postgres_client::LoopPump() const noexcept {
+        loop_state& loop = *m_loop;
+        if (loop.reconnecting)
+            return;
+        if (!is_connected()) {
+            if (!loop.inflight.empty()) {
+                LoopConnectionLost(sql_error::BadConnection(PQerrorMessage(m_connection.get())));
+                return;
+            }
+            if (!loop.retry.empty() || !m_requests.empty())
+                LoopStartReconnect();
+            return;
+        }
+
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            if (!LoopSend(progress) || !LoopReadResults(progress) || !LoopWriteCopyIn(progress))
+                return; // the connection dropped and is being re-established
+        }
+        const int flushed = PQflush(m_connection.get());
+        if (flushed < 0) {
+            LoopConnectionLost(sql_error::SocketFailed("failed to flush socket"));
+            return;
+        }
+        // Always watch for input: it also reports a server that went away while idle.
+        LoopWatch(flushed == 1 || loop.write_blocked ? POLLIN | POLLOUT : POLLIN);
+        LoopArmDeadline();
+    }
+
+    bool postgres_client::LoopSend(bool& progress) const noexcept {
+        loop_state& loop = *m_loop;
+        PGconn* conn = m_connection.get();
+        const std::size_t depth = std::max<std::size_t>(m_config.pipeline_depth, 1);
+        while (loop.inflight.size() < depth) {
+            if (loop.cancel_pending)
+                return true;
+            if (!loop.inflight.empty() && loop.inflight.back().request.exclusive())
+                return true;
+            const query_request* next = !loop.retry.empty() ? &loop.retry.front() : m_requests.front();
+            if (next == nullptr || (next->exclusive() && !loop.inflight.empty()))
+                return true;
+
+            query_request request;
+            if (!loop.retry.empty()) {
+                request = std::move(loop.retry.front());
+                loop.retry.pop_front();
+            } else {
+                request = m_requests.pop_front();
+            }
+            progress = true;
+            if (FailIfExpired(request))
+                continue;
+
+            if (request.is_copy()) {
+                if (PQpipelineStatus(conn) != PQ_PIPELINE_OFF && PQexitPipelineMode(conn) == 0) {
+                    CompleteRequest(request, std::unexpected(sql_error::BadConnection(PQerrorMessage(conn))));
+                    LoopConnectionLost(sql_error::BadConnection("failed to leave pipeline mode"));
+                    return false;
+                }
+                if (PQsendQuery(conn, request.detail.query_c_str()) == 0) {
+                    CompleteRequest(request, std::unexpected(sql_error::BadConnection(PQerrorMessage(conn))));
+                    LoopConnectionLost(sql_error::BadConnection("failed to send COPY"));
+                    return false;
+                }
+                if (request.copy_in) {
+                    request.copy_in->set_notify([state = m_loop] {
+                        state->reactor.post([state] {
+                            if (state->client)
+                                state->client->LoopPump();
+                        });
+                    });
+                }
+                loop.inflight.push_back({.request = std::move(request), .at = loop_state::stage::copy_start});
+                return true;
+            }
+
+            if (PQpipelineStatus(conn) == PQ_PIPELINE_OFF && PQenterPipelineMode(conn) == 0) {
+                loop.retry.push_front(std::move(request));
+                LoopConnectionLost(sql_error::BadConnection(PQerrorMessage(conn)));
+                return false;
+            }
+            std::expected<statement_plan, sql_error> plan = SendPipelined(request.detail);
+            if (!plan) {
+                loop.retry.push_front(std::move(request));
+                LoopConnectionLost(plan.error());
+                return false;
+            }
+            const auto first = plan->deallocate ? loop_state::stage::deallocate
+                             : plan->prepare    ? loop_state::stage::prepare
+                                                : loop_state::stage::command;
+            loop.inflight.push_back({.request = std::move(request), .plan = *plan, .at = first, .id = ++loop.next_id});
+        }
+        return true;
+    }
+
+    bool postgres_client::LoopReadResults(bool& progress) const noexcept {
+        using stage = loop_state::stage;
+        loop_state& loop = *m_loop;
+        PGconn* conn = m_connection.get();
+
+        const auto finish_front = [&](std::expected<result::unique_pg_result, sql_error>&& result) {
+            loop_state::pending_request done = loop.inflight.pop_front();
+            if (done.request.copy_in) {
+                done.request.copy_in->set_notify(nullptr);
+                loop.reactor.cancel(loop.copy_idle_timer);
+                loop.copy_idle_timer = 0;
+            }
+            if (done.cancel_sent && !loop.cancel_pending) {
+                loop.reactor.cancel(loop.cancel_timer);
+                loop.cancel_timer = 0;
+            }
+            CompleteRequest(done.request, std::move(result));
+        };
+
+        while (!loop.inflight.empty()) {
+            loop_state::pending_request& front = loop.inflight.front();
+            if (front.at == stage::copy_in)
+                return true; // LoopWriteCopyIn's turn
+            if (front.at == stage::copy_out) {
+                if (!LoopReadCopyOut(progress))
+                    return false;
+                if (front.at == stage::copy_out)
+                    return true;
+                continue;
+            }
+
+            row_stream* on_rows = front.request.on_rows ? &front.request.on_rows : nullptr;
+            if (front.at == stage::command && !front.streaming && !front.request.runs_alone() && (on_rows || HasResultLimits())) {
+                front.outcome.gather = !on_rows;
+                // Must happen before anything parses this command's first row.
+                if (!EnterStreamingMode()) {
+                    LoopConnectionLost(sql_error::BadConnection("failed to enter single-row mode"));
+                    return false;
+                }
+                front.streaming = true;
+            }
+            if (PQisBusy(conn))
+                return true;
+            result::unique_pg_result res(PQgetResult(conn));
+            progress = true;
+
+            switch (front.at) {
+                case stage::deallocate:
+                    if (!res)
+                        front.at = stage::deallocate_sync;
+                    break;
+                case stage::prepare:
+                    if (res) {
+                        AbsorbResult(front.outcome, std::move(res), nullptr);
+                        break;
+                    }
+                    front.outcome.result = nullptr;
+                    front.outcome.stale_statement = front.outcome.stale_statement || front.outcome.error.has_value();
+                    if (front.request.tally) {
+                        TallyBatchPrepare(front.request.tally, std::move(front.outcome));
+                        front.outcome = {};
+                    }
+                    front.at = stage::command;
+                    break;
+                case stage::command:
+                    if (res) {
+                        AbsorbResult(front.outcome, std::move(res), on_rows);
+                        // With requests pipelined behind, the cancel could hit one of them, so the
+                        // rest of the rows are only read and dropped.
+                        if (front.outcome.over_limit && !front.cancel_sent && loop.inflight.size() == 1)
+                            LoopCancelFront();
+                        break;
+                    }
+                    if (front.request.tally) {
+                        TallyBatchItem(front.request.tally, std::move(front.outcome));
+                        front.outcome = {};
+                        if (front.request.tally.items < front.request.detail.sets())
+                            break; // the next parameter set's results follow
+                    }
+                    if (!front.request.is_copy()) {
+                        front.at = stage::sync;
+                        break;
+                    }
+                    if (front.abort_msg == kCopyIdleTimeout) {
+                        finish_front(std::unexpected(sql_error::QueryTimedOut(kCopyIdleTimeout)));
+                    } else if (front.sink_error) {
+                        // Ahead of the command's error, which may just be the cancel it caused.
+                        finish_front(std::unexpected(std::move(*front.sink_error)));
+                    } else if (front.outcome.error) {
+                        finish_front(std::unexpected(std::move(*front.outcome.error)));
+                    } else if (!front.outcome.result) {
+                        finish_front(std::unexpected(sql_error::QueryFailed("no results received")));
+                    } else {
+                        finish_front(std::move(front.outcome.result));
+                    }
+                    break;
+                case stage::deallocate_sync:
+                case stage::sync:
+                    if (!res || PQresultStatus(res.get()) != PGRES_PIPELINE_SYNC) {
+                        LoopConnectionLost(sql_error::BadConnection("pipeline out of sync"));
+                        return false;
+                    }
+                    if (front.at == stage::deallocate_sync) {
+                        front.at = front.plan.prepare ? stage::prepare : stage::command;
+                        break;
+                    }
+                    if (front.request.tally) {
+                        finish_front(FinishBatch(front.request.detail, front.plan, front.request.tally));
+                    } else {
+                        if (front.cancel_sent)
+                            ReportCancelled(front.outcome);
+                        finish_front(FinishCommand(front.request.detail, front.plan, std::move(front.outcome)));
+                    }
+                    break;
+                case stage::copy_start: {
+                    const ExecStatusType st = res ? PQresultStatus(res.get()) : PGRES_FATAL_ERROR;
+                    if (st == PGRES_COPY_OUT) {
+                        front.at = stage::copy_out;
+                    } else if (st == PGRES_COPY_IN) {
+                        front.at = stage::copy_in;
+                    } else if (!res) {
+                        finish_front(std::unexpected(sql_error::QueryFailed("COPY did not start")));
+                    } else {
+                        front.outcome.error = sql_error::QueryFailed(PQresultErrorMessage(res.get()));
+                        front.at = stage::command; // read up to the end of the statement
+                    }
+                    break;
+                }
+                case stage::copy_out:
+                case stage::copy_in:
+                    break;
+            }
+        }
+        return true;
+    }
+
+    bool postgres_client::LoopReadCopyOut(bool& progress) const noexcept {
+        PGconn* conn = m_connection.get();
+        loop_state::pending_request& front = m_loop->inflight.front();
+        while (true) {
+            char* buffer = nullptr;
+            const int len = PQgetCopyData(conn, &buffer, 1);
+            if (len > 0) {
+                progress = true;
+                DeliverCopyData(front.request.copy_out, {reinterpret_cast<const std::byte*>(buffer), static_cast<std::size_t>(len)}, front.sink_error);
+                PQfreemem(buffer);
+                // No point streaming the rest to a failed sink; the server stops once the cancel
+                // lands and only what it already sent is drained.
+                if (front.sink_error && !front.cancel_sent)
+                    LoopCancelFront();
+                continue;
+            }
+            if (len == -1) {
+                progress = true;
+                front.at = loop_state::stage::command;
+                return true;
+            }
+            if (len == -2) {
+                LoopConnectionLost(sql_error::BadConnection(PQerrorMessage(conn)));
+                return false;
+            }
+            return true; // the rest hasn't arrived yet
+        }
+    }
+
+    bool postgres_client::LoopWriteCopyIn(bool& progress) const noexcept {
+        loop_state& loop = *m_loop;
+        loop.write_blocked = false;
+        if (loop.inflight.empty() || loop.inflight.front().at != loop_state::stage::copy_in)
+            return true;
+        PGconn* conn = m_connection.get();
+        loop_state::pending_request& front = loop.inflight.front();
+
+        // As in the threaded worker at most one chunk sits in libpq's buffer: a slow server
+        // leaves chunks in the channel, whose bound then blocks the writer.
+        const int pending = PQflush(conn);
+        if (pending < 0) {
+            LoopConnectionLost(sql_error::SocketFailed("failed to flush socket"));
+            return false;
+        }
+        if (pending == 1) {
+            loop.write_blocked = true;
+            return true;
+        }
+        // A failed put with the connection still up means the server already ended the COPY;
+        // its error is read as the command's result.
+        const auto copy_ended = [&] {
+            if (!is_connected()) {
+                LoopConnectionLost(sql_error::BadConnection(PQerrorMessage(conn)));
+                return false;
+            }
+            front.at = loop_state::stage::command;
+            progress = true;
+            return true;
+        };
+
+        while (true) {
+            if (!front.chunk_pending && !front.input_done) {
+                const std::optional<internal::copy_in_channel::pop_status> status = front.request.copy_in->try_pop(front.chunk);
+                if (!status) {
+                    // Woken again by the channel, or by the timer once the writer is idle too long.
+                    loop.reactor.cancel(loop.copy_idle_timer);
+                    loop.copy_idle_timer = 0;
+                    if (const auto due = front.request.copy_in->idle_deadline(); due != internal::copy_in_channel::clock::time_point::max()) {
+                        loop.copy_idle_timer = loop.reactor.run_at(due, [state = m_loop] {
+                            state->copy_idle_timer = 0;
+                            if (state->client)
+                                state->client->LoopPump();
+                        });
+                    }
+                    return true;
+                }
+                if (*status == internal::copy_in_channel::pop_status::chunk) {
+                    front.chunk_pending = true;
+                } else {
+                    front.input_done = true;
+                    if (*status == internal::copy_in_channel::pop_status::timed_out)
+                        front.abort_msg = kCopyIdleTimeout;
+                    else if (*status != internal::copy_in_channel::pop_status::finished)
+                        front.abort_msg = "COPY aborted by client";
+                }
+            }
+            if (front.chunk_pending) {
+                const int put = PQputCopyData(conn, front.chunk.data(), static_cast<int>(front.chunk.size()));
+                if (put < 0)
+                    return copy_ended();
+                if (put == 0) {
+                    loop.write_blocked = true;
+                    return true;
+                }
+                front.chunk_pending = false;
+                progress = true;
+                const int flushed = PQflush(conn);
+                if (flushed < 0) {
+                    LoopConnectionLost(sql_error::SocketFailed("failed to flush socket"));
+                    return false;
+                }
+                if (flushed == 1) {
+                    loop.write_blocked = true;
+                    return true;
+                }
+                continue;
+            }
+            const int put = PQputCopyEnd(conn, front.abort_msg);
+            if (put < 0)
+                return copy_ended();
+            if (put == 0) {
+                loop.write_blocked = true;
+                return true;
+            }
+            front.at = loop_state::stage::command;
+            progress = true;
+            return true;
+        }
+    }
+
+    void postgres_client::LoopWatch(const short events) const noexcept {
+        loop_state& loop = *m_loop;
+        const int sock = PQsocket(m_connection.get());
+        if (sock != loop.fd) {
+            // libpq may have moved to a new socket while reconnecting.
+            if (loop.fd >= 0)
+                loop.reactor.unwatch(loop.fd);
+            loop.fd = sock;
+            loop.events = events;
+            if (sock >= 0) {
+                loop.reactor.watch(sock, events, [state = m_loop](const short revents) {
+                    if (state->client)
+                        state->client->LoopOnReady(revents);
+                });
+            }
+            return;
+        }
+        if (sock >= 0 && loop.events != events) {
+            loop.reactor.modify(sock, events);
+            loop.events = events;
+        }
+    }
+
+    void postgres_client::LoopConnectionLost(const sql_error& error) const noexcept {
+        loop_state& loop = *m_loop;
+        if (loop.fd >= 0)
+            loop.reactor.unwatch(loop.fd);
+        loop.fd = -1;
+        loop.write_blocked = false;
+        loop.reactor.cancel(loop.cancel_timer);
+        loop.cancel_timer = 0;
+        loop.reactor.cancel(loop.copy_idle_timer);
+        loop.copy_idle_timer = 0;
+        LoopStopCancel();
+
+        // Everything in flight reached the server, which may have run or even committed it before
+        // the connection dropped, so none of it is re-sent. Only what was never sent (loop.retry
+        // and the queue) goes out on the new session, as in ExecutePipeline.
+        while (!loop.inflight.empty()) {
+            loop_state::pending_request lost = loop.inflight.pop_front();
+            if (lost.request.copy_in)
+                lost.request.copy_in->set_notify(nullptr);
+            CompleteRequest(lost.request, std::unexpected(error));
+        }
+        LoopStartReconnect();
+    }
+
+    void postgres_client::LoopStartReconnect() const noexcept {
+        loop_state& loop = *m_loop;
+        // Server-side prepared statements die with the old session.
+        m_statements.clear();
+        if (loop.fd >= 0)
+            loop.reactor.unwatch(loop.fd); // PQresetStart closes the socket
+        loop.fd = -1;
+        if (!PQresetStart(m_connection.get())) {
+            LoopReconnectFailed("PQresetStart failed");
+            return;
+        }
+        loop.reconnecting = true;
+        loop.reconnect_timer = loop.reactor.run_at(std::chrono::steady_clock::now() + kReconnectTimeout, [state = m_loop] {
+            state->reconnect_timer = 0;
+            if (state->client && state->reconnecting)
+                state->client->LoopReconnectFailed("timeout");
+        });
+        LoopContinueReconnect();
+    }
+
+    void postgres_client::LoopContinueReconnect() const noexcept {
+        loop_state& loop = *m_loop;
+        PGconn* conn = m_connection.get();
+        const PostgresPollingStatusType st = PQresetPoll(conn);
+        if (st == PGRES_POLLING_FAILED) {
+            LoopReconnectFailed("PQresetPoll failed");
+            return;
+        }
+        if (st != PGRES_POLLING_OK) {
+            LoopWatch(st == PGRES_POLLING_WRITING ? POLLOUT : POLLIN);
+            return;
+        }
+        if (PQsetnonblocking(conn, 1) != 0) {
+            LoopReconnectFailed("PQsetnonblocking failed");
+            return;
+        }
+        loop.reconnecting = false;
+        loop.reactor.cancel(loop.reconnect_timer);
+        loop.reconnect_timer = 0;
+        LoopPump();
+    }
+
+    void postgres_client::LoopReconnectFailed(const char* reason) const noexcept {
+        loop_state& loop = *m_loop;
+        loop.reconnecting = false;
+        loop.reactor.cancel(loop.reconnect_timer);
+        loop.reconnect_timer = 0;
+        if (loop.fd >= 0)
+            loop.reactor.unwatch(loop.fd);
+        loop.fd = -1;
+
+        // Everything waiting fails now; the next request starts a fresh attempt.
+        std::deque<query_request> failed;
+        failed.swap(loop.retry);
+        while (m_requests.front() != nullptr)
+            failed.emplace_back(m_requests.pop_front());
+        for (auto& item : failed)
+            CompleteRequest(item, std::unexpected(sql_error::FailedToReconnect(reason)));
+    }
+
+    void postgres_client::LoopScheduleHeartbeat() const noexcept {
+        if (!m_config.heartbeat_enabled)
+            return;
+        thread_local std::mt19937 rng(std::random_device{}());
+        std::uniform_int_distribution heartbeat_sec(60, 120);
+        loop_state& loop = *m_loop;
+        const auto when = std::chrono::steady_clock::now() + std::chrono::seconds(heartbeat_sec(rng));
+        loop.heartbeat_timer = loop.reactor.run_at(when, [state = m_loop] {
+            if (!state->client)
+                return;
+            constexpr std::string_view heartbeat_query = "SELECT 1";
+            query_request ping{pg_param_detail{heartbeat_query, 0}};
+            ping.direct_callback = true;
+            ping.on_success = [](result::table) { std::println("Postgres: heartbeat successful"); };
+            ping.on_error = [](const sql_error&) { std::println("Postgres: heartbeat failed"); };
+            state->client->Enqueue(std::move(ping));
+            state->client->LoopScheduleHeartbeat();
+        });
+    }
+
+    void postgres_client::LoopArmDeadline() const noexcept {
+        loop_state& loop = *m_loop;
+        // Only the front request is being answered; the ones behind it are timed once they get there.
+        query_deadline due = no_deadline;
+        if (!loop.inflight.empty() && !loop.inflight.front().cancel_sent)
+            due = loop.inflight.front().request.deadline;
+        if (due == loop.deadline_due)
+            return;
+        loop.reactor.cancel(loop.deadline_timer);
+        loop.deadline_timer = 0;
+        loop.deadline_due = due;
+        if (due == no_deadline)
+            return;
+        loop.deadline_timer = loop.reactor.run_at(due, [state = m_loop] {
+            state->deadline_timer = 0;
+            state->deadline_due = no_deadline;
+            if (state->client)
+                state->client->LoopDeadlinePassed();
+        });
+    }
+
+    void postgres_client::LoopDeadlinePassed() const noexcept {
+        loop_state& loop = *m_loop;
+        if (loop.reconnecting || loop.inflight.empty())
+            return;
+        loop_state::pending_request& front = loop.inflight.front();
+        if (front.cancel_sent || std::chrono::steady_clock::now() < front.request.deadline) {
+            LoopArmDeadline();
+            return;
+        }
+        LoopCancelFront();
+    }
+
+    // Asks the server to cancel the front request. Results keep being read as usual: the
+    // cancelled statement ends with an error and a sync.
+    void postgres_client::LoopCancelFront() const noexcept {
+        loop_state& loop = *m_loop;
+        loop_state::pending_request& front = loop.inflight.front();
+        front.cancel_sent = true;
+        LoopStopCancel();
+        if constexpr (internal::query_cancel::kBlocking) {
+            // PQcancel() waits for the server and would stall every connection on this reactor,
+            // so it runs on the callback pool. The loop is held so the reactor outlives the task.
+            if (PGcancel* cancel = PQgetCancel(m_connection.get())) {
+                loop.cancel_pending = true;
+                PostCallback([state = m_loop, keep = m_config.loop, cancel, generation = loop.cancel_generation] {
+                    internal::query_cancel::send(cancel);
+                    state->reactor.post([state, generation] {
+                        if (state->client && state->cancel_generation == generation)
+                            state->client->LoopCancelDone();
+                    });
+                });
+            }
+        } else if (m_cancel.start(m_connection.get())) {
+            loop.cancel_pending = true;
+            LoopWatchCancel();
+        }
+        loop.reactor.cancel(loop.cancel_timer);
+        loop.cancel_timer = loop.reactor.run_at(std::chrono::steady_clock::now() + kCancelTimeout, [state = m_loop, id = front.id] {
+            state->cancel_timer = 0;
+            if (!state->client || state->reconnecting)
+                return;
+            if (!state->inflight.empty() && state->inflight.front().id == id) {
+                state->client->LoopConnectionLost(sql_error::SocketFailed("no answer after cancelling a query"));
+            } else if (state->cancel_pending) {
+                // The statement ended but the cancel never got through; stop waiting for it.
+                state->client->LoopStopCancel();
+                state->client->LoopPump();
+            }
+        });
+    }
+
+    void postgres_client::LoopWatchCancel() const noexcept {
+        loop_state& loop = *m_loop;
+        loop.cancel_fd = m_cancel.socket();
+        if (loop.cancel_fd < 0) {
+            m_cancel.reset();
+            loop.cancel_pending = false;
+            return;
+        }
+        loop.reactor.watch(loop.cancel_fd, m_cancel.events(), [state = m_loop](short) {
+            if (state->client)
+                state->client->LoopAdvanceCancel();
+        });
+    }
+
+    void postgres_client::LoopAdvanceCancel() const noexcept {
+        loop_state& loop = *m_loop;
+        // Unwatched before libpq gets a chance to close or replace the socket.
+        if (loop.cancel_fd >= 0)
+            loop.reactor.unwatch(loop.cancel_fd);
+        loop.cancel_fd = -1;
+        if (m_cancel.advance())
+            LoopWatchCancel();
+        if (!m_cancel.in_progress())
+            LoopCancelDone();
+    }
+
+    void postgres_client::LoopStopCancel() const noexcept {
+        loop_state& loop = *m_loop;
+        if (loop.cancel_fd >= 0)
+            loop.reactor.unwatch(loop.cancel_fd);
+        loop.cancel_fd = -1;
+        m_cancel.reset();
+        loop.cancel_pending = false;
+        ++loop.cancel_generation;
+    }
+
+    // The cancel has reached the server; what it stopped ends with an error and a sync as usual.
+    void postgres_client::LoopCancelDone() const noexcept {
+        m_loop->cancel_pending = false;
+        LoopPump();
+    }
+}
@@ -2,187 +2,266 @@
 // Created by Shinnosuke Kawai on 1/26/26.
 //
 #include "database/postgres_client.h"
+#include <array>
+#include <climits>
 #ifdef _WIN32
 #define poll WSAPoll
 #endif
 
 namespace database {
     namespace {
-        thread_local bool tl_is_callback_thread = false;
+        bool IsStreamedBatch(const ExecStatusType st) noexcept {
+#ifdef LIBPQ_HAS_CHUNK_MODE
+            if (st == PGRES_TUPLES_CHUNK)
+                return true;
+#endif
+            return st == PGRES_SINGLE_TUPLE;
+        }
+
+        // Errors that end one statement but leave the session in sync for the next request.
+        bool IsStatementError(const sql_error& error) noexcept {
+            return error.get_type() == sql_error::type::QueryFailed || error.get_type() == sql_error::type::TimeOut ||
+                   error.get_type() == sql_error::type::ResultTooLarge;
+        }
+
+        // How long a socket may stay quiet while a result is owed before the connection counts
+        // as broken. A query with a deadline is waited for until then instead.
+        constexpr auto kSocketTimeout = std::chrono::milliseconds(5000);
     }
 }
 namespace database {
-    std::future<std::expected<result::table, sql_error>> postgres_client::SendToWorker(pg_param_detail&& query_detail) const {
-        using Result = std::expected<result::table, sql_error>;
-        auto prom = std::make_shared<std::promise<Result>>();
-        auto future = prom->get_future();
+    query_future<std::expected<result::table, sql_error>> postgres_client::SendToWorker(pg_param_detail&& query_detail, const query_deadline deadline) const {
+        auto state = smart_ptr::make_intrusive<internal::oneshot_state<std::expected<result::table, sql_error>>>();
         query_request request{std::move(query_detail)};
         request.direct_callback = true;
-        request.on_success = [prom](result::table table) {
-            try {
-                prom->set_value(std::move(table));
-            } catch (...) {}
-        };
-        request.on_error = [prom](const sql_error& err) {
-            try {
-                prom->set_value(std::unexpected(err));
-            } catch (...) {}
-        };
-        {
-            std::lock_guard sl(m_mutex);
-            m_requests.emplace_back(std::move(request));
-        }
-        m_cv.notify_one();
-        return future;
+        request.deadline = deadline;
+        request.table_result = state;
+        Enqueue(std::move(request));
+        return query_future{std::move(state)};
     }
 
-    void postgres_client::EnqueueAsync(pg_param_detail&& detail, result_callback&& callback, error_callback&& err_callback) const noexcept {
+    void postgres_client::EnqueueAsync(pg_param_detail&& detail, result_callback&& callback, error_callback&& err_callback, const query_deadline deadline) const noexcept {
         query_request request{};
         request.detail = std::move(detail);
         request.on_success = std::move(callback);
         request.on_error = std::move(err_callback);
-        {
-            std::lock_guard sl(m_mutex);
-            m_requests.emplace_back(std::move(request));
-        }
-        m_cv.notify_one();
+        request.deadline = deadline;
+        Enqueue(std::move(request));
     }
 
-    void postgres_client::PostCallback(std::function<void()> task) const noexcept {
-        if (tl_is_callback_thread) {
-            task();
-            return;
+    void postgres_client::EnqueueDirect(pg_param_detail&& detail, result_callback&& callback, error_callback&& err_callback, const query_deadline deadline) const noexcept {
+        query_request request{std::move(detail)};
+        request.direct_callback = true;
+        request.on_success = std::move(callback);
+        request.on_error = std::move(err_callback);
+        request.deadline = deadline;
+        Enqueue(std::move(request));
+    }
+
+    query_future<std::expected<std::size_t, sql_error>> postgres_client::SendStreamToWorker(pg_param_detail&& query_detail, row_batch_callback&& on_rows) const {
+        query_request request{std::move(query_detail)};
+        request.on_rows.deliver = std::move(on_rows);
+        return SendCopyToWorker(std::move(request));
+    }
+
+    query_future<std::expected<result::batch_result, sql_error>> postgres_client::SendBatchToWorker(pg_param_detail&& batch_detail) const {
+        if (batch_detail.sets() == 0) {
+            return query_future<std::expected<result::batch_result, sql_error>>::ready(result::batch_result{});
         }
-        if (m_idle_cb_workers.load(std::memory_order_acquire) == 0) {
-            auto done = std::make_shared<std::atomic_bool>(false);
-            std::jthread temp([done, task = std::move(task)]() mutable noexcept {
-                tl_is_callback_thread = true;
-                task();
-                done->store(true, std::memory_order_release);
-            });
+        auto state = smart_ptr::make_intrusive<internal::oneshot_state<std::expected<result::batch_result, sql_error>>>();
+        query_request request{std::move(batch_detail)};
+        request.direct_callback = true;
+        request.tally.promise = state;
+        Enqueue(std::move(request));
+        return query_future{std::move(state)};
+    }
 
-            {
-                std::lock_guard lk(m_temp_cb_mutex);
-                reap_overflow_threads(m_overflow_cb_threads);
-                m_overflow_cb_threads.push_back({
-                    .done = done,
-                    .thread = std::move(temp)
-                });
-            }
-            return;
+    query_future<std::expected<std::size_t, sql_error>> postgres_client::SendCopyToWorker(query_request&& request) const {
+        auto state = smart_ptr::make_intrusive<internal::oneshot_state<std::expected<std::size_t, sql_error>>>();
+        request.direct_callback = true;
+        request.count_result = state;
+        Enqueue(std::move(request));
+        return query_future{std::move(state)};
+    }
+
+    void postgres_client::Enqueue(query_request&& request) const {
+        m_requests.push(std::move(request));
+        if (m_loop) {
+            LoopWake();
+        } else {
+            m_worker_parker.unpark();
         }
-        {
-            std::lock_guard lk(m_cb_mutex);
-            m_cb_queue.push_back(std::move(task));
+    }
+
+    void postgres_client::PostCallback(std::function<void()> task) const noexcept {
+        if (m_config.loop) {
+            m_config.loop->post_callback(std::move(task));
+        } else {
+            m_callbacks.post(std::move(task));
         }
-        m_cb_cv.notify_one();
     }
 
     void postgres_client::QueryWorker(const std::stop_token &st) const noexcept {
         std::mt19937 rng(std::random_device{}());
         std::uniform_int_distribution heartbeat_sec(60, 120);
         auto next_heartbeat = std::chrono::steady_clock::now() + std::chrono::seconds(heartbeat_sec(rng));
+        const std::size_t max_batch = std::max<std::size_t>(m_config.pipeline_depth, 1);
+        std::vector<query_request> batch;
+        batch.reserve(max_batch);
+        const auto has_work = [&] { return st.stop_requested() || !m_requests.empty(); };
         while (!st.stop_requested()) {
-            query_request item;
-            {
-                std::unique_lock sl(m_mutex);
-                if (!m_heartbeat_enabled) {
-                    m_cv.wait(sl, [&] { return st.stop_requested() || !m_requests.empty();});
-                } else {
-                    const auto now = std::chrono::steady_clock::now();
-                    if (now >= next_heartbeat) {
-                        sl.unlock();
-
-                        constexpr std::string_view heartbeat_query = "SELECT 1";
-                        auto timeout = std::chrono::milliseconds(5000);
-                        pg_param_detail ping_detail{heartbeat_query, 0};
-                        if (auto heart_beat = ExecuteWithRetry(ping_detail, timeout)) {
-                            std::println("Postgres: heartbeat successful");
-                        } else {
-                            std::println("Postgres: heartbeat failed");
-                        }
-                        next_heartbeat = std::chrono::steady_clock::now() + std::chrono::seconds(heartbeat_sec(rng));
-                        continue;
-                    }
-                    m_cv.wait_for(sl, next_heartbeat - now, [&] {
-                        return st.stop_requested() || !m_requests.empty();
-                    });
+            batch.clear();
+            if (!m_config.heartbeat_enabled) {
+                if (m_requests.empty()) {
+                    m_worker_parker.park(has_work);
+                    continue;
                 }
-                if (st.stop_requested()) {
-                    std::deque<query_request> pending_reqs;
-                    pending_reqs.swap(m_requests);
-                    sl.unlock();
-                    for (auto& pending_item : pending_reqs) {
-                        auto cb = std::move(pending_item.on_error);
-                        if (pending_item.direct_callback) {
-                            cb(sql_error::ShuttingDown("worker thread stopped"));
-                        } else {
-                            PostCallback([cb = std::move(cb)] { cb(sql_error::ShuttingDown("worker thread stopped")); });
-                        }
+            } else {
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= next_heartbeat) {
+                    constexpr std::string_view heartbeat_query = "SELECT 1";
+                    auto timeout = std::chrono::milliseconds(5000);
+                    pg_param_detail ping_detail{heartbeat_query, 0};
+                    if (auto heart_beat = ExecuteWithRetry(ping_detail, timeout)) {
+                        std::println("Postgres: heartbeat successful");
+                    } else {
+                        std::println("Postgres: heartbeat failed");
                     }
-                    break;
+                    next_heartbeat = std::chrono::steady_clock::now() + std::chrono::seconds(heartbeat_sec(rng));
+                    continue;
                 }
                 if (m_requests.empty()) {
+                    m_worker_parker.park(has_work, next_heartbeat);
                     continue;
                 }
-                item = std::move(m_requests.front());
-                m_requests.pop_front();
             }
-
-            std::expected<result::unique_pg_result, sql_error> result = ExecuteWithRetry(item.detail, std::chrono::milliseconds(5000));
-            if (!result) {
-                auto cb  = std::move(item.on_error);
-                sql_error& err = result.error();
-                if (item.direct_callback) {
-                    cb(err);
-                } else {
-                    PostCallback([cb = std::move(cb), err] { cb(err); });
+            while (batch.size() < max_batch) {
+                query_request* front = m_requests.front();
+                if (front == nullptr || (front->exclusive() && !batch.empty()))
+                    break;
+                if (FailIfExpired(*front)) {
+                    m_requests.pop_front();
+                    continue;
                 }
+                batch.emplace_back(m_requests.pop_front());
+                if (batch.back().exclusive())
+                    break;
+            }
+            if (batch.empty()) {
                 continue;
             }
-            auto cb = std::move(item.on_success);
-            if (item.direct_callback) {
-                cb(result::table{std::move(result.value())});
-            } else {
-                auto shared_table = std::make_shared<result::table>(std::move(result.value()));
-                PostCallback([cb = std::move(cb), shared_table]() mutable {
-                    cb(std::move(*shared_table));
-                });
+            if (batch.front().copy_in) {
+                query_request& item = batch.front();
+                CompleteRequest(item, ExecuteCopyIn(*item.copy_in, item.detail, st));
+                continue;
+            }
+            if (batch.front().copy_out) {
+                query_request& item = batch.front();
+                CompleteRequest(item, ExecuteCopyOut(item.copy_out, item.detail, st));
+                continue;
+            }
+            if (batch.front().tally) {
+                query_request& item = batch.front();
+                CompleteRequest(item, ExecuteBatch(item.detail, item.tally));
+                continue;
+            }
+            if (batch.size() == 1) {
+                query_request& item = batch.front();
+                row_stream* on_rows = item.on_rows ? &item.on_rows : nullptr;
+                CompleteRequest(item, ExecuteWithRetry(item.detail, std::chrono::milliseconds(5000), on_rows, item.deadline));
+                continue;
             }
+            ExecutePipeline(batch);
+        }
+        while (m_requests.front() != nullptr) {
+            query_request pending_item = m_requests.pop_front();
+            CompleteRequest(pending_item, std::unexpected(sql_error::ShuttingDown("worker thread stopped")));
         }
     }
 
-    void postgres_client::CallbackWorker(const std::stop_token& st) const noexcept {
-        tl_is_callback_thread = true;
-        while (true) {
-            std::function<void()> task;
-            {
-                std::unique_lock lk(m_cb_mutex);
-                m_idle_cb_workers.fetch_add(1, std::memory_order_release);
-                m_cb_cv.wait(lk, [&] { return st.stop_requested() || !m_cb_queue.empty(); });
-                m_idle_cb_workers.fetch_sub(1, std::memory_order_release);
-                if (m_cb_queue.empty())
-                    break; // stop requested and queue fully drained
-                task = std::move(m_cb_queue.front());
-                m_cb_queue.pop_front();
+    void postgres_client::CompleteRequest(query_request& item, std::expected<result::unique_pg_result, sql_error>&& result) const noexcept {
+        if (!result && item.copy_in) {
+            item.copy_in->fail(result.error());
+        }
+        if (item.tally) {
+            if (result) {
+                item.tally.promise->set(std::move(item.tally.summary));
+            } else {
+                item.tally.promise->set(std::unexpect, std::move(result.error()));
             }
-            task();
+            return;
+        }
+        if (item.table_result) {
+            if (result) {
+                item.table_result->set(std::in_place, std::move(result.value()), m_memory);
+            } else {
+                item.table_result->set(std::unexpect, std::move(result.error()));
+            }
+            return;
+        }
+        if (item.count_result) {
+            if (!result) {
+                item.count_result->set(std::unexpect, std::move(result.error()));
+            } else if (item.on_rows) {
+                item.count_result->set(item.on_rows.rows);
+            } else {
+                item.count_result->set(result::table{std::move(result.value())}.affected_rows());
+            }
+            return;
+        }
+        if (!result) {
+            auto cb  = std::move(item.on_error);
+            sql_error& err = result.error();
+            if (item.direct_callback) {
+                cb(err);
+            } else {
+                PostCallback([cb = std::move(cb), err] { cb(err); });
+            }
+            return;
+        }
+        auto cb = std::move(item.on_success);
+        if (item.direct_callback) {
+            cb(result::table{std::move(result.value()), m_memory});
+        } else {
+            // A pooled carrier keeps the posted closure down to one pointer, which std::function
+            // stores inline, instead of a heap-allocated closure around a shared table.
+            auto* delivery = new async_delivery{std::move(cb), std::move(result.value()), m_memory};
+            PostCallback([delivery] {
+                const std::unique_ptr<async_delivery> owned(delivery);
+                owned->callback(std::move(owned->table));
+            });
         }
     }
 
-    std::expected<result::unique_pg_result, sql_error> postgres_client::ExecuteWithRetry(const pg_param_detail& param_detail, const std::chrono::milliseconds reconnect_timeout) const noexcept {
+    // A request whose deadline passed while it was queued is failed without being sent.
+    bool postgres_client::FailIfExpired(query_request& item) const noexcept {
+        if (item.deadline == no_deadline || std::chrono::steady_clock::now() < item.deadline)
+            return false;
+        CompleteRequest(item, std::unexpected(sql_error::QueryTimedOut("deadline passed before the query was sent")));
+        return true;
+    }
+
+    std::expected<result::unique_pg_result, sql_error> postgres_client::ExecuteWithRetry(const pg_param_detail& param_detail, const std::chrono::milliseconds reconnect_timeout, row_stream* on_rows, const query_deadline deadline) const noexcept {
         for (int attempts = 1; attempts <= 2; ++attempts) {
-            if (!is_connected()) {
+            if (deadline != no_deadline && std::chrono::steady_clock::now() >= deadline) {
+                return std::unexpected(sql_error::QueryTimedOut("deadline passed before the query was sent"));
+            }
+            if (!IsSessionIdle()) {
                 if (std::optional<sql_error> error = AttemptReconnect(reconnect_timeout)) {
                     return std::unexpected(*error);
                 }
             }
 
-            std::expected<result::unique_pg_result, sql_error> exe_res = ExecuteQuery(param_detail);
+            std::expected<result::unique_pg_result, sql_error> exe_res = ExecuteQuery(param_detail, on_rows, deadline);
             if (exe_res) {
                 return exe_res;
             }
             sql_error& err = exe_res.error();
+            if (err.get_type() == sql_error::type::BadConnection && on_rows) {
+                // Rows may already have reached the caller; never re-send a stream.
+                AttemptReconnect(reconnect_timeout);
+                return std::unexpected(err);
+            }
             if (err.get_type() == sql_error::type::BadConnection && attempts == 1) {
                 if (auto error = AttemptReconnect(reconnect_timeout)) {
                     return std::unexpected(*error);
@@ -194,37 +273,650 @@ namespace database {
         return std::unexpected(sql_error::QueryFailed("unreachable"));
     }
 
-    std::expected<result::unique_pg_result, sql_error> postgres_client::ExecuteQuery(const pg_param_detail& param_detail) const noexcept {
+    std::expected<result::unique_pg_result, sql_error> postgres_client::ExecuteQuery(const pg_param_detail& param_detail, row_stream* on_rows, const query_deadline deadline) const noexcept {
         const int sock = PQsocket(m_connection.get());
         if (sock < 0) {
             return std::unexpected(sql_error::SocketFailed("failed to get socket"));
         }
-        const int ok = PQsendQueryParams(
-            m_connection.get(),
-            param_detail.query.c_str(),
-            param_detail.count(),
-            nullptr,
-            param_detail.buffers.data(),
-            param_detail.lengths.data(),
-            param_detail.formats.data(),
-            1);
-
-        if (ok == 0) {
+        // A single query is a pipeline of one: PREPARE, DEALLOCATE and the execution
+        // itself then share a single round trip.
+        if (PQenterPipelineMode(m_connection.get()) == 0) {
+            const char* msg = PQerrorMessage(m_connection.get());
+            return std::unexpected(sql_error::BadConnection(msg));
+        }
+        std::expected<statement_plan, sql_error> plan = SendPipelined(param_detail);
+        if (!plan) {
+            return std::unexpected(plan.error());
+        }
+        if (auto poll_out = CheckForPollOut(sock); !poll_out) {
+            return std::unexpected(poll_out.error());
+        }
+
+        std::expected<result::unique_pg_result, sql_error> result = ConsumePipelineResult(sock, param_detail, *plan, on_rows, deadline);
+        if (!result && !IsStatementError(result.error())) {
+            return result;
+        }
+        if (PQexitPipelineMode(m_connection.get()) == 0) {
             const char* msg = PQerrorMessage(m_connection.get());
             return std::unexpected(sql_error::BadConnection(msg));
         }
+        return result;
+    }
+
+    void postgres_client::ExecutePipeline(const std::span<query_request> batch) const noexcept {
+        constexpr auto reconnect_timeout = std::chrono::milliseconds(5000);
+        if (!IsSessionIdle()) {
+            if (std::optional<sql_error> error = AttemptReconnect(reconnect_timeout)) {
+                for (auto& item : batch)
+                    CompleteRequest(item, std::unexpected(*error));
+                return;
+            }
+        }
+
+        // Requests that reached libpq may have run, or committed, on the server before the
+        // connection broke, so only the ones never sent are retried.
+        std::size_t completed = 0;
+        std::size_t sent = 0;
+        std::optional<sql_error> broken;
+        const int sock = PQsocket(m_connection.get());
+        if (sock >= 0 && PQenterPipelineMode(m_connection.get()) == 1) {
+            std::vector<statement_plan> plans;
+            plans.reserve(batch.size());
+            for (const auto& item : batch) {
+                // A request that failed to send never got its sync, so it can't have committed;
+                // it is retried with the rest once the ones before it are read.
+                std::expected<statement_plan, sql_error> plan = SendPipelined(item.detail);
+                if (!plan)
+                    break;
+                plans.push_back(*plan);
+                ++sent;
+            }
+            if (auto poll_out = CheckForPollOut(sock); !poll_out) {
+                broken = std::move(poll_out.error());
+            }
+            // Every request is followed by its own sync point, so a failing statement only
+            // aborts its own segment and the next request's results are unaffected.
+            for (; !broken && completed < sent; ++completed) {
+                query_request& item = batch[completed];
+                row_stream* on_rows = item.on_rows ? &item.on_rows : nullptr;
+                std::expected<result::unique_pg_result, sql_error> result =
+                    ConsumePipelineResult(sock, item.detail, plans[completed], on_rows, item.deadline, completed + 1 == sent);
+                if (!result && !IsStatementError(result.error())) {
+                    broken = result.error();
+                    break;
+                }
+                CompleteRequest(item, std::move(result));
+            }
+            if (PQexitPipelineMode(m_connection.get()) == 0) {
+                // Results of the aborted batch are still pending; the session can't be reused as is.
+                if (std::optional<sql_error> error = AttemptReconnect(reconnect_timeout)) {
+                    for (; completed < batch.size(); ++completed)
+                        CompleteRequest(batch[completed], std::unexpected(completed < sent ? *broken : *error));
+                    return;
+                }
+            }
+        }
+        // Reading only stops short of the sent requests once the connection broke.
+        for (; completed < sent; ++completed) {
+            CompleteRequest(batch[completed], std::unexpected(*broken));
+        }
 
+        // Whatever the broken pipeline never sent is retried one by one, the same way a single
+        // query is retried after a dropped connection.
+        for (; completed < batch.size(); ++completed) {
+            query_request& item = batch[completed];
+            row_stream* on_rows = item.on_rows ? &item.on_rows : nullptr;
+            CompleteRequest(item, ExecuteWithRetry(item.detail, reconnect_timeout, on_rows, item.deadline));
+        }
+    }
+
+    // execute_many() on the worker thread. The batch is never re-sent after a dropped connection,
+    // since its sync may already have committed it.
+    std::expected<result::unique_pg_result, sql_error> postgres_client::ExecuteBatch(const pg_param_detail& param_detail, batch_tally& tally) const noexcept {
+        if (!IsSessionIdle()) {
+            if (std::optional<sql_error> error = AttemptReconnect(std::chrono::milliseconds(5000))) {
+                return std::unexpected(*error);
+            }
+        }
+        const int sock = PQsocket(m_connection.get());
+        if (sock < 0) {
+            return std::unexpected(sql_error::SocketFailed("failed to get socket"));
+        }
+        if (PQenterPipelineMode(m_connection.get()) == 0) {
+            return std::unexpected(sql_error::BadConnection(PQerrorMessage(m_connection.get())));
+        }
+        std::expected<statement_plan, sql_error> plan = SendPipelined(param_detail);
+        if (!plan) {
+            return std::unexpected(plan.error());
+        }
+        // The connection is nonblocking and CheckForPollOut reads while it flushes, so a batch
+        // larger than the socket buffers can't deadlock against the server's replies.
         if (auto poll_out = CheckForPollOut(sock); !poll_out) {
             return std::unexpected(poll_out.error());
         }
-        if (auto poll_in = CheckForPollIn(sock); !poll_in) {
-            return std::unexpected(poll_in.error());
+        if (auto read = ReadBatchResult(sock, param_detail, *plan, tally); !read) {
+            return std::unexpected(read.error());
+        }
+        if (PQexitPipelineMode(m_connection.get()) == 0) {
+            return std::unexpected(sql_error::BadConnection(PQerrorMessage(m_connection.get())));
+        }
+        return FinishBatch(param_detail, *plan, tally);
+    }
+
+    // Sends a COPY statement on an idle session and waits for the server to switch into the
+    // expected copy state. Anything else is read to completion and reported as the error.
+    std::expected<result::unique_pg_result, sql_error> postgres_client::StartCopy(const int& socket, const pg_param_detail& copy_cmd, const ExecStatusType expected) const noexcept {
+        PGconn* conn = m_connection.get();
+        if (PQsendQuery(conn, copy_cmd.query_c_str()) == 0) {
+            return std::unexpected(sql_error::BadConnection(PQerrorMessage(conn)));
+        }
+        if (auto poll_out = CheckForPollOut(socket); !poll_out) {
+            return std::unexpected(poll_out.error());
+        }
+        if (auto ready = AwaitResult(socket); !ready) {
+            return std::unexpected(ready.error());
         }
 
-        return ConsumeResult();
+        result::unique_pg_result start(PQgetResult(conn));
+        if (start && PQresultStatus(start.get()) == expected) {
+            return std::move(start);
+        }
+        command_outcome outcome{};
+        outcome.error = sql_error::QueryFailed(start ? PQresultErrorMessage(start.get()) : "COPY did not start");
+        if (auto read = ReadCommand(socket, outcome); !read)
+            return std::unexpected(read.error());
+        return std::unexpected(std::move(*outcome.error));
+    }
+
+    std::expected<result::unique_pg_result, sql_error> postgres_client::ExecuteCopyIn(internal::copy_in_channel& channel, const pg_param_detail& copy_cmd, const std::stop_token& st) const noexcept {
+        if (!IsSessionIdle()) {
+            if (std::optional<sql_error> error = AttemptReconnect(std::chrono::milliseconds(5000))) {
+                return std::unexpected(*error);
+            }
+        }
+        const int sock = PQsocket(m_connection.get());
+        if (sock < 0) {
+            return std::unexpected(sql_error::SocketFailed("failed to get socket"));
+        }
+        if (auto started = StartCopy(sock, copy_cmd, PGRES_COPY_IN); !started) {
+            return std::unexpected(started.error());
+        }
+
+        command_outcome outcome{};
+
+        // Stream the writer's chunks until it finishes. A failed put with the connection still
+        // up means the server already ended the COPY; its error is read below.
+        const char* abort_msg = nullptr;
+        std::string chunk;
+        while (true) {
+            const auto status = channel.pop(chunk, st);
+            if (status == internal::copy_in_channel::pop_status::chunk) {
+                if (auto put = PutCopyData(sock, chunk); !put) {
+                    if (!is_connected())
+                        return std::unexpected(put.error());
+                    break;
+                }
+                continue;
+            }
+            if (status == internal::copy_in_channel::pop_status::aborted)
+                abort_msg = "COPY aborted by client";
+            else if (status == internal::copy_in_channel::pop_status::timed_out)
+                abort_msg = kCopyIdleTimeout;
+            else if (status == internal::copy_in_channel::pop_status::stopped)
+                abort_msg = "worker thread stopped";
+            break;
+        }
+        if (auto end = PutCopyEnd(sock, abort_msg); !end && !is_connected()) {
+            return std::unexpected(end.error());
+        }
+        if (auto read = ReadCommand(sock, outcome); !read) {
+            return std::unexpected(read.error());
+        }
+        if (abort_msg && st.stop_requested()) {
+            return std::unexpected(sql_error::ShuttingDown(abort_msg));
+        }
+        if (abort_msg == kCopyIdleTimeout) {
+            return std::unexpected(sql_error::QueryTimedOut(abort_msg));
+        }
+        if (outcome.error) {
+            return std::unexpected(std::move(*outcome.error));
+        }
+        if (!outcome.result) {
+            return std::unexpected(sql_error::QueryFailed("no results received"));
+        }
+        return std::move(outcome.result);
+    }
+
+    std::expected<result::unique_pg_result, sql_error> postgres_client::ExecuteCopyOut(const copy_sink& sink, const pg_param_detail& copy_cmd, const std::stop_token& st) const noexcept {
+        if (!IsSessionIdle()) {
+            if (std::optional<sql_error> error = AttemptReconnect(std::chrono::milliseconds(5000))) {
+                return std::unexpected(*error);
+            }
+        }
+        PGconn* conn = m_connection.get();
+        const int sock = PQsocket(conn);
+        if (sock < 0) {
+            return std::unexpected(sql_error::SocketFailed("failed to get socket"));
+        }
+        if (auto started = StartCopy(sock, copy_cmd, PGRES_COPY_OUT); !started) {
+            return std::unexpected(started.error());
+        }
+
+        // libpq hands out one CopyData message at a time. Once the sink fails the server is asked
+        // to cancel the COPY, and only what it sent before the cancel landed is drained so the
+        // session ends up idle; nothing more is delivered.
+        std::optional<sql_error> sink_error;
+        bool cancel_sent = false;
+        while (true) {
+            char* buffer = nullptr;
+            const int len = PQgetCopyData(conn, &buffer, 1);
+            if (len > 0) {
+                DeliverCopyData(sink, {reinterpret_cast<const std::byte*>(buffer), static_cast<std::size_t>(len)}, sink_error);
+                PQfreemem(buffer);
+                if (sink_error && !cancel_sent) {
+                    cancel_sent = true;
+                    m_cancel.start(conn);
+                }
+                continue;
+            }
+            if (len == -1) {
+                break;
+            }
+            if (len == -2) {
+                return std::unexpected(sql_error::BadConnection(PQerrorMessage(conn)));
+            }
+            // A slow query may keep the server quiet for a while, so an idle poll only
+            // re-checks for shutdown instead of failing the copy.
+            if (st.stop_requested()) {
+                return std::unexpected(sql_error::ShuttingDown("worker thread stopped"));
+            }
+            std::array<pollfd, 2> pfds = {{{sock, POLLIN, 0}, {m_cancel.socket(), m_cancel.events(), 0}}};
+            const int poll_res = poll(pfds.data(), m_cancel.in_progress() ? 2 : 1, 5000);
+            if (poll_res < 0) {
+                return std::unexpected(sql_error::SocketFailed("failed to poll socket"));
+            }
+            if (pfds[1].revents != 0) {
+                m_cancel.advance();
+            }
+            if (pfds[0].revents != 0 && PQconsumeInput(conn) == 0) {
+                return std::unexpected(sql_error::BadConnection(PQerrorMessage(conn)));
+            }
+        }
+
+        command_outcome outcome{};
+        if (auto read = ReadCommand(sock, outcome); !read) {
+            return std::unexpected(read.error());
+        }
+        if (cancel_sent) {
+            // Let the cancel land before the next request goes out, or it could hit that one.
+            FinishCancel();
+        }
+        // The cancel ends the COPY with an error of its own, so the sink's comes first.
+        if (sink_error) {
+            return std::unexpected(std::move(*sink_error));
+        }
+        if (outcome.error) {
+            return std::unexpected(std::move(*outcome.error));
+        }
+        if (!outcome.result) {
+            return std::unexpected(sql_error::QueryFailed("no results received"));
+        }
+        return std::move(outcome.result);
+    }
+
+    void postgres_client::DeliverCopyData(const copy_sink& sink, const std::span<const std::byte> data, std::optional<sql_error>& sink_error) const noexcept {
+        if (sink_error)
+            return;
+        try {
+            if (auto delivered = sink(data); !delivered)
+                sink_error = std::move(delivered.error());
+        } catch (...) {
+            sink_error = sql_error::CopyFailed("copy sink threw");
+        }
+    }
+
+    std::expected<void, sql_error> postgres_client::PutCopyData(const int& socket, const std::string_view data) const noexcept {
+        while (true) {
+            const int put = PQputCopyData(m_connection.get(), data.data(), static_cast<int>(data.size()));
+            if (put < 0) {
+                return std::unexpected(sql_error::BadConnection(PQerrorMessage(m_connection.get())));
+            }
+            // Flushing every chunk keeps at most one chunk in libpq's buffer; a slow server
+            // blocks us here, and the bounded channel passes that on to the writer.
+            if (auto flushed = CheckForPollOut(socket); !flushed) {
+                return flushed;
+            }
+            if (put == 1) {
+                return {};
+            }
+        }
+    }
+
+    std::expected<void, sql_error> postgres_client::PutCopyEnd(const int& socket, const char* error_msg) const noexcept {
+        while (true) {
+            const int put = PQputCopyEnd(m_connection.get(), error_msg);
+            if (put < 0) {
+                return std::unexpected(sql_error::BadConnection(PQerrorMessage(m_connection.get())));
+            }
+            if (auto flushed = CheckForPollOut(socket); !flushed) {
+                return flushed;
+            }
+            if (put == 1) {
+                return {};
+            }
+        }
+    }
+
+    std::expected<postgres_client::statement_plan, sql_error> postgres_client::SendPipelined(const pg_param_detail& param_detail) const noexcept {
+        PGconn* conn = m_connection.get();
+        statement_plan plan{};
+        const std::span<const Oid> types{param_detail.types(), static_cast<std::size_t>(param_detail.count())};
+        // Null sends the query unnamed with PQsendQueryParams. execute_many() always runs its sets
+        // through a prepared statement; without the cache that is the unnamed one.
+        const char* name = nullptr;
+        bool prepared = true;
+        if (m_statements.enabled()) {
+            const internal::statement_cache::lookup stmt = m_statements.acquire(param_detail.query(), types);
+            plan.cached = true;
+            if (stmt.evicted) {
+                // Own segment: a failed DEALLOCATE must not abort the request behind it.
+                const std::string deallocate = "DEALLOCATE " + *stmt.evicted;
+                if (PQsendQueryParams(conn, deallocate.c_str(), 0, nullptr, nullptr, nullptr, nullptr, 1) == 0 ||
+                    PQpipelineSync(conn) == 0) {
+                    return std::unexpected(sql_error::BadConnection(PQerrorMessage(conn)));
+                }
+                plan.deallocate = true;
+            }
+            name = stmt.name.c_str();
+            prepared = stmt.prepared;
+        } else if (param_detail.sets() > 1) {
+            name = "";
+            prepared = false;
+        }
+        if (!prepared) {
+            if (PQsendPrepare(conn, name, param_detail.query_c_str(), param_detail.count(), param_detail.types()) == 0) {
+                if (plan.cached)
+                    m_statements.erase(param_detail.query(), types);
+                return std::unexpected(sql_error::BadConnection(PQerrorMessage(conn)));
+            }
+            plan.prepare = true;
+        }
+        int ok = 1;
+        if (name == nullptr) {
+            ok = PQsendQueryParams(
+                conn,
+                param_detail.query_c_str(),
+                param_detail.count(),
+                param_detail.types(),
+                param_detail.values(),
+                param_detail.lengths(),
+                param_detail.formats(),
+                1);
+        }
+        // Every set of a batch shares the one sync below, so they all land in the same segment.
+        for (std::size_t set = 0; name != nullptr && ok != 0 && set < param_detail.sets(); ++set) {
+            ok = PQsendQueryPrepared(
+                conn,
+                name,
+                param_detail.count(),
+                param_detail.values(set),
+                param_detail.lengths(set),
+                param_detail.formats(),
+                1);
+        }
+        if (ok == 0 || PQpipelineSync(conn) == 0) {
+            const char* msg = PQerrorMessage(conn);
+            return std::unexpected(sql_error::BadConnection(msg));
+        }
+        return plan;
+    }
+
+    std::expected<result::unique_pg_result, sql_error> postgres_client::ConsumePipelineResult(const int& socket, const pg_param_detail& param_detail, const statement_plan& plan, row_stream* on_rows, const query_deadline deadline, const bool alone) const noexcept {
+        m_deadline = {.at = deadline, .alone = alone};
+        std::expected<result::unique_pg_result, sql_error> result = ReadPipelineResult(socket, param_detail, plan, on_rows);
+        if (!std::exchange(m_deadline, {}).cancel_sent) {
+            return result;
+        }
+        // Let the cancel land before the next request goes out, or it could hit that one.
+        FinishCancel();
+        return result;
+    }
+
+    // The server answers a cancel by failing the statement with 57014 and the session stays in
+    // sync, so that failure is reported as the timeout it is. Any other error, even one that
+    // arrives after the cancel was sent, is passed on unchanged.
+    void postgres_client::ReportCancelled(command_outcome& outcome) noexcept {
+        if (outcome.cancelled && outcome.error) {
+            outcome.error = sql_error::QueryTimedOut("query cancelled after its deadline passed");
+        }
+    }
+
+    std::expected<result::unique_pg_result, sql_error> postgres_client::ReadPipelineResult(const int& socket, const pg_param_detail& param_detail, const statement_plan& plan, row_stream* on_rows) const noexcept {
+        if (plan.deallocate) {
+            if (auto read = ReadEvictedDeallocate(socket); !read)
+                return std::unexpected(read.error());
+        }
+
+        command_outcome outcome{};
+        if (plan.prepare) {
+            if (auto read = ReadCommand(socket, outcome); !read)
+                return std::unexpected(read.error());
+            outcome.result = nullptr;
+            outcome.stale_statement = outcome.stale_statement || outcome.error.has_value();
+        }
+        outcome.gather = !on_rows && HasResultLimits();
+        // Must happen before anything parses this command's first row.
+        if ((on_rows || outcome.gather) && !EnterStreamingMode())
+            return std::unexpected(sql_error::BadConnection("failed to enter single-row mode"));
+        if (auto read = ReadCommand(socket, outcome, on_rows); !read)
+            return std::unexpected(read.error());
+        if (auto sync = ReadPipelineSync(socket); !sync)
+            return std::unexpected(sync.error());
+        if (m_deadline.cancel_sent)
+            ReportCancelled(outcome);
+        return FinishCommand(param_detail, plan, std::move(outcome));
+    }
+
+    // The results of an execute_many() batch: its PREPARE, one command per parameter set, then
+    // the single sync. Failed items are tallied rather than returned; only a broken connection
+    // ends the read early.
+    std::expected<void, sql_error> postgres_client::ReadBatchResult(const int& socket, const pg_param_detail& param_detail, const statement_plan& plan, batch_tally& tally) const noexcept {
+        if (plan.deallocate) {
+            if (auto read = ReadEvictedDeallocate(socket); !read)
+                return read;
+        }
+        if (plan.prepare) {
+            command_outcome prepared{};
+            if (auto read = ReadCommand(socket, prepared); !read)
+                return read;
+            TallyBatchPrepare(tally, std::move(prepared));
+        }
+        for (std::size_t set = 0; set < param_detail.sets(); ++set) {
+            command_outcome outcome{};
+            if (auto read = ReadCommand(socket, outcome); !read)
+                return read;
+            TallyBatchItem(tally, std::move(outcome));
+        }
+        return ReadPipelineSync(socket);
+    }
+
+    // The DEALLOCATE of an evicted statement and its own sync; its outcome doesn't matter.
+    std::expected<void, sql_error> postgres_client::ReadEvictedDeallocate(const int& socket) const noexcept {
+        command_outcome ignored{};
+        if (auto read = ReadCommand(socket, ignored); !read)
+            return read;
+        return ReadPipelineSync(socket);
+    }
+
+    void postgres_client::TallyBatchPrepare(batch_tally& tally, command_outcome&& outcome) noexcept {
+        if (!outcome.error)
+            return;
+        // Every item behind a failed PREPARE only reports the abort, so this is the batch's error.
+        tally.stale_statement = true;
+        tally.failure = std::move(outcome.error);
+    }
+
+    void postgres_client::TallyBatchItem(batch_tally& tally, command_outcome&& outcome) noexcept {
+        const std::size_t index = tally.items++;
+        tally.stale_statement = tally.stale_statement || outcome.stale_statement;
+        if (outcome.error) {
+            tally.summary.errors.push_back({index, std::move(*outcome.error)});
+        } else if (outcome.result) {
+            tally.summary.affected_rows += result::table{std::move(outcome.result)}.affected_rows();
+        }
+    }
+
+    std::expected<result::unique_pg_result, sql_error> postgres_client::FinishBatch(const pg_param_detail& param_detail, const statement_plan& plan, batch_tally& tally) const noexcept {
+        if (plan.cached && tally.stale_statement) {
+            m_statements.erase(param_detail.query(), {param_detail.types(), static_cast<std::size_t>(param_detail.count())});
+        }
+        if (tally.failure) {
+            return std::unexpected(std::move(*tally.failure));
+        }
+        if (!tally.summary.errors.empty()) {
+            // The failed item rolled back the ones before it.
+            tally.summary.affected_rows = 0;
+        }
+        // The summary stays in the tally for CompleteRequest.
+        return result::unique_pg_result{};
+    }
+
+    std::expected<result::unique_pg_result, sql_error> postgres_client::FinishCommand(const pg_param_detail& param_detail, const statement_plan& plan, command_outcome&& outcome) const noexcept {
+        if (plan.cached && outcome.stale_statement) {
+            // Re-prepared on next use.
+            m_statements.erase(param_detail.query(), {param_detail.types(), static_cast<std::size_t>(param_detail.count())});
+        }
+        if (outcome.error) {
+            return std::unexpected(std::move(*outcome.error));
+        }
+        if (!outcome.result) {
+            return std::unexpected(sql_error::QueryFailed("no results received"));
+        }
+        return std::move(outcome.result);
+    }
+
+    std::expected<void, sql_error> postgres_client::ReadCommand(const int& socket, command_outcome& outcome, row_stream* on_rows) const noexcept {
+        while (true) {
+            if (auto ready = AwaitResult(socket); !ready) {
+                return std::unexpected(ready.error());
+            }
+            PGresult* r = PQgetResult(m_connection.get());
+            if (!r)
+                return {}; // end of this command's results
+            AbsorbResult(outcome, result::unique_pg_result(r), on_rows);
+            if (outcome.over_limit && !m_deadline.cancel_sent && m_deadline.alone) {
+                // Stops the server sending the rest; the rows that still come are dropped. With
+                // requests pipelined behind, the cancel could hit one of them, so they're only read.
+                m_deadline.cancel_sent = true;
+                m_cancel.start(m_connection.get());
+            }
+        }
+    }
+
+    void postgres_client::AbsorbResult(command_outcome& outcome, result::unique_pg_result&& res, row_stream* on_rows) const noexcept {
+        const auto st = PQresultStatus(res.get());
+        if (IsStreamedBatch(st) && outcome.gather) {
+            GatherRows(outcome, res.get());
+        } else if (IsStreamedBatch(st)) {
+            if (!on_rows || outcome.error)
+                return; // the caller gave up on this stream; drain the rest
+            try {
+                on_rows->push(result::table{std::move(res), m_memory});
+            } catch (...) {
+                outcome.error = sql_error::QueryFailed("row batch callback threw");
+            }
+        } else if (st == PGRES_TUPLES_OK || st == PGRES_COMMAND_OK) {
+            if (!outcome.result && !outcome.error)
+                outcome.result = std::move(res);
+        } else if (st == PGRES_PIPELINE_ABORTED) {
+            if (!outcome.error)
+                outcome.error = sql_error::QueryFailed("pipeline aborted by an earlier error");
+        } else if (!outcome.error) {
+            outcome.error = sql_error::QueryFailed(PQresultErrorMessage(res.get()));
+            // 26000: the statement is gone (DISCARD/DEALLOCATE ALL by someone else).
+            // 0A000: "cached plan must not change result type" after a schema change.
+            const char* state = PQresultErrorField(res.get(), PG_DIAG_SQLSTATE);
+            const std::string_view sqlstate = state ? state : "";
+            outcome.stale_statement = sqlstate == "26000" || sqlstate == "0A000";
+            outcome.cancelled = sqlstate == "57014";
+        }
+    }
+
+    // Appends a chunk of a gathered command to outcome.result, failing the command once it passes
+    // a limit. The chunks aren't kept, so at most the gathered rows and one chunk are held.
+    void postgres_client::GatherRows(command_outcome& outcome, const PGresult* chunk) const noexcept {
+        if (outcome.error)
+            return;
+        if (!outcome.result)
+            outcome.result.reset(PQcopyResult(chunk, PG_COPYRES_ATTRS));
+        PGresult* gathered = outcome.result.get();
+        const int base = gathered ? PQntuples(gathered) : 0;
+        const int rows = PQntuples(chunk);
+        const int cols = PQnfields(chunk);
+        bool copied = gathered != nullptr;
+        for (int r = 0; copied && r < rows; ++r) {
+            for (int c = 0; copied && c < cols; ++c) {
+                const bool null = PQgetisnull(chunk, r, c);
+                copied = PQsetvalue(gathered, base + r, c, null ? nullptr : PQgetvalue(chunk, r, c),
+                                    null ? -1 : PQgetlength(chunk, r, c)) == 1;
+            }
+        }
+        if (!copied) {
+            outcome.result = nullptr;
+            outcome.error = sql_error::QueryFailed("out of memory gathering result rows");
+            return;
+        }
+
+        const auto total_rows = static_cast<std::size_t>(base + rows);
+        const std::size_t bytes = PQresultMemorySize(gathered);
+        const char* exceeded = nullptr;
+        if (m_config.max_result_rows != 0 && total_rows > m_config.max_result_rows)
+            exceeded = "result has more rows than max_result_rows";
+        else if (m_config.max_result_bytes != 0 && bytes > m_config.max_result_bytes)
+            exceeded = "result is larger than max_result_bytes";
+        else if (m_config.result_memory_budget != 0 && m_memory->current() + bytes > m_config.result_memory_budget)
+            exceeded = "result would exceed result_memory_budget";
+        if (exceeded) {
+            outcome.result = nullptr;
+            outcome.error = sql_error::ResultTooLarge(exceeded);
+            outcome.over_limit = true;
+        }
+    }
+
+    bool postgres_client::HasResultLimits() const noexcept {
+        return m_config.max_result_bytes != 0 || m_config.max_result_rows != 0 || m_config.result_memory_budget != 0;
+    }
+
+    std::expected<void, sql_error> postgres_client::ReadPipelineSync(const int& socket) const noexcept {
+        if (auto ready = AwaitResult(socket); !ready) {
+            return std::unexpected(ready.error());
+        }
+        const result::unique_pg_result sync(PQgetResult(m_connection.get()));
+        if (!sync || PQresultStatus(sync.get()) != PGRES_PIPELINE_SYNC) {
+            return std::unexpected(sql_error::BadConnection("pipeline out of sync"));
+        }
+        return {};
+    }
+
+    bool postgres_client::EnterStreamingMode() const noexcept {
+#ifdef LIBPQ_HAS_CHUNK_MODE
+        if (m_config.stream_chunk_rows > 1)
+            return PQsetChunkedRowsMode(m_connection.get(), m_config.stream_chunk_rows) == 1;
+#endif
+        return PQsetSingleRowMode(m_connection.get()) == 1;
+    }
+
+    bool postgres_client::IsSessionIdle() const noexcept {
+        // A timed out request can leave the connection mid-pipeline or mid-COPY with results
+        // still pending.
+        return is_connected() &&
+               PQpipelineStatus(m_connection.get()) == PQ_PIPELINE_OFF &&
+               PQtransactionStatus(m_connection.get()) != PQTRANS_ACTIVE;
     }
 
     std::optional<sql_error> postgres_client::AttemptReconnect(const std::chrono::milliseconds timeout) const noexcept {
+        // Server-side prepared statements die with the old session.
+        m_statements.clear();
         if (!PQresetStart(m_connection.get()))
             return sql_error::FailedToReconnect("PQresetStart failed");
 
@@ -276,8 +968,10 @@ namespace database {
             if (flush == 0)
                 return {};
 
-            pollfd pfd = {socket, POLLOUT, 0};
-            const int poll_res = poll(&pfd, 1, 5000);
+            // Keep reading while we wait to write: with a deep pipeline the server may stop
+            // consuming our input until we drain the results it has already produced.
+            pollfd pfd = {socket, POLLOUT | POLLIN, 0};
+            const int poll_res = poll(&pfd, 1, static_cast<int>(kSocketTimeout.count()));
             if (poll_res < 0) {
                 return std::unexpected(sql_error::SocketFailed("Pollout event failed"));
             }
@@ -287,52 +981,59 @@ namespace database {
             if ((pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
                 return std::unexpected(sql_error::SocketFailed("Socket failed"));
             }
+            if ((pfd.revents & POLLIN) != 0 && PQconsumeInput(m_connection.get()) == 0) {
+                const char* err = PQerrorMessage(m_connection.get());
+                return std::unexpected(sql_error::BadConnection(err));
+            }
         }
     }
 
-    std::expected<void, sql_error> postgres_client::CheckForPollIn(const int& socket) const noexcept {
-        while (true) {
-            pollfd pfd = {socket, POLLIN, 0};
-            const int poll_res = poll(&pfd, 1, 5000);
+    std::expected<void, sql_error> postgres_client::AwaitResult(const int& socket) const noexcept {
+        // Checks the buffered input before polling: in a pipeline the results of later
+        // requests have usually arrived already together with earlier ones.
+        while (PQisBusy(m_connection.get())) {
+            auto timeout = kSocketTimeout;
+            const bool timed = m_deadline.at != no_deadline && !m_deadline.cancel_sent;
+            if (timed) {
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= m_deadline.at) {
+                    // Keep reading: the cancelled statement still ends with an error and a sync.
+                    m_deadline.cancel_sent = true;
+                    m_cancel.start(m_connection.get());
+                    continue;
+                }
+                timeout = std::chrono::ceil<std::chrono::milliseconds>(m_deadline.at - now);
+            }
+            // While a non-blocking cancel is being delivered its socket is served here as well.
+            std::array<pollfd, 2> pfds = {{{socket, POLLIN, 0}, {m_cancel.socket(), m_cancel.events(), 0}}};
+            const int poll_res = poll(pfds.data(), m_cancel.in_progress() ? 2 : 1, static_cast<int>(std::min<std::int64_t>(timeout.count(), INT_MAX)));
             if (poll_res < 0) {
                 return std::unexpected(sql_error::SocketFailed("failed to poll socket"));
             }
             if (poll_res == 0) {
+                if (timed)
+                    continue;
                 return std::unexpected(sql_error::SocketFailed("socket timed out"));
             }
-
-            if (PQconsumeInput(m_connection.get()) == 0) {
+            if (pfds[1].revents != 0) {
+                m_cancel.advance();
+            }
+            if (pfds[0].revents != 0 && PQconsumeInput(m_connection.get()) == 0) {
                 const char* err = PQerrorMessage(m_connection.get());
                 return std::unexpected(sql_error::BadConnection(err));
             }
-
-            if (PQisBusy(m_connection.get())) {
-                continue;
-            }
-            return {};
         }
+        return {};
     }
 
-    std::expected<result::unique_pg_result, sql_error> postgres_client::ConsumeResult() const noexcept {
-        result::unique_pg_result result = nullptr;
-        while (PGresult* r = PQgetResult(m_connection.get())) {
-            result::unique_pg_result temp(r);
-            const auto st = PQresultStatus(temp.get());
-            if (st == PGRES_TUPLES_OK || st == PGRES_COMMAND_OK) {
-                if (!result)
-                    result = std::move(temp);
-            } else {
-                // Make sure we drain remaining results before returning error (optional but clean)
-                std::string msg = PQresultErrorMessage(temp.get());
-                sql_error err = sql_error::QueryFailed(PQresultErrorMessage(temp.get()));
-                while (PGresult* r2 = PQgetResult(m_connection.get()))
-                    PQclear(r2);
-                return std::unexpected(std::move(err));
+    void postgres_client::FinishCancel() const noexcept {
+        while (m_cancel.in_progress()) {
+            pollfd pfd = {m_cancel.socket(), m_cancel.events(), 0};
+            if (poll(&pfd, 1, static_cast<int>(kSocketTimeout.count())) <= 0) {
+                m_cancel.reset();
+                return;
             }
+            m_cancel.advance();
         }
-        if (!result) {
-            return std::unexpected(sql_error::QueryFailed("no results received"));
-        }
-        return std::move(result);
     }
 }
@@ -7,42 +7,71 @@
 namespace database {
     std::shared_ptr<transaction> postgres_client::create_transaction() {
         auto txn = std::make_shared<transaction>(*this);
-        std::future<std::expected<result::table, sql_error>> begin_future = txn->execute("BEGIN");
+        query_future<std::expected<result::table, sql_error>> begin_future = txn->execute("BEGIN");
         if (const std::expected<result::table, sql_error> result = begin_future.get(); !result) {
             return nullptr;
         }
         return txn;
     }
 
+    copy_writer postgres_client::copy_in(const std::string_view table, const std::initializer_list<std::string_view> columns) const {
+        std::string copy_cmd = std::format("COPY {}", table);
+        if (columns.size() > 0) {
+            copy_cmd += " (";
+            bool first = true;
+            for (const std::string_view column : columns) {
+                if (!first)
+                    copy_cmd += ", ";
+                copy_cmd += column;
+                first = false;
+            }
+            copy_cmd += ')';
+        }
+        copy_cmd += " FROM STDIN (FORMAT binary)";
+
+        auto channel = std::make_shared<internal::copy_in_channel>(copy_writer::kMaxPendingChunks, m_config.copy_idle_timeout);
+        query_request request{pg_param_detail{copy_cmd, 0}};
+        request.copy_in = channel;
+        auto done = SendCopyToWorker(std::move(request));
+        return copy_writer{std::move(channel), std::move(done)};
+    }
+
+    query_future<std::expected<std::size_t, sql_error>> postgres_client::copy_out(const std::string_view source, copy_sink sink) const {
+        const std::string copy_cmd = std::format("COPY {} TO STDOUT (FORMAT binary)", source);
+        query_request request{pg_param_detail{copy_cmd, 0}};
+        request.copy_out = std::move(sink);
+        return SendCopyToWorker(std::move(request));
+    }
+
     postgres_client::postgres_client(std::string&& uri, const std::size_t num_cb_threads)
-    : m_uri(std::move(uri)),
-      m_num_cb_threads(num_cb_threads)
+    : postgres_client(std::move(uri), ClientConfig{.num_cb_threads = num_cb_threads})
     {}
 
     postgres_client::postgres_client(std::string&& uri, const bool heartbeat_enabled, const std::size_t num_cb_threads)
+    : postgres_client(std::move(uri), ClientConfig{.num_cb_threads = num_cb_threads, .heartbeat_enabled = heartbeat_enabled})
+    {}
+
+    postgres_client::postgres_client(std::string&& uri, const ClientConfig& config)
     : m_uri(std::move(uri)),
-      m_heartbeat_enabled(heartbeat_enabled),
-      m_num_cb_threads(num_cb_threads)
+      m_config(config),
+      m_statements(config.statement_cache_size),
+      m_memory(config.result_memory ? config.result_memory : std::make_shared<result::memory_tracker>())
     {}
 
     postgres_client::~postgres_client() {
+        if (m_loop) {
+            // The reactor must be done with the connection before it is closed.
+            DetachFromLoop();
+            return;
+        }
         // Stop the DB worker first — it may still post to the callback queue during drain.
         m_worker_thread.request_stop();
-        m_cv.notify_all();
+        m_worker_parker.unpark();
         if (m_worker_thread.joinable())
             m_worker_thread.join();
 
         // Stop all callback workers — all pending callbacks are now in the queue.
-        {
-            std::lock_guard lk(m_temp_cb_mutex);
-            reap_overflow_threads(m_overflow_cb_threads);
-            m_overflow_cb_threads.clear();
-        }
-        for (auto& w : m_cb_workers)
-            w.request_stop();
-        m_cb_cv.notify_all();
-        for (auto& w : m_cb_workers)
-            if (w.joinable()) w.join();
+        m_callbacks.stop();
     }
 
     std::expected<void, Core::Database::ConnectionError> postgres_client::connect() noexcept {
@@ -59,10 +88,12 @@ namespace database {
             return std::unexpected(ConnectionError::SocketFailed(PQerrorMessage(unique_conn.get())));
         }
         m_connection = std::move(unique_conn);
+        if (m_config.loop) {
+            AttachToLoop();
+            return {};
+        }
         m_worker_thread = std::jthread([this](const std::stop_token& st) { QueryWorker(st); });
-        m_cb_workers.reserve(m_num_cb_threads);
-        for (std::size_t i = 0; i < m_num_cb_threads; ++i)
-            m_cb_workers.emplace_back([this](const std::stop_token& st) { CallbackWorker(st); });
+        m_callbacks.start(m_config.num_cb_threads);
         return {};
     }
 
@@ -0,0 +1,77 @@
+//
+// Created by Shinnosuke Kawai on 4/20/26.
+//
+#include "database/internal/query_cancel.h"
+#include <array>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/poll.h>
+#endif
+
+namespace database::internal {
+    bool query_cancel::send(PGcancel* cancel) noexcept {
+        if (cancel == nullptr)
+            return false;
+        std::array<char, 256> errbuf{};
+        const bool sent = PQcancel(cancel, errbuf.data(), static_cast<int>(errbuf.size())) == 1;
+        PQfreeCancel(cancel);
+        return sent;
+    }
+
+#ifdef LIBPQ_HAS_ASYNC_CANCEL
+    bool query_cancel::start(PGconn* conn) noexcept {
+        reset();
+        m_conn = PQcancelCreate(conn);
+        if (m_conn == nullptr)
+            return false;
+        if (PQcancelStart(m_conn) == 0) {
+            reset();
+            return false;
+        }
+        // As after PQconnectStart(): wait for the socket to become writable first.
+        m_events = POLLOUT;
+        return true;
+    }
+
+    bool query_cancel::advance() noexcept {
+        if (m_conn == nullptr)
+            return false;
+        switch (PQcancelPoll(m_conn)) {
+            case PGRES_POLLING_READING:
+                m_events = POLLIN;
+                return true;
+            case PGRES_POLLING_WRITING:
+                m_events = POLLOUT;
+                return true;
+            default:
+                // Delivered or failed; either way there is nothing left to do.
+                reset();
+                return false;
+        }
+    }
+
+    void query_cancel::reset() noexcept {
+        if (m_conn != nullptr)
+            PQcancelFinish(m_conn);
+        m_conn = nullptr;
+        m_events = 0;
+    }
+
+    bool query_cancel::in_progress() const noexcept { return m_conn != nullptr; }
+
+    int query_cancel::socket() const noexcept { return m_conn != nullptr ? PQcancelSocket(m_conn) : -1; }
+#else
+    bool query_cancel::start(PGconn* conn) noexcept {
+        return send(PQgetCancel(conn));
+    }
+
+    bool query_cancel::advance() noexcept { return false; }
+
+    void query_cancel::reset() noexcept {}
+
+    bool query_cancel::in_progress() const noexcept { return false; }
+
+    int query_cancel::socket() const noexcept { return -1; }
+#endif
+}
@@ -13,6 +13,7 @@ namespace database {
         m_executor = other.m_executor;
         other.m_executor = nullptr;
         m_state = other.m_state;
+        m_cursors = other.m_cursors;
     }
 
     transaction::~transaction() {
@@ -24,7 +25,7 @@ namespace database {
         lock.unlock();
 
         pg_param_detail rollback_cmd("ROLLBACK", 0);
-        auto future = m_executor->SendToWorker(std::move(rollback_cmd));
+        auto future = m_executor->SendToWorker(std::move(rollback_cmd), no_deadline);
         auto result = future.get();
         if (!result) {
             std::println(stderr, "{}", result.error().to_str());
@@ -40,7 +41,7 @@ namespace database {
         m_state = state::commit;
         sl.unlock();
         pg_param_detail commit("COMMIT", 0);
-        auto commit_future = m_executor->SendToWorker(std::move(commit));
+        auto commit_future = m_executor->SendToWorker(std::move(commit), no_deadline);
         if (auto result = commit_future.get(); !result) {
             std::println(stderr, "{}", result.error().to_str());
         }
@@ -54,7 +55,7 @@ namespace database {
         m_state = state::rollback;
         sl.unlock();
         pg_param_detail rollback("ROLLBACK", 0);
-        auto rollback_future = m_executor->SendToWorker(std::move(rollback));
+        auto rollback_future = m_executor->SendToWorker(std::move(rollback), no_deadline);
         if (auto result = rollback_future.get(); !result) {
             std::println(stderr, "{}", result.error().to_str());
         }
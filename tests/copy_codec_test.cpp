@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <database/copy.h>
+
+using database::internal::copy_out_decoder;
+
+namespace {
+    using row_type = std::tuple<std::optional<int32_t>, std::optional<std::string>, std::optional<double>>;
+
+    // Same framing the server sends for COPY ... TO STDOUT (FORMAT binary).
+    std::string EncodeRows(const std::vector<std::array<database::supported_type, 3>>& rows) {
+        std::string out;
+        database::internal::AppendCopyHeader(out);
+        for (const auto& row : rows) {
+            out += database::internal::EncodeFixed(std::int16_t{3});
+            for (const auto& field : row)
+                database::internal::AppendCopyField(out, field);
+        }
+        database::internal::AppendCopyTrailer(out);
+        return out;
+    }
+
+    std::span<const std::byte> AsBytes(const std::string_view s) {
+        return {reinterpret_cast<const std::byte*>(s.data()), s.size()};
+    }
+
+    std::vector<std::array<database::supported_type, 3>> SampleRows() {
+        return {
+            {int32_t{1}, std::string{"one"}, 1.5},
+            {int32_t{2}, nullptr, -2.25},
+            {nullptr, std::string{}, nullptr},
+        };
+    }
+}
+
+TEST(CopyCodecTest, DecodesWholeStream) {
+    std::vector<row_type> rows;
+    copy_out_decoder<int32_t, std::string, double> decoder([&rows](row_type row) { rows.push_back(std::move(row)); });
+    const std::string stream = EncodeRows(SampleRows());
+    ASSERT_TRUE(decoder.feed(AsBytes(stream)));
+
+    ASSERT_EQ(rows.size(), 3);
+    EXPECT_EQ(std::get<0>(rows[0]), 1);
+    EXPECT_EQ(std::get<1>(rows[0]), "one");
+    EXPECT_EQ(std::get<2>(rows[0]), 1.5);
+    EXPECT_FALSE(std::get<1>(rows[1]));
+    EXPECT_EQ(std::get<2>(rows[1]), -2.25);
+    EXPECT_FALSE(std::get<0>(rows[2]));
+    EXPECT_EQ(std::get<1>(rows[2]), "");
+    EXPECT_FALSE(std::get<2>(rows[2]));
+}
+
+TEST(CopyCodecTest, DecodesByteAtATime) {
+    std::vector<row_type> rows;
+    copy_out_decoder<int32_t, std::string, double> decoder([&rows](row_type row) { rows.push_back(std::move(row)); });
+    const std::string stream = EncodeRows(SampleRows());
+    for (std::size_t i = 0; i < stream.size(); ++i)
+        ASSERT_TRUE(decoder.feed(AsBytes(std::string_view{stream}.substr(i, 1))));
+    ASSERT_EQ(rows.size(), 3);
+    EXPECT_EQ(std::get<1>(rows[0]), "one");
+}
+
+TEST(CopyCodecTest, RejectsBadSignature) {
+    copy_out_decoder<int32_t> decoder([](auto) {});
+    const std::string stream(32, 'x');
+    const auto fed = decoder.feed(AsBytes(stream));
+    ASSERT_FALSE(fed);
+    EXPECT_EQ(fed.error().get_type(), database::sql_error::type::CopyFailed);
+}
+
+TEST(CopyCodecTest, RejectsFieldCountMismatch) {
+    copy_out_decoder<int32_t, std::string> decoder([](auto) {});
+    const std::string stream = EncodeRows(SampleRows());
+    const auto fed = decoder.feed(AsBytes(stream));
+    ASSERT_FALSE(fed);
+    EXPECT_EQ(fed.error().get_type(), database::sql_error::type::CopyFailed);
+}
+
+TEST(CopyCodecTest, RejectsUndecodableField) {
+    // A text field requested as int32 has the wrong width.
+    copy_out_decoder<int32_t, int32_t, double> decoder([](auto) {});
+    const std::string stream = EncodeRows(SampleRows());
+    const auto fed = decoder.feed(AsBytes(stream));
+    ASSERT_FALSE(fed);
+    EXPECT_EQ(fed.error().get_type(), database::sql_error::type::CopyFailed);
+}
+
+TEST(CopyCodecTest, DecodesIntoArrowBatches) {
+    struct batch {
+        int64_t length;
+        std::vector<int32_t> ids;
+        std::vector<bool> id_valid;
+        std::string first_name;
+    };
+    std::vector<batch> batches;
+    std::string schema_format;
+    database::internal::copy_out_arrow_decoder<int32_t, std::string, double> decoder(
+        {"id", "name"}, 2, [&](ArrowSchema* schema, ArrowArray* array) -> std::expected<void, database::sql_error> {
+            schema_format = schema->children[2]->format + std::string{"/"} + schema->children[2]->name;
+            batch b{array->length};
+            const ArrowArray* ids = array->children[0];
+            const auto* bits = static_cast<const uint8_t*>(ids->buffers[0]);
+            for (int64_t i = 0; i < array->length; ++i) {
+                b.ids.push_back(static_cast<const int32_t*>(ids->buffers[1])[i]);
+                b.id_valid.push_back(bits == nullptr || (bits[i / 8] >> (i % 8) & 1));
+            }
+            const auto* offsets = static_cast<const int32_t*>(array->children[1]->buffers[1]);
+            b.first_name.assign(static_cast<const char*>(array->children[1]->buffers[2]) + offsets[0], offsets[1] - offsets[0]);
+            batches.push_back(std::move(b));
+            return {};
+        });
+    const std::string stream = EncodeRows(SampleRows());
+    ASSERT_TRUE(decoder.feed(AsBytes(stream)));
+
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(schema_format, "g/f2");
+    EXPECT_EQ(batches[0].length, 2);
+    EXPECT_EQ(batches[0].ids, (std::vector<int32_t>{1, 2}));
+    EXPECT_EQ(batches[0].first_name, "one");
+    EXPECT_EQ(batches[1].length, 1);
+    EXPECT_EQ(batches[1].id_valid, (std::vector<bool>{false}));
+}
+
+TEST(CopyCodecTest, ChannelTimesOutIdleWriter) {
+    using database::internal::copy_in_channel;
+    copy_in_channel channel(4, std::chrono::milliseconds(50));
+    std::string chunk;
+    ASSERT_TRUE(channel.push("data"));
+    EXPECT_EQ(channel.pop(chunk, {}), copy_in_channel::pop_status::chunk);
+    EXPECT_EQ(channel.try_pop(chunk), std::nullopt);
+    EXPECT_LT(channel.idle_deadline(), copy_in_channel::clock::time_point::max());
+    EXPECT_EQ(channel.pop(chunk, {}), copy_in_channel::pop_status::timed_out);
+    EXPECT_EQ(channel.try_pop(chunk), copy_in_channel::pop_status::timed_out);
+
+    copy_in_channel patient(4);
+    patient.close(false);
+    EXPECT_EQ(patient.idle_deadline(), copy_in_channel::clock::time_point::max());
+    EXPECT_EQ(patient.pop(chunk, {}), copy_in_channel::pop_status::finished);
+}
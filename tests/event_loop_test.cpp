@@ -0,0 +1,131 @@
+#include <future>
+#include <gtest/gtest.h>
+#include <database/event_loop.h>
+#ifndef _WIN32
+#include <sys/poll.h>
+#include <unistd.h>
+#endif
+
+using database::event_loop;
+
+TEST(EventLoopTest, PostedTasksRunInOrderOnReactorThread) {
+    event_loop loop;
+    event_loop::reactor& reactor = loop.assign();
+    EXPECT_FALSE(reactor.in_loop_thread());
+
+    std::vector<int> order;
+    std::promise<bool> done;
+    for (int i = 0; i < 100; ++i)
+        reactor.post([&order, i] { order.push_back(i); });
+    reactor.post([&] { done.set_value(reactor.in_loop_thread()); });
+    EXPECT_TRUE(done.get_future().get());
+
+    ASSERT_EQ(order.size(), 100);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(order[i], i);
+}
+
+TEST(EventLoopTest, TimersFireInDeadlineOrderAndCancel) {
+    event_loop loop;
+    event_loop::reactor& reactor = loop.assign();
+    std::vector<int> fired;
+    std::promise<void> done;
+    reactor.post([&] {
+        const auto now = std::chrono::steady_clock::now();
+        reactor.run_at(now + std::chrono::milliseconds(30), [&] { fired.push_back(3); });
+        reactor.run_at(now + std::chrono::milliseconds(10), [&] { fired.push_back(1); });
+        const auto cancelled = reactor.run_at(now + std::chrono::milliseconds(20), [&] { fired.push_back(2); });
+        reactor.cancel(cancelled);
+        reactor.run_at(now + std::chrono::milliseconds(40), [&] { done.set_value(); });
+    });
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(fired, (std::vector{1, 3}));
+}
+
+TEST(EventLoopTest, AssignsReactorsRoundRobin) {
+    event_loop loop(database::EventLoopConfig{.num_threads = 3});
+    EXPECT_EQ(loop.size(), 3);
+    event_loop::reactor* first = &loop.assign();
+    EXPECT_NE(&loop.assign(), first);
+    EXPECT_NE(&loop.assign(), first);
+    EXPECT_EQ(&loop.assign(), first);
+}
+
+TEST(EventLoopTest, CallbacksRunOffReactor) {
+    event_loop loop;
+    event_loop::reactor& reactor = loop.assign();
+    std::promise<bool> on_reactor;
+    loop.post_callback([&] { on_reactor.set_value(reactor.in_loop_thread()); });
+    EXPECT_FALSE(on_reactor.get_future().get());
+}
+
+#ifndef _WIN32
+TEST(EventLoopTest, WatchReportsReadableFd) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    event_loop loop;
+    event_loop::reactor& reactor = loop.assign();
+
+    std::promise<std::string> received;
+    reactor.post([&] {
+        reactor.watch(fds[0], POLLIN, [&](const short revents) {
+            EXPECT_TRUE(revents & POLLIN);
+            char buf[16];
+            const auto n = read(fds[0], buf, sizeof(buf));
+            reactor.unwatch(fds[0]);
+            received.set_value(std::string(buf, n > 0 ? n : 0));
+        });
+    });
+    ASSERT_EQ(write(fds[1], "ping", 4), 4);
+    auto got = received.get_future();
+    ASSERT_EQ(got.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(got.get(), "ping");
+
+    // Unwatched: further data is not reported.
+    std::promise<void> flushed;
+    ASSERT_EQ(write(fds[1], "more", 4), 4);
+    reactor.post([&] { flushed.set_value(); });
+    flushed.get_future().wait();
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+TEST(EventLoopTest, LastReferenceDroppedOnOwnThread) {
+    // Each task waits until the test has let go, so it holds the last reference.
+    auto loop = std::make_shared<event_loop>();
+    std::promise<void> released;
+    std::promise<void> reactor_done;
+    loop->assign().post([&, held = loop]() mutable {
+        released.get_future().wait();
+        held.reset();
+        reactor_done.set_value();
+    });
+    loop.reset();
+    released.set_value();
+    EXPECT_EQ(reactor_done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+    loop = std::make_shared<event_loop>();
+    std::promise<void> released_again;
+    std::promise<void> callback_done;
+    loop->post_callback([&, held = loop]() mutable {
+        released_again.get_future().wait();
+        held.reset();
+        callback_done.set_value();
+    });
+    loop.reset();
+    released_again.set_value();
+    EXPECT_EQ(callback_done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
+
+TEST(EventLoopTest, CallbackPoolsRunOnlyTheirOwnTasksInline) {
+    event_loop a;
+    event_loop b;
+    std::promise<std::pair<std::thread::id, std::thread::id>> threads;
+    a.post_callback([&] {
+        const std::thread::id outer = std::this_thread::get_id();
+        b.post_callback([&, outer] { threads.set_value({outer, std::this_thread::get_id()}); });
+    });
+    const auto [outer, inner] = threads.get_future().get();
+    EXPECT_NE(outer, inner);
+}
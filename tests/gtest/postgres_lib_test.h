@@ -7,6 +7,7 @@
 #include <gtest/gtest.h>
 #include <database/connection_pool.h>
 #include <database/postgres_client.h>
+#include <coroutine>
 #ifdef _WIN32
 #include <windows.h>
 #include <stdlib.h>
@@ -51,6 +52,18 @@ inline int setenv(const char* name, const char* value, int overwrite)
                      "col_float, col_double, col_text, col_byte, col_ts) " \
                      "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12)"
 
+// Minimal fire-and-forget coroutine for exercising query_awaitable; the tests wait on their
+// own promise for the coroutine to finish.
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
 inline void queries_before_rolled_back(database::shared_transaction& shared_txn, int blocking) {
     constexpr std::string_view insert_query =
             "INSERT INTO test_tables "
@@ -0,0 +1,360 @@
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <database/internal/type_detail.h>
+#include <database/result/colunm.h>
+
+using namespace database;
+namespace pg_oid = database::result::pg_oid;
+
+namespace {
+    // Encodes value as a parameter and reads the same bytes back as a column of type oid.
+    template<typename T>
+    std::optional<T> RoundTrip(const T& value, const Oid oid, std::string& wire) {
+        wire = internal::ToBinary(internal::CreateSingleData(value));
+        return result::colum{oid, wire.data(), static_cast<int>(wire.size()), false}.as<T>();
+    }
+
+    template<typename T>
+    std::optional<T> RoundTrip(const T& value, const Oid oid) {
+        std::string wire;
+        return RoundTrip(value, oid, wire);
+    }
+}
+
+TEST(PgTypesTest, Uuid) {
+    const auto id = uuid::parse("a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11");
+    ASSERT_TRUE(id);
+    EXPECT_EQ(id->to_string(), "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11");
+    EXPECT_EQ(uuid::parse("A0EEBC999C0B4EF8BB6D6BB9BD380A11"), id);
+    EXPECT_FALSE(uuid::parse("a0eebc99"));
+    EXPECT_FALSE(uuid::parse("a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1x"));
+
+    std::string wire;
+    EXPECT_EQ(RoundTrip(*id, pg_oid::Uuid, wire), id);
+    EXPECT_EQ(static_cast<unsigned char>(wire[0]), 0xa0);
+    EXPECT_FALSE(RoundTrip(*id, pg_oid::Text));
+}
+
+TEST(PgTypesTest, JsonbViewsTheText) {
+    std::string wire;
+    const auto back = RoundTrip(jsonb{R"({"a": 1})"}, pg_oid::Jsonb, wire);
+    ASSERT_TRUE(back);
+    EXPECT_EQ(wire[0], '\x01');
+    EXPECT_EQ(back->text, R"({"a": 1})");
+    EXPECT_EQ(back->text.data(), wire.data() + 1);
+
+    const std::string json = "[1,2]";
+    EXPECT_EQ((result::colum{pg_oid::Json, json.data(), 5, false}.as<jsonb>()->text), "[1,2]");
+    const std::string bad_version = "\x02{}";
+    EXPECT_FALSE((result::colum{pg_oid::Jsonb, bad_version.data(), 3, false}.as<jsonb>()));
+}
+
+TEST(PgTypesTest, DateTimeInterval) {
+    using namespace std::chrono;
+    std::string wire;
+    EXPECT_EQ(RoundTrip(sys_days{2000y / 1 / 1}, pg_oid::Date, wire), sys_days{2000y / 1 / 1});
+    EXPECT_EQ(wire, std::string(4, '\0'));
+    EXPECT_EQ(RoundTrip(sys_days{1969y / 7 / 20}, pg_oid::Date), sys_days{1969y / 7 / 20});
+
+    const time_of_day t{hours{13} + minutes{5} + microseconds{7}};
+    EXPECT_EQ(RoundTrip(t, pg_oid::Time), t);
+
+    const interval i{14, -3, seconds{90}};
+    EXPECT_EQ(RoundTrip(i, pg_oid::Interval, wire), i);
+    ASSERT_EQ(wire.size(), 16);
+    EXPECT_EQ(wire[15], '\x0e'); // months last
+}
+
+TEST(PgTypesTest, Inet) {
+    inet v4;
+    v4.address = {192, 168, 0, 1};
+    v4.prefix = 24;
+    std::string wire;
+    EXPECT_EQ(RoundTrip(v4, pg_oid::Inet, wire), v4);
+    EXPECT_EQ(wire, std::string("\x02\x18\x00\x04\xc0\xa8\x00\x01", 8));
+
+    inet v6;
+    v6.af = inet::family::V6;
+    v6.prefix = 64;
+    v6.is_cidr = true;
+    v6.address[0] = 0x20;
+    v6.address[1] = 0x01;
+    EXPECT_EQ(RoundTrip(v6, pg_oid::Cidr), v6);
+}
+
+TEST(PgTypesTest, Ranges) {
+    std::string wire;
+    const range<int32_t> r{1, 10};
+    EXPECT_EQ(RoundTrip(r, pg_oid::Int4Range, wire), r);
+    EXPECT_EQ(wire.size(), 1 + 2 * (4 + 4));
+    EXPECT_EQ(wire[0], '\x02'); // lower inclusive
+
+    const range<int64_t> unbounded{std::nullopt, int64_t{5}, false, true};
+    EXPECT_EQ(RoundTrip(unbounded, pg_oid::Int8Range), unbounded);
+
+    EXPECT_EQ(RoundTrip(range<int32_t>::make_empty(), pg_oid::Int4Range, wire), range<int32_t>::make_empty());
+    EXPECT_EQ(wire, "\x01");
+
+    const range<timestamp> during{timestamp{std::chrono::seconds{1'700'000'000}}, std::nullopt};
+    EXPECT_EQ(RoundTrip(during, pg_oid::TstzRange), during);
+
+    const std::string truncated = "\x02\x00\x00";
+    EXPECT_FALSE((result::colum{pg_oid::Int4Range, truncated.data(), 3, false}.as<range<int32_t>>()));
+}
+
+namespace {
+    // Hand-built wire values, as the server sends them for arrays and records.
+    struct wire_writer {
+        std::string bytes;
+
+        wire_writer& i32(const int32_t v) {
+            bytes += internal::EncodeFixed(v);
+            return *this;
+        }
+        wire_writer& field(const std::string& value) {
+            i32(static_cast<int32_t>(value.size()));
+            bytes += value;
+            return *this;
+        }
+        wire_writer& null() { return i32(-1); }
+
+        result::colum as_column(const Oid oid) const {
+            return result::colum{oid, bytes.data(), static_cast<int>(bytes.size()), false};
+        }
+    };
+
+    wire_writer ArrayHeader(const Oid element, const std::vector<int32_t>& extents, const bool has_nulls = false) {
+        wire_writer w;
+        w.i32(static_cast<int32_t>(extents.size())).i32(has_nulls ? 1 : 0).i32(static_cast<int32_t>(element));
+        for (const auto extent : extents)
+            w.i32(extent).i32(1);
+        return w;
+    }
+
+    constexpr Oid kInt8Array = 1016;
+    constexpr Oid kTextArray = 1009;
+}
+
+TEST(PgTypesTest, ArraysDecodeToVectors) {
+    wire_writer ints = ArrayHeader(pg_oid::Int8, {3});
+    for (const int64_t v : {int64_t{1}, int64_t{-2}, int64_t{1} << 40})
+        ints.field(internal::EncodeFixed(v));
+    EXPECT_EQ(ints.as_column(kInt8Array).as<std::vector<int64_t>>(), (std::vector<int64_t>{1, -2, int64_t{1} << 40}));
+    // Int8 elements don't read as text, and the column must be an array.
+    EXPECT_FALSE(ints.as_column(kInt8Array).as<std::vector<std::string>>());
+    EXPECT_FALSE(ints.as_column(pg_oid::Int8).as<std::vector<int64_t>>());
+
+    wire_writer texts = ArrayHeader(pg_oid::Text, {2, 2}, true);
+    texts.field("a").null().field("").field("dd");
+    const auto column = texts.as_column(kTextArray);
+    EXPECT_FALSE(column.as<std::vector<std::string>>()); // has a NULL
+    const auto optional_texts = column.as<std::vector<std::optional<std::string>>>();
+    ASSERT_TRUE(optional_texts);
+    EXPECT_EQ(*optional_texts, (std::vector<std::optional<std::string>>{"a", std::nullopt, "", "dd"}));
+
+    const auto view = column.as<result::array_view>();
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view->dimensions(), 2);
+    EXPECT_EQ(view->extent(1), 2);
+    EXPECT_EQ(view->size(), 4);
+    std::vector<std::string_view> seen;
+    for (const auto element : *view)
+        seen.push_back(element.as<std::string_view>().value_or("<null>"));
+    EXPECT_EQ(seen, (std::vector<std::string_view>{"a", "<null>", "", "dd"}));
+    EXPECT_EQ(seen[3].data(), texts.bytes.data() + texts.bytes.size() - 2); // no copy
+
+    EXPECT_TRUE(ArrayHeader(pg_oid::Int4, {}).as_column(1007).as<std::vector<int32_t>>()->empty());
+
+    // std::pmr vectors take the vector and its elements from the given resource.
+    std::pmr::monotonic_buffer_resource arena;
+    const auto arena_texts = column.as<std::pmr::vector<std::optional<std::pmr::string>>>(&arena);
+    ASSERT_TRUE(arena_texts);
+    ASSERT_EQ(arena_texts->size(), 4);
+    EXPECT_EQ(arena_texts->get_allocator().resource(), &arena);
+    EXPECT_EQ((*arena_texts)[3], "dd");
+    EXPECT_EQ((*arena_texts)[3]->get_allocator().resource(), &arena);
+    EXPECT_EQ(ints.as_column(kInt8Array).as<std::pmr::vector<int64_t>>(&arena)->back(), int64_t{1} << 40);
+}
+
+TEST(PgTypesTest, MalformedArraysFail) {
+    wire_writer short_data = ArrayHeader(pg_oid::Int4, {2});
+    short_data.field(internal::EncodeFixed(int32_t{1}));
+    EXPECT_FALSE(short_data.as_column(1007).as<result::array_view>());
+
+    wire_writer trailing = ArrayHeader(pg_oid::Int4, {1});
+    trailing.field(internal::EncodeFixed(int32_t{1})).i32(0);
+    EXPECT_FALSE(trailing.as_column(1007).as<std::vector<int32_t>>());
+
+    EXPECT_FALSE(ArrayHeader(pg_oid::Int4, {1 << 30, 1 << 30}).as_column(1007).as<result::array_view>());
+}
+
+TEST(PgTypesTest, RecordsDecodeToTuples) {
+    wire_writer inner = ArrayHeader(pg_oid::Int8, {2});
+    inner.field(internal::EncodeFixed(int64_t{7})).field(internal::EncodeFixed(int64_t{8}));
+
+    wire_writer record;
+    record.i32(4);
+    record.i32(static_cast<int32_t>(pg_oid::Int4)).field(internal::EncodeFixed(int32_t{42}));
+    record.i32(static_cast<int32_t>(pg_oid::Text)).field("name");
+    record.i32(static_cast<int32_t>(pg_oid::Text)).null();
+    record.i32(static_cast<int32_t>(kInt8Array)).field(inner.bytes);
+    const auto column = record.as_column(pg_oid::Record);
+
+    using row = std::tuple<int32_t, std::string, std::optional<std::string>, std::vector<int64_t>>;
+    const auto decoded = column.as<row>();
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(std::get<0>(*decoded), 42);
+    EXPECT_EQ(std::get<1>(*decoded), "name");
+    EXPECT_FALSE(std::get<2>(*decoded));
+    EXPECT_EQ(std::get<3>(*decoded), (std::vector<int64_t>{7, 8}));
+
+    // Field count and types must line up.
+    EXPECT_FALSE((column.as<std::tuple<int32_t, std::string>>()));
+    EXPECT_FALSE((column.as<std::tuple<std::string, std::string, std::optional<std::string>, std::vector<int64_t>>>()));
+    EXPECT_EQ(column.as<result::record_view>()->size(), 4);
+
+    EXPECT_TRUE(result::Decodes<row>(pg_oid::Record));
+    EXPECT_TRUE(result::Decodes<std::vector<std::optional<int64_t>>>(kInt8Array));
+    EXPECT_FALSE(result::Decodes<std::vector<std::string>>(kInt8Array));
+}
+
+TEST(PgTypesTest, ParamsEncodeIntoOneArena) {
+    using namespace std::chrono;
+    const std::array<supported_type, 8> params = {
+        internal::CreateSingleData(std::int32_t{7}), internal::CreateSingleData(nullptr),
+        internal::CreateSingleData("text"), internal::CreateSingleData(std::uint64_t{1'000'000'000'000}),
+        internal::CreateSingleData(range<std::int64_t>{5, std::nullopt}), internal::CreateSingleData(interval{1, 2, seconds{3}}),
+        internal::CreateSingleData(sys_days{2000y / 1 / 2}), internal::CreateSingleData(range<timestamp>::make_empty())
+    };
+    for (const supported_type& param : params)
+        EXPECT_EQ(internal::BinarySize(param), internal::ToBinary(param).size());
+
+    pg_param_detail detail = internal::MakePgParamBuffer("SELECT $1", params);
+    EXPECT_EQ(detail.query(), "SELECT $1");
+    EXPECT_STREQ(detail.query_c_str(), "SELECT $1");
+    ASSERT_EQ(detail.count(), 8);
+    EXPECT_EQ(detail.values()[1], nullptr);
+    EXPECT_EQ(detail.values()[0], detail.query_c_str() + 10);
+    EXPECT_EQ(detail.values()[2], detail.values()[0] + 4);
+    for (int i = 0; i < detail.count(); ++i) {
+        EXPECT_EQ(detail.formats()[i], 1);
+        if (detail.values()[i] != nullptr) {
+            EXPECT_EQ(std::string(detail.values()[i], detail.lengths()[i]), internal::ToBinary(params[i]));
+        }
+    }
+
+    // Short arenas sit inside the string, so a move has to carry the pointers along.
+    pg_param_detail small = internal::MakePgParamBuffer("q", std::array{internal::CreateSingleData("ab")});
+    const pg_param_detail moved = std::move(small);
+    EXPECT_EQ(moved.query(), "q");
+    EXPECT_EQ(moved.values()[0], moved.query_c_str() + 2);
+    EXPECT_EQ(std::string(moved.values()[0], moved.lengths()[0]), "ab");
+
+    std::vector<supported_type> many(pg_param_detail::kInlineParams + 4);
+    for (std::size_t i = 0; i < many.size(); ++i)
+        many[i] = internal::CreateSingleData(static_cast<std::int16_t>(i));
+    const pg_param_detail spilled = internal::MakePgParamBuffer("q", many);
+    ASSERT_EQ(spilled.count(), static_cast<int>(many.size()));
+    EXPECT_EQ(spilled.formats()[many.size() - 1], 1);
+    EXPECT_EQ(spilled.lengths()[many.size() - 1], 2);
+    EXPECT_EQ(spilled.values()[many.size() - 1][1], static_cast<char>(many.size() - 1));
+}
+
+TEST(PgTypesTest, TypedParamsMatchVariantEncoding) {
+    using namespace std::chrono;
+    static_assert(internal::kFixedWidth<internal::param_value_t<std::uint8_t>> == 2);
+    static_assert(internal::kFixedWidth<internal::param_value_t<std::uint64_t>> == 0);
+
+    const std::string text = "abc";
+    const std::vector<std::byte> bytes{std::byte{1}, std::byte{2}};
+    const timestamp ts = sys_days{2024y / 3 / 1} + hours{5};
+    const auto check = [](const pg_param_detail& typed, const pg_param_detail& variant) {
+        ASSERT_EQ(typed.count(), variant.count());
+        EXPECT_EQ(typed.query(), variant.query());
+        for (int i = 0; i < typed.count(); ++i) {
+            ASSERT_EQ(typed.values()[i] == nullptr, variant.values()[i] == nullptr) << i;
+            if (typed.values()[i] == nullptr)
+                continue;
+            EXPECT_EQ(std::string_view(typed.values()[i], typed.lengths()[i]),
+                      std::string_view(variant.values()[i], variant.lengths()[i])) << i;
+        }
+    };
+    check(internal::MakePgParams("q", 1, std::uint32_t{7}, true, 2.5, 1.5f, ts, nullptr, text, "lit", bytes, std::uint64_t{123456789}),
+          internal::MakePgParamBuffer("q", std::array{
+              internal::CreateSingleData(1), internal::CreateSingleData(std::uint32_t{7}), internal::CreateSingleData(true),
+              internal::CreateSingleData(2.5), internal::CreateSingleData(1.5f), internal::CreateSingleData(ts),
+              internal::CreateSingleData(nullptr), internal::CreateSingleData(text), internal::CreateSingleData("lit"),
+              internal::CreateSingleData(bytes), internal::CreateSingleData(std::uint64_t{123456789})}));
+    EXPECT_EQ(internal::MakePgParams("SELECT 1").count(), 0);
+}
+
+TEST(PgTypesTest, ParamsDeclareTheirTypes) {
+    const std::string text = "abc";
+    inet cidr;
+    cidr.is_cidr = true;
+    const pg_param_detail typed = internal::MakePgParams("q", std::int8_t{1}, 2, 3L, std::uint64_t{4}, 1.0, true, text, nullptr,
+                                                          uuid{}, cidr, range<std::int64_t>{});
+    const std::array<Oid, 11> expected{pg_oid::Int2, pg_oid::Int4, pg_oid::Int8, pg_oid::Numeric, pg_oid::Float8, pg_oid::Bool,
+                                       0, 0, pg_oid::Uuid, pg_oid::Cidr, pg_oid::Int8Range};
+    ASSERT_EQ(typed.count(), 11);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), typed.types()));
+
+    const pg_param_detail variant = internal::MakePgParamBuffer("q", std::array{
+        internal::CreateSingleData(std::int8_t{1}), internal::CreateSingleData(nullptr), internal::CreateSingleData(jsonb{"{}"})});
+    EXPECT_EQ(variant.types()[0], pg_oid::Int2);
+    EXPECT_EQ(variant.types()[1], 0);
+    EXPECT_EQ(variant.types()[2], pg_oid::Jsonb);
+}
+
+TEST(PgTypesTest, LargeParamsAreBorrowedOrMoved) {
+    const std::string text(100, 'x');
+    const std::vector<std::byte> blob(10, std::byte{7});
+    std::string big(internal::kAdoptBytes, 'y');
+    const char* big_data = big.data();
+    std::vector<std::byte> big_blob(internal::kAdoptBytes, std::byte{1});
+    const std::byte* big_blob_data = big_blob.data();
+    std::string small = "short";
+
+    pg_param_detail detail = internal::MakePgParams("q", std::string_view{text}, std::span<const std::byte>{blob},
+                                                    std::move(big), std::move(big_blob), std::move(small),
+                                                    std::span<const std::byte>{});
+    const pg_param_detail moved = std::move(detail);
+    EXPECT_EQ(moved.values()[0], text.data());
+    EXPECT_EQ(moved.types()[0], 0);
+    EXPECT_EQ(moved.values()[1], reinterpret_cast<const char*>(blob.data()));
+    EXPECT_EQ(moved.types()[1], pg_oid::Bytea);
+    EXPECT_EQ(moved.values()[2], big_data);
+    EXPECT_EQ(moved.lengths()[2], static_cast<int>(internal::kAdoptBytes));
+    EXPECT_EQ(moved.values()[3], reinterpret_cast<const char*>(big_blob_data));
+    EXPECT_EQ(std::string_view(moved.values()[4], moved.lengths()[4]), "short");
+    EXPECT_EQ(moved.values()[4], moved.query_c_str() + 2);
+    // An empty span is an empty value, not NULL.
+    EXPECT_NE(moved.values()[5], nullptr);
+    EXPECT_EQ(moved.lengths()[5], 0);
+}
+
+TEST(PgTypesTest, BatchSetsShareOneArena) {
+    const std::vector<std::tuple<int32_t, std::string>> rows{{1, "a"}, {2, "bc"}, {3, "def"}};
+    const pg_param_detail detail = internal::MakePgBatch("q", rows);
+    ASSERT_EQ(detail.sets(), 3);
+    ASSERT_EQ(detail.count(), 2);
+    EXPECT_EQ(detail.types()[0], pg_oid::Int4);
+    for (std::size_t set = 0; set < detail.sets(); ++set) {
+        int32_t value = 0;
+        std::memcpy(&value, detail.values(set)[0], sizeof(value));
+        EXPECT_EQ(std::byteswap(value), std::get<0>(rows[set]));
+        EXPECT_EQ(std::string_view(detail.values(set)[1], detail.lengths(set)[1]), std::get<1>(rows[set]));
+    }
+    // Each set follows the one before it in the arena.
+    EXPECT_EQ(detail.values(1)[0], detail.values(0)[1] + 1);
+
+    // Past the inline arrays, and with a type the sets disagree on left to the server.
+    std::vector<std::pair<int64_t, inet>> many(20);
+    many[7].second.is_cidr = true;
+    const pg_param_detail spilled = internal::MakePgBatch("q", many);
+    EXPECT_EQ(spilled.sets(), 20);
+    EXPECT_EQ(spilled.types()[0], pg_oid::Int8);
+    EXPECT_EQ(spilled.types()[1], 0);
+    EXPECT_EQ(spilled.lengths(19)[0], 8);
+    EXPECT_EQ(spilled.formats()[1], 1);
+}
@@ -13,6 +13,10 @@ TEST(PostgresErrTest, GetTypeReturnsCorrectEnum) {
     EXPECT_EQ(E::SocketFailed("x").get_type(),        E::type::SocketFailed);
     EXPECT_EQ(E::QueryFailed("x").get_type(),         E::type::QueryFailed);
     EXPECT_EQ(E::ShuttingDown("x").get_type(),        E::type::ShuttingDown);
+    EXPECT_EQ(E::CopyFailed("x").get_type(),          E::type::CopyFailed);
+    EXPECT_EQ(E::QueryTimedOut("x").get_type(),       E::type::TimeOut);
+    EXPECT_EQ(E::ResultMismatch("x").get_type(),      E::type::ResultMismatch);
+    EXPECT_EQ(E::ResultTooLarge("x").get_type(),      E::type::ResultTooLarge);
 }
 
 TEST(PostgresErrTest, ToStrContainsTypeName) {
@@ -24,6 +28,10 @@ TEST(PostgresErrTest, ToStrContainsTypeName) {
     EXPECT_TRUE(E::SocketFailed("x").to_str().contains("SocketFailed"));
     EXPECT_TRUE(E::QueryFailed("x").to_str().contains("QueryFailed"));
     EXPECT_TRUE(E::ShuttingDown("x").to_str().contains("ShuttingDown"));
+    EXPECT_TRUE(E::CopyFailed("x").to_str().contains("CopyFailed"));
+    EXPECT_TRUE(E::QueryTimedOut("x").to_str().contains("TimeOut"));
+    EXPECT_TRUE(E::ResultMismatch("x").to_str().contains("ResultMismatch"));
+    EXPECT_TRUE(E::ResultTooLarge("x").to_str().contains("ResultTooLarge"));
 }
 
 TEST(PostgresErrTest, ToStrContainsMessage) {
@@ -134,6 +134,550 @@ TEST_F(PostgresLibTest, NestedAsyncQuery_Update) {
     ASSERT_TRUE(result) << result.error().to_str();
 }
 
+TEST_F(PostgresLibTest, PipelinedQueries_ErrorIsolation) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    // Queued back-to-back so the worker sends them as one pipeline batch.
+    constexpr int32_t kQueries = 32;
+    constexpr int32_t kBadQuery = 7;
+    std::vector<database::query_future<std::expected<database::result::table, database::sql_error>>> futures;
+    futures.reserve(kQueries);
+    for (int32_t i = 0; i < kQueries; ++i) {
+        if (i == kBadQuery)
+            futures.emplace_back(client->execute("SELECT * FROM nonexistent_table_xyz"));
+        else
+            futures.emplace_back(client->execute("SELECT $1::int4 AS value", i));
+    }
+
+    for (int32_t i = 0; i < kQueries; ++i) {
+        auto result = futures[i].get();
+        if (i == kBadQuery) {
+            ASSERT_FALSE(result);
+            EXPECT_EQ(result.error().get_type(), database::sql_error::type::QueryFailed);
+            continue;
+        }
+        ASSERT_TRUE(result) << result.error().to_str();
+        ASSERT_EQ(result.value().size(), 1);
+        EXPECT_EQ(result.value().rows()[0]["value"].as<int32_t>(), i);
+    }
+}
+
+TEST_F(PostgresLibTest, PreparedStatementCache_EvictsAndDeallocates) {
+    std::optional<std::string> url = database::GetDatabaseUrl();
+    ASSERT_TRUE(url);
+    database::postgres_client client(std::move(*url), database::ClientConfig{.statement_cache_size = 2});
+    auto connected = client.connect();
+    ASSERT_TRUE(connected) << connected.error().to_str();
+
+    for (int round = 0; round < 2; ++round) {
+        for (int32_t i = 0; i < 3; ++i) {
+            const std::string query = std::format("SELECT $1::int4 + {} AS value", i);
+            auto result = client.execute(query, int32_t{10}).get();
+            ASSERT_TRUE(result) << result.error().to_str();
+            EXPECT_EQ(result.value().rows()[0]["value"].as<int32_t>(), 10 + i);
+        }
+    }
+
+    auto prepared = client.execute("SELECT COUNT(*) AS n FROM pg_prepared_statements").get();
+    ASSERT_TRUE(prepared) << prepared.error().to_str();
+    const std::optional<int64_t> n = prepared.value().rows()[0]["n"].as<int64_t>();
+    ASSERT_TRUE(n);
+    EXPECT_LE(*n, 2);
+}
+
+TEST_F(PostgresLibTest, ResultLimits_FailOversizedResults) {
+    std::optional<std::string> url = database::GetDatabaseUrl();
+    ASSERT_TRUE(url);
+    database::postgres_client client(std::move(*url), database::ClientConfig{.max_result_rows = 1000});
+    auto connected = client.connect();
+    ASSERT_TRUE(connected) << connected.error().to_str();
+    {
+        auto small = client.execute("SELECT generate_series(1, $1::int4) AS n", int32_t{1000}).get();
+        ASSERT_TRUE(small) << small.error().to_str();
+        ASSERT_EQ(small.value().size(), 1000);
+        EXPECT_EQ(small.value().rows()[999]["n"].as<int32_t>(), 1000);
+        EXPECT_EQ(small.value().affected_rows(), 1000);
+        EXPECT_EQ(client.result_memory().current_bytes, small.value().memory_size());
+
+        auto big = client.execute("SELECT generate_series(1, $1::int4) AS n", int32_t{1'000'000}).get();
+        ASSERT_FALSE(big);
+        EXPECT_EQ(big.error().get_type(), database::sql_error::type::ResultTooLarge);
+
+        // The cancelled query leaves the connection usable.
+        auto after = client.execute("SELECT 1 AS one").get();
+        ASSERT_TRUE(after) << after.error().to_str();
+        EXPECT_EQ(after.value().rows()[0]["one"].as<int32_t>(), 1);
+    }
+    const database::result::memory_stats stats = client.result_memory();
+    EXPECT_EQ(stats.current_bytes, 0);
+    EXPECT_GT(stats.peak_bytes, 0);
+}
+
+TEST_F(PostgresLibTest, ResultLimits_SharedBudget) {
+    std::optional<std::string> url = database::GetDatabaseUrl();
+    ASSERT_TRUE(url);
+    auto memory = std::make_shared<database::result::memory_tracker>();
+    const database::ClientConfig config{.result_memory_budget = 200 * 1024, .result_memory = memory};
+    database::postgres_client first(std::string{*url}, config);
+    database::postgres_client second(std::string{*url}, config);
+    ASSERT_TRUE(first.connect());
+    ASSERT_TRUE(second.connect());
+
+    constexpr std::string_view query = "SELECT repeat('x', 100) AS s FROM generate_series(1, $1::int4)";
+    auto held = first.execute(query, int32_t{1000}).get();
+    ASSERT_TRUE(held) << held.error().to_str();
+    EXPECT_GT(memory->current(), 100'000);
+
+    // Fits on its own, but not next to what the other client holds.
+    auto refused = second.execute(query, int32_t{1000}).get();
+    ASSERT_FALSE(refused);
+    EXPECT_EQ(refused.error().get_type(), database::sql_error::type::ResultTooLarge);
+
+    held = std::unexpected(database::sql_error::QueryFailed("released"));
+    EXPECT_EQ(memory->current(), 0);
+    auto accepted = second.execute(query, int32_t{1000}).get();
+    ASSERT_TRUE(accepted) << accepted.error().to_str();
+}
+
+TEST_F(PostgresLibTest, StreamQuery_DeliversRowsInOrder) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    constexpr int32_t kRows = 5000;
+    int32_t expected = 1;
+    std::size_t batches = 0;
+    auto future = client->execute_stream(
+        "SELECT generate_series(1, $1::int4) AS n",
+        [&expected, &batches](database::result::table batch) {
+            ++batches;
+            for (const auto& row : batch.rows())
+                EXPECT_EQ(row["n"].as<int32_t>(), expected++);
+        },
+        kRows);
+    auto result = future.get();
+    ASSERT_TRUE(result) << result.error().to_str();
+    EXPECT_EQ(result.value(), kRows);
+    EXPECT_EQ(expected, kRows + 1);
+    EXPECT_GT(batches, 1);
+}
+
+TEST_F(PostgresLibTest, StreamQuery_ErrorIsReported) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    auto result = client->execute_stream(
+        "SELECT * FROM nonexistent_table_xyz",
+        [](database::result::table) { FAIL() << "no rows expected"; }).get();
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().get_type(), database::sql_error::type::QueryFailed);
+
+    // The connection is still usable afterwards.
+    auto after = client->execute("SELECT 1").get();
+    ASSERT_TRUE(after) << after.error().to_str();
+}
+
+TEST_F(PostgresLibTest, QueryDeadline_CancelsOnServer) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    const auto started = std::chrono::steady_clock::now();
+    auto slow = client->execute(std::chrono::milliseconds(200), "SELECT pg_sleep(10)").get();
+    ASSERT_FALSE(slow);
+    EXPECT_EQ(slow.error().get_type(), database::sql_error::type::TimeOut);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(5));
+
+    // The session survived the cancel; a query with room to spare runs normally.
+    auto after = client->execute(std::chrono::seconds(5), "SELECT $1::int4 AS value", int32_t{3}).get();
+    ASSERT_TRUE(after) << after.error().to_str();
+    EXPECT_EQ(after.value().rows()[0]["value"].as<int32_t>(), 3);
+}
+
+struct series_row {
+    int32_t n;
+    std::optional<std::string> label;
+};
+
+TEST_F(PostgresLibTest, ExecuteIntoStructs) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    auto rows = client->execute<series_row>(
+        "SELECT n, CASE WHEN n % 2 = 0 THEN 'even' END AS label FROM generate_series(1, $1::int4) AS n",
+        int32_t{4}).get();
+    ASSERT_TRUE(rows) << rows.error().to_str();
+    ASSERT_EQ(rows->size(), 4);
+    EXPECT_EQ((*rows)[0].n, 1);
+    EXPECT_FALSE((*rows)[0].label);
+    EXPECT_EQ((*rows)[1].label, "even");
+
+    auto mismatch = client->execute<series_row>("SELECT 'x'::text AS n, NULL::text AS label").get();
+    ASSERT_FALSE(mismatch);
+    EXPECT_EQ(mismatch.error().get_type(), database::sql_error::type::ResultMismatch);
+}
+
+TEST_F(PostgresLibTest, NativeTypesRoundTrip) {
+    using namespace std::chrono;
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    const auto id = database::uuid::parse("a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11").value();
+    const database::interval span{1, 2, seconds{3}};
+    database::inet addr;
+    addr.address = {10, 0, 0, 1};
+    addr.prefix = 8;
+    const database::range<int32_t> ids{1, 10};
+
+    auto res = client->execute(
+        "SELECT $1::uuid AS id, $2::jsonb AS doc, $3::date AS day, $4::interval AS span, $5::inet AS addr, "
+        "$6::int4range AS ids, '[1,5]'::int4range AS closed",
+        id, database::jsonb{R"({"k": [1, 2]})"}, sys_days{2024y / 2 / 29}, span, addr, ids).get();
+    ASSERT_TRUE(res) << res.error().to_str();
+    const auto row = res->rows()[0];
+    EXPECT_EQ(row.get<database::uuid>("id"), id);
+    EXPECT_EQ(row["doc"].as<database::jsonb>()->text, R"({"k": [1, 2]})");
+    EXPECT_EQ(row.get<sys_days>("day"), sys_days{2024y / 2 / 29});
+    EXPECT_EQ(row.get<database::interval>("span"), span);
+    EXPECT_EQ(row.get<database::inet>("addr"), addr);
+    EXPECT_EQ(row.get<database::range<int32_t>>("ids"), ids);
+    // Discrete ranges come back canonical: [1,5] is [1,6).
+    EXPECT_EQ(row.get<database::range<int32_t>>("closed"), (database::range<int32_t>{1, 6}));
+}
+
+TEST_F(PostgresLibTest, ArraysAndRecords) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    auto res = client->execute(
+        "SELECT ARRAY[1, 2, 3]::int8[] AS ids, ARRAY['a', NULL]::text[] AS names, "
+        "ROW(7, 'x'::text, ARRAY[1.5, 2.5]::float8[]) AS rec").get();
+    ASSERT_TRUE(res) << res.error().to_str();
+    const auto row = res->rows()[0];
+    EXPECT_EQ(row.get<std::vector<int64_t>>("ids"), (std::vector<int64_t>{1, 2, 3}));
+    EXPECT_EQ(row.get<std::vector<std::optional<std::string>>>("names"),
+              (std::vector<std::optional<std::string>>{"a", std::nullopt}));
+
+    const auto rec = row.get<std::tuple<int32_t, std::string, std::vector<double>>>("rec");
+    ASSERT_TRUE(rec);
+    EXPECT_EQ(std::get<0>(*rec), 7);
+    EXPECT_EQ(std::get<1>(*rec), "x");
+    EXPECT_EQ(std::get<2>(*rec), (std::vector<double>{1.5, 2.5}));
+}
+
+static detached_task AwaitQueries(const database::postgres_client& client, std::promise<std::vector<int32_t>>& done) {
+    std::vector<int32_t> seen;
+    for (int32_t i = 1; i <= 3; ++i) {
+        auto result = co_await client.query("SELECT $1::int4 AS n", i);
+        if (result)
+            seen.push_back(result.value().rows()[0]["n"].as<int32_t>().value_or(-1));
+    }
+    // A failed query resumes the coroutine with the error; the next one still runs.
+    auto failed = co_await client.query("SELECT * FROM nonexistent_table_xyz");
+    if (!failed && failed.error().get_type() == database::sql_error::type::QueryFailed)
+        seen.push_back(0);
+    done.set_value(std::move(seen));
+}
+
+TEST_F(PostgresLibTest, CoroutineQuery_ResumesWithResults) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    std::promise<std::vector<int32_t>> done;
+    AwaitQueries(*client, done);
+    EXPECT_EQ(done.get_future().get(), (std::vector<int32_t>{1, 2, 3, 0}));
+}
+
+static int64_t CountTestRows(PGClient& client) {
+    auto result = client->execute("SELECT COUNT(*) FROM test_tables").get();
+    EXPECT_TRUE(result) << result.error().to_str();
+    return result ? result.value().rows()[0]["count"].as<int64_t>().value_or(-1) : -1;
+}
+
+TEST_F(PostgresLibTest, ExecuteMany_InsertsEveryRow) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+    const int64_t rows_before = CountTestRows(client);
+
+    constexpr int32_t kRows = 5000; // far more than one socket buffer of Bind/Execute messages
+    std::vector<std::tuple<int32_t, std::string>> rows;
+    rows.reserve(kRows);
+    for (int32_t i = 0; i < kRows; ++i)
+        rows.emplace_back(i, "batch " + std::to_string(i));
+    auto inserted = client->execute_many("INSERT INTO test_tables (col_int32, col_text) VALUES ($1, $2)", rows).get();
+    ASSERT_TRUE(inserted) << inserted.error().to_str();
+    EXPECT_TRUE(inserted.value().ok());
+    EXPECT_EQ(inserted.value().affected_rows, static_cast<std::size_t>(kRows));
+    EXPECT_EQ(CountTestRows(client), rows_before + kRows);
+}
+
+TEST_F(PostgresLibTest, ExecuteMany_FailedItemRollsBackBatch) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+    const int64_t rows_before = CountTestRows(client);
+
+    const std::vector<std::pair<int32_t, int32_t>> rows{{10, 1}, {10, 2}, {10, 0}, {10, 5}};
+    auto inserted = client->execute_many("INSERT INTO test_tables (col_int32, col_text) VALUES ($1 / $2, 'batch')", rows).get();
+    ASSERT_TRUE(inserted) << inserted.error().to_str();
+    const database::result::batch_result& batch = inserted.value();
+    ASSERT_EQ(batch.errors.size(), 2);
+    EXPECT_EQ(batch.errors[0].index, 2);
+    EXPECT_EQ(batch.errors[1].index, 3);
+    EXPECT_EQ(batch.affected_rows, 0);
+    EXPECT_EQ(CountTestRows(client), rows_before);
+
+    auto empty = client->execute_many("SELECT $1::int4", std::vector<std::tuple<int32_t>>{}).get();
+    ASSERT_TRUE(empty) << empty.error().to_str();
+    EXPECT_EQ(empty.value().affected_rows, 0);
+
+    auto bad = client->execute_many("SELECT * FROM nonexistent_table_xyz WHERE a = $1 AND b = $2", rows).get();
+    ASSERT_FALSE(bad);
+    EXPECT_EQ(bad.error().get_type(), database::sql_error::type::QueryFailed);
+}
+
+TEST_F(PostgresLibTest, CopyIn_InsertsAllRows) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+    const int64_t rows_before = CountTestRows(client);
+
+    constexpr std::size_t kRows = 20000; // several chunks
+    database::copy_writer writer = client->copy_in("test_tables", {
+        "col_bool", "col_int16", "col_int32", "col_int64",
+        "col_uint16", "col_uint32", "col_uint64",
+        "col_float", "col_double", "col_text", "col_byte", "col_ts"});
+    auto TEST_COLUMN = database::make_test_values();
+    for (std::size_t i = 0; i < kRows; ++i) {
+        auto written = writer.write(COlUMN_VALUES);
+        ASSERT_TRUE(written) << written.error().to_str();
+    }
+    auto copied = writer.finish();
+    ASSERT_TRUE(copied) << copied.error().to_str();
+    EXPECT_EQ(copied.value(), kRows);
+    EXPECT_EQ(CountTestRows(client), rows_before + static_cast<int64_t>(kRows));
+}
+
+TEST_F(PostgresLibTest, CopyIn_DroppedWriterAborts) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+    const int64_t rows_before = CountTestRows(client);
+    {
+        database::copy_writer writer = client->copy_in("test_tables", {"col_int32", "col_text"});
+        for (int32_t i = 0; i < 100; ++i)
+            ASSERT_TRUE(writer.write_row(std::tuple{i, std::string{"aborted"}}));
+    }
+    EXPECT_EQ(CountTestRows(client), rows_before);
+}
+
+TEST_F(PostgresLibTest, CopyIn_UnknownTableFails) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    database::copy_writer writer = client->copy_in("nonexistent_table_xyz");
+    (void)writer.write(int32_t{1});
+    auto copied = writer.finish();
+    ASSERT_FALSE(copied);
+    EXPECT_EQ(copied.error().get_type(), database::sql_error::type::QueryFailed);
+
+    auto after = client->execute("SELECT 1").get();
+    ASSERT_TRUE(after) << after.error().to_str();
+}
+
+TEST_F(PostgresLibTest, CopyOut_DecodesAllRows) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+    const int64_t rows = CountTestRows(client);
+
+    std::size_t decoded = 0;
+    std::size_t with_text = 0;
+    auto copied = client->copy_out<int32_t, std::string, uint64_t>(
+        "test_tables (id, col_text, col_uint64)",
+        [&](std::tuple<std::optional<int32_t>, std::optional<std::string>, std::optional<uint64_t>> row) {
+            EXPECT_TRUE(std::get<0>(row).has_value());
+            with_text += std::get<1>(row).has_value();
+            ++decoded;
+        }).get();
+    ASSERT_TRUE(copied) << copied.error().to_str();
+    EXPECT_EQ(copied.value(), static_cast<std::size_t>(rows));
+    EXPECT_EQ(decoded, static_cast<std::size_t>(rows));
+    EXPECT_LE(with_text, decoded);
+}
+
+TEST_F(PostgresLibTest, CopyOut_RawSinkReceivesStream) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    std::string stream;
+    auto copied = client->copy_out("(SELECT g::int4 FROM generate_series(1, 1000) g)",
+        [&stream](std::span<const std::byte> data) -> std::expected<void, database::sql_error> {
+            stream.append(reinterpret_cast<const char*>(data.data()), data.size());
+            return {};
+        }).get();
+    ASSERT_TRUE(copied) << copied.error().to_str();
+    EXPECT_EQ(copied.value(), 1000);
+    // header + 1000 * (field count + length + int4) + trailer
+    EXPECT_EQ(stream.size(), 19 + 1000 * (2 + 4 + 4) + 2);
+    EXPECT_TRUE(stream.starts_with(database::internal::kCopySignature));
+}
+
+TEST_F(PostgresLibTest, CopyOut_TypeMismatchFails) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+
+    auto copied = client->copy_out<int32_t>("(SELECT 'text'::text)",
+        [](std::tuple<std::optional<int32_t>>) { FAIL() << "row should not decode"; }).get();
+    ASSERT_FALSE(copied);
+    EXPECT_EQ(copied.error().get_type(), database::sql_error::type::CopyFailed);
+
+    // The stream was drained, so the connection is usable right away.
+    auto after = client->execute("SELECT 1").get();
+    ASSERT_TRUE(after) << after.error().to_str();
+}
+
+TEST_F(PostgresLibTest, EventLoop_ClientsShareOneThread) {
+    std::optional<std::string> url = database::GetDatabaseUrl();
+    ASSERT_TRUE(url);
+    auto loop = std::make_shared<database::event_loop>();
+    std::vector<std::unique_ptr<database::postgres_client>> clients;
+    for (int i = 0; i < 8; ++i) {
+        auto client = std::make_unique<database::postgres_client>(std::string{*url}, database::ClientConfig{.loop = loop});
+        auto connected = client->connect();
+        ASSERT_TRUE(connected) << connected.error().to_str();
+        clients.emplace_back(std::move(client));
+    }
+
+    std::vector<database::query_future<std::expected<database::result::table, database::sql_error>>> futures;
+    for (int32_t i = 0; i < 50; ++i)
+        for (auto& client : clients)
+            futures.emplace_back(client->execute("SELECT $1::int4 AS value", i));
+    std::size_t k = 0;
+    for (int32_t i = 0; i < 50; ++i) {
+        for (std::size_t c = 0; c < clients.size(); ++c) {
+            auto result = futures[k++].get();
+            ASSERT_TRUE(result) << result.error().to_str();
+            EXPECT_EQ(result.value().rows()[0]["value"].as<int32_t>(), i);
+        }
+    }
+
+    database::postgres_client& client = *clients.front();
+    auto failed = client.execute("SELECT * FROM nonexistent_table_xyz");
+    auto next = client.execute("SELECT 1 AS value");
+    EXPECT_FALSE(failed.get());
+    EXPECT_TRUE(next.get());
+
+    std::size_t streamed = 0;
+    auto stream = client.execute_stream("SELECT generate_series(1, 2000) AS n",
+        [&streamed](database::result::table batch) { streamed += batch.size(); }).get();
+    ASSERT_TRUE(stream) << stream.error().to_str();
+    EXPECT_EQ(streamed, 2000);
+
+    database::copy_writer writer = client.copy_in("test_tables", {"col_int32", "col_text"});
+    for (int32_t i = 0; i < 1000; ++i)
+        ASSERT_TRUE(writer.write(i, std::string{"loop"}));
+    auto copied = writer.finish();
+    ASSERT_TRUE(copied) << copied.error().to_str();
+    EXPECT_EQ(copied.value(), 1000);
+
+    std::promise<bool> async_done;
+    client.execute_async("SELECT 1", [&](const database::result::table&) { async_done.set_value(true); },
+                         [&](const database::sql_error&) { async_done.set_value(false); });
+    EXPECT_TRUE(async_done.get_future().get());
+}
+
+TEST_F(PostgresLibTest, EventLoop_BacksConnectionPool) {
+    auto loop = std::make_shared<database::event_loop>(database::EventLoopConfig{.num_threads = 2});
+    auto factory = std::make_shared<Core::Database::ConnectionFactory>();
+    factory->register_factory<database::postgres_client>([loop]() -> Core::Database::ConnectionResult {
+        std::optional<std::string> url = database::GetDatabaseUrl();
+        if (!url) {
+            return std::unexpected(Core::Database::ConnectionError::MissingConfig("Postgres URI not provided"));
+        }
+        auto pg_conn = std::make_unique<database::postgres_client>(std::move(*url), database::ClientConfig{.loop = loop});
+        if (auto result = pg_conn->connect(); !result) {
+            return std::unexpected(result.error());
+        }
+        return std::move(pg_conn);
+    });
+    auto pool = smart_ptr::make_intrusive<Core::Database::ConnectionPool<database::postgres_client>>(factory);
+    pool->wait_for_warmup();
+
+    std::vector<std::jthread> workers;
+    std::atomic_int succeeded = 0;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < 20; ++i) {
+                auto acquired = pool->acquire();
+                if (!acquired)
+                    continue;
+                PGClient& client = acquired.value();
+                if (client->execute("SELECT COUNT(*) FROM test_tables").get())
+                    succeeded.fetch_add(1);
+            }
+        });
+    }
+    workers.clear();
+    EXPECT_EQ(succeeded.load(), 8 * 20);
+}
+
+TEST_F(PostgresLibTest, EventLoop_DroppedConnectionDoesNotResendSentRequests) {
+    std::optional<std::string> url = database::GetDatabaseUrl();
+    ASSERT_TRUE(url);
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& killer = acquired.value();
+
+    auto loop = std::make_shared<database::event_loop>();
+    database::postgres_client client(std::string{*url}, database::ClientConfig{.pipeline_depth = 2, .loop = loop});
+    ASSERT_TRUE(client.connect());
+    auto pid = client.execute("SELECT pg_backend_pid() AS pid").get();
+    ASSERT_TRUE(pid) << pid.error().to_str();
+    const int32_t backend = pid.value().rows()[0]["pid"].as<int32_t>().value();
+
+    // The INSERT and the sleep behind it are both on the wire; the last query waits for a slot.
+    const std::string marker = "dropped-" + std::to_string(backend);
+    auto inserted = client.execute("INSERT INTO test_tables (col_int32, col_text) VALUES (1, $1)", marker);
+    auto sleeping = client.execute("SELECT pg_sleep(30)");
+    auto queued = client.execute("SELECT $1::int4 AS value", int32_t{7});
+
+    bool asleep = false;
+    for (int i = 0; i < 100 && !asleep; ++i) {
+        auto active = killer->execute("SELECT COUNT(*) FROM pg_stat_activity WHERE pid = $1 AND state = 'active' AND query LIKE '%pg_sleep%'", backend).get();
+        ASSERT_TRUE(active) << active.error().to_str();
+        asleep = active.value().rows()[0]["count"].as<int64_t>() == 1;
+        if (!asleep)
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    ASSERT_TRUE(asleep);
+    auto terminated = killer->execute("SELECT pg_terminate_backend($1, 5000)", backend).get();
+    ASSERT_TRUE(terminated) << terminated.error().to_str();
+
+    // Both sent requests may have run, so neither comes back as retried; the unsent one does.
+    auto slept = sleeping.get();
+    ASSERT_FALSE(slept);
+    static_cast<void>(inserted.get());
+    auto after = queued.get();
+    ASSERT_TRUE(after) << after.error().to_str();
+    EXPECT_EQ(after.value().rows()[0]["value"].as<int32_t>(), 7);
+
+    auto count = client.execute("SELECT COUNT(*) FROM test_tables WHERE col_text = $1", marker).get();
+    ASSERT_TRUE(count) << count.error().to_str();
+    EXPECT_EQ(count.value().rows()[0]["count"].as<int64_t>(), 1);
+}
+
 int main(int argc, char *argv[]) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -229,6 +229,165 @@ TEST_F(PostgresLibTest, AsyncTransactionUsedAfterRolledback) {
     }
 }
 
+TEST_F(PostgresLibTest, TransactionStreamQuery) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    {
+        PGClient& client = acquired.value();
+        auto txn = client->create_transaction();
+        ASSERT_FALSE(!txn) << "Transaction should be created";
+        database::test_row test_row = database::make_test_values();
+        auto f1 = txn->execute(INSERT_QUERY, COLUMN_DATA(test_row));
+        auto r1 = f1.get();
+        ASSERT_TRUE(r1) << r1.error().to_str();
+
+        // Rows inserted by this transaction are visible to its own stream.
+        std::size_t streamed = 0;
+        auto stream = txn->execute_stream(
+            "SELECT id FROM test_tables",
+            [&streamed](database::result::table batch) { streamed += batch.size(); });
+        auto result = stream.get();
+        ASSERT_TRUE(result) << result.error().to_str();
+        EXPECT_EQ(result.value(), streamed);
+        EXPECT_GE(streamed, 1);
+        txn->rollback();
+
+        auto after = txn->execute_stream("SELECT 1", [](database::result::table) {}).get();
+        ASSERT_FALSE(after);
+        EXPECT_EQ(after.error().get_type(), database::sql_error::type::TransactionRolledBack);
+    }
+}
+
+static detached_task InsertAndCount(database::transaction& txn, std::promise<std::expected<int64_t, database::sql_error>>& done) {
+    database::test_row test_row = database::make_test_values();
+    auto inserted = co_await txn.query(INSERT_QUERY, COLUMN_DATA(test_row));
+    if (!inserted) {
+        done.set_value(std::unexpected(inserted.error()));
+        co_return;
+    }
+    auto counted = co_await txn.query("SELECT COUNT(*) FROM test_tables");
+    if (!counted) {
+        done.set_value(std::unexpected(counted.error()));
+        co_return;
+    }
+    done.set_value(counted.value().rows()[0]["count"].as<int64_t>().value_or(-1));
+}
+
+// Resumed on the callback pool, so it may wait on the client itself.
+static detached_task QueryThenRollback(database::shared_transaction txn, std::promise<bool>& done) {
+    auto result = co_await txn->query("SELECT 1");
+    txn->rollback();
+    auto blocking = txn->execute("SELECT 1").get();
+    txn.reset();
+    done.set_value(result.has_value() && !blocking);
+}
+
+static detached_task QueryAfterRollback(database::transaction& txn, std::promise<database::sql_error::type>& done) {
+    auto result = co_await txn.query("SELECT 1");
+    done.set_value(result ? database::sql_error::type::QueryFailed : result.error().get_type());
+}
+
+TEST_F(PostgresLibTest, TransactionCoroutineQuery) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+    auto before = client->execute("SELECT COUNT(*) FROM test_tables").get();
+    ASSERT_TRUE(before) << before.error().to_str();
+    const int64_t rows_before = before.value().rows()[0]["count"].as<int64_t>().value();
+    {
+        auto txn = client->create_transaction();
+        std::promise<std::expected<int64_t, database::sql_error>> counted;
+        InsertAndCount(*txn, counted);
+        auto result = counted.get_future().get();
+        ASSERT_TRUE(result) << result.error().to_str();
+        EXPECT_EQ(result.value(), rows_before + 1);
+        txn->rollback();
+
+        // Completes without suspending once the transaction is over.
+        std::promise<database::sql_error::type> rejected;
+        QueryAfterRollback(*txn, rejected);
+        EXPECT_EQ(rejected.get_future().get(), database::sql_error::type::TransactionRolledBack);
+
+        std::promise<bool> rolled_back;
+        QueryThenRollback(client->create_transaction(), rolled_back);
+        auto finished = rolled_back.get_future();
+        ASSERT_EQ(finished.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+        EXPECT_TRUE(finished.get());
+    }
+    auto after = client->execute("SELECT COUNT(*) FROM test_tables").get();
+    ASSERT_TRUE(after) << after.error().to_str();
+    EXPECT_EQ(after.value().rows()[0]["count"].as<int64_t>().value(), rows_before);
+}
+
+TEST_F(PostgresLibTest, TransactionCursor) {
+    auto acquired = postgres_pool->acquire();
+    ASSERT_TRUE(acquired) << acquired.error().to_str();
+    PGClient& client = acquired.value();
+    {
+        auto txn = client->create_transaction();
+        database::cursor_options options{.initial_rows = 100, .min_rows = 16};
+        auto cur = txn->declare_cursor(options, "SELECT g::int8 FROM generate_series(1, $1::int8) g", int64_t{5000});
+        EXPECT_EQ(cur.fetch_rows(), 64);
+
+        int64_t rows = 0;
+        int64_t sum = 0;
+        int batches = 0;
+        while (true) {
+            auto batch = cur.next();
+            ASSERT_TRUE(batch) << batch.error().to_str();
+            if (!batch.value())
+                break;
+            ++batches;
+            for (auto row : batch.value()->rows()) {
+                sum += row["g"].as<int64_t>().value();
+                ++rows;
+            }
+        }
+        EXPECT_TRUE(cur.done());
+        EXPECT_EQ(rows, 5000);
+        EXPECT_EQ(sum, 5000 * 5001 / 2);
+        // Narrow rows: the fetch size grows well past the first 64 after one batch.
+        EXPECT_LT(batches, 5000 / 64);
+        EXPECT_GT(cur.fetch_rows(), 64);
+
+        // A DECLARE that fails surfaces in next() and aborts the transaction.
+        auto bad = txn->declare_cursor("SELECT * FROM no_such_table");
+        auto failed = bad.next();
+        ASSERT_FALSE(failed);
+        EXPECT_TRUE(bad.done());
+        EXPECT_TRUE(bad.close());
+        txn->rollback();
+    }
+    {
+        // close() waits for the CLOSE and reports how it went.
+        auto txn = client->create_transaction();
+        auto cur = txn->declare_cursor("SELECT g FROM generate_series(1, 10) g");
+        ASSERT_TRUE(cur.next());
+        auto closed = cur.close();
+        EXPECT_TRUE(closed) << closed.error().to_str();
+        EXPECT_TRUE(cur.done());
+
+        auto bad = txn->declare_cursor("SELECT * FROM no_such_table");
+        EXPECT_FALSE(bad.close());
+    }
+    {
+        // The cursor keeps its transaction alive; dropping it queues the CLOSE and the
+        // transaction then rolls back.
+        std::optional<database::cursor> cur;
+        {
+            auto txn = client->create_transaction();
+            cur.emplace(txn->declare_cursor("SELECT g FROM generate_series(1, 10) g"));
+        }
+        auto batch = cur->next();
+        ASSERT_TRUE(batch) << batch.error().to_str();
+        ASSERT_TRUE(batch.value());
+        EXPECT_EQ(batch.value()->size(), 10);
+        cur.reset();
+        auto after = client->execute("SELECT 1").get();
+        EXPECT_TRUE(after) << after.error().to_str();
+    }
+}
+
 int main(int argc, char *argv[]) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
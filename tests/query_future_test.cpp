@@ -0,0 +1,121 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+#include <database/query_future.h>
+
+using database::query_future;
+using database::internal::oneshot_state;
+
+namespace {
+    std::atomic<std::size_t> g_allocations = 0;
+}
+
+// Counts every global allocation in this binary, so a test can assert a code path makes none.
+void* operator new(const std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size == 0 ? 1 : size))
+        return block;
+    throw std::bad_alloc();
+}
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete(void* block, std::size_t) noexcept { std::free(block); }
+
+namespace {
+    struct pooled_probe : database::internal::pooled<pooled_probe> {
+        std::uint64_t payload[4] = {};
+    };
+}
+
+TEST(ObjectPoolTest, FreedBlocksAreReused) {
+    auto* first = new pooled_probe;
+    void* const address = first;
+    delete first;
+    auto* second = new pooled_probe;
+    EXPECT_EQ(static_cast<void*>(second), address);
+    delete second;
+}
+
+TEST(ObjectPoolTest, BlocksFreedOnAnotherThreadComeBack) {
+    pooled_probe* made = nullptr;
+    std::jthread([&made] { made = new pooled_probe; }).join();
+    void* const address = made;
+    std::jthread([made] { delete made; }).join();
+    // This thread's cache is empty, so it takes the shared stack the other thread freed into.
+    auto* again = new pooled_probe;
+    EXPECT_EQ(static_cast<void*>(again), address);
+    delete again;
+}
+
+TEST(QueryFutureTest, ReadyFutureYieldsValueOnce) {
+    auto future = query_future<std::string>::ready("done");
+    ASSERT_TRUE(future.valid());
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(future.get(), "done");
+    EXPECT_FALSE(future.valid());
+}
+
+TEST(QueryFutureTest, WaitsForCompletionFromAnotherThread) {
+    auto state = smart_ptr::make_intrusive<oneshot_state<int>>();
+    query_future<int> future{state};
+    EXPECT_EQ(future.wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+
+    std::jthread producer([state = std::move(state)]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        state->set(42);
+    });
+    EXPECT_EQ(future.get(), 42);
+}
+
+TEST(QueryFutureTest, StateOutlivesTheFutureUntilCompleted) {
+    auto state = smart_ptr::make_intrusive<oneshot_state<std::string>>();
+    {
+        query_future<std::string> abandoned{state};
+    }
+    // The completing side still holds its reference, so setting is safe.
+    state->set("nobody waits");
+    EXPECT_TRUE(state->ready());
+    EXPECT_EQ(state->ref_count(), 1);
+}
+
+TEST(QueryFutureTest, WarmRoundTripDoesNotAllocate) {
+    query_future<std::uint64_t>::ready(1).get(); // warms this thread's pool
+    const std::size_t before = g_allocations.load();
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        auto state = smart_ptr::make_intrusive<oneshot_state<std::uint64_t>>();
+        query_future<std::uint64_t> future{state};
+        state->set(i);
+        state.reset();
+        EXPECT_EQ(future.get(), i);
+    }
+    EXPECT_EQ(g_allocations.load(), before);
+}
+
+TEST(QueryFutureTest, ThrowingValueLeavesStateNotReady) {
+    struct explosive {
+        explicit explosive(int) { throw std::runtime_error("no memory"); }
+    };
+    auto state = smart_ptr::make_intrusive<oneshot_state<explosive>>();
+    EXPECT_THROW(state->set(1), std::runtime_error);
+    EXPECT_FALSE(state->ready());
+}
+
+TEST(QueryFutureTest, InvalidFutureThrowsNoState) {
+    query_future<int> empty;
+    EXPECT_THROW(empty.get(), std::future_error);
+    EXPECT_THROW(empty.wait(), std::future_error);
+    EXPECT_THROW((void)empty.wait_for(std::chrono::seconds(0)), std::future_error);
+
+    auto consumed = query_future<int>::ready(7);
+    EXPECT_EQ(consumed.get(), 7);
+    try {
+        consumed.get();
+        FAIL() << "get() on a consumed future returned";
+    } catch (const std::future_error& e) {
+        EXPECT_EQ(e.code(), std::future_errc::no_state);
+    }
+}
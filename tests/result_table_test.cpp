@@ -0,0 +1,449 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <database/result/table.h>
+
+using database::result::table;
+using database::result::unique_pg_result;
+namespace pg_oid = database::result::pg_oid;
+
+namespace {
+    // Builds a binary-format result the way libpq would hand it over, without a server.
+    struct result_builder {
+        explicit result_builder(std::vector<std::pair<std::string, Oid>> columns) {
+            m_res.reset(PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK));
+            std::vector<PGresAttDesc> attrs(columns.size());
+            for (std::size_t c = 0; c < columns.size(); ++c) {
+                attrs[c].name = columns[c].first.data();
+                attrs[c].typid = columns[c].second;
+                attrs[c].format = 1;
+                attrs[c].typlen = -1;
+                attrs[c].atttypmod = -1;
+            }
+            PQsetResultAttrs(m_res.get(), static_cast<int>(attrs.size()), attrs.data());
+        }
+
+        result_builder& value(const int row, const int col, const std::string& bytes) {
+            PQsetvalue(m_res.get(), row, col, const_cast<char*>(bytes.data()), static_cast<int>(bytes.size()));
+            return *this;
+        }
+        result_builder& null(const int row, const int col) {
+            PQsetvalue(m_res.get(), row, col, nullptr, -1);
+            return *this;
+        }
+
+        table build() { return table{std::move(m_res)}; }
+
+    private:
+        unique_pg_result m_res;
+    };
+
+    std::string BigEndian32(const int32_t v) {
+        const auto u = static_cast<uint32_t>(v);
+        return {static_cast<char>(u >> 24), static_cast<char>(u >> 16), static_cast<char>(u >> 8), static_cast<char>(u)};
+    }
+}
+
+TEST(ResultTableTest, RowsDecodeOnAccess) {
+    table t = result_builder({{"id", pg_oid::Int4}, {"name", pg_oid::Text}})
+        .value(0, 0, BigEndian32(7)).value(0, 1, "seven")
+        .value(1, 0, BigEndian32(-3)).null(1, 1)
+        .build();
+
+    ASSERT_EQ(t.size(), 2);
+    ASSERT_EQ(t.columns().size(), 2);
+    EXPECT_EQ(t.columns()[1].name, "name");
+    EXPECT_EQ(t.columns()[1].oid, pg_oid::Text);
+
+    EXPECT_EQ(t.rows()[0]["id"].as<int32_t>(), 7);
+    EXPECT_EQ(t.rows()[0].get<std::string>("name"), "seven");
+    EXPECT_EQ(t.rows()[1]["id"].as<int32_t>(), -3);
+    EXPECT_FALSE(t.rows()[1]["name"].as<std::string>());
+}
+
+TEST(ResultTableTest, UnknownColumnReadsAsNull) {
+    table t = result_builder({{"id", pg_oid::Int4}}).value(0, 0, BigEndian32(1)).build();
+    EXPECT_FALSE(t.rows()[0]["missing"].as<int32_t>());
+    EXPECT_FALSE(t.rows()[0].get<int32_t>("missing"));
+}
+
+TEST(ResultTableTest, IteratesInOrder) {
+    result_builder builder({{"n", pg_oid::Int4}});
+    for (int i = 0; i < 5; ++i)
+        builder.value(i, 0, BigEndian32(i * 10));
+    table t = builder.build();
+
+    std::vector<int32_t> seen;
+    for (const auto& row : t.rows())
+        seen.push_back(row["n"].as<int32_t>().value_or(-1));
+    EXPECT_EQ(seen, (std::vector<int32_t>{0, 10, 20, 30, 40}));
+}
+
+TEST(ResultTableTest, RowsSurviveMoveOfTable) {
+    table t = result_builder({{"n", pg_oid::Int4}}).value(0, 0, BigEndian32(42)).build();
+    const auto rows = t.rows();
+    table moved = std::move(t);
+    EXPECT_EQ(rows[0]["n"].as<int32_t>(), 42);
+    EXPECT_EQ(moved.rows()[0]["n"].as<int32_t>(), 42);
+}
+
+TEST(ResultTableTest, EmptyResult) {
+    table t = result_builder({{"n", pg_oid::Int4}}).build();
+    EXPECT_EQ(t.size(), 0);
+    EXPECT_TRUE(t.rows().empty());
+    EXPECT_EQ(t.rows().begin(), t.rows().end());
+}
+
+TEST(ResultTableTest, PositionalAccess) {
+    table t = result_builder({{"id", pg_oid::Int4}, {"name", pg_oid::Text}})
+        .value(0, 0, BigEndian32(5)).value(0, 1, "five")
+        .build();
+    const auto row = t.rows()[0];
+    EXPECT_EQ(row.size(), 2);
+    EXPECT_EQ(row.get<int32_t>(0), 5);
+    EXPECT_EQ(row[1].as<std::string>(), "five");
+    EXPECT_FALSE(row.get<int32_t>(2));
+}
+
+TEST(ResultTableTest, HandlesResolveOnce) {
+    result_builder builder({{"id", pg_oid::Int4}, {"score", pg_oid::Int4}});
+    for (int i = 0; i < 3; ++i)
+        builder.value(i, 0, BigEndian32(i)).value(i, 1, BigEndian32(i * 100));
+    table t = builder.build();
+
+    const auto score = t.handle("score");
+    const auto id = t.handle(database::result::column_key{"id"});
+    ASSERT_TRUE(score);
+    ASSERT_TRUE(id);
+    EXPECT_EQ(score.index(), 1);
+    EXPECT_FALSE(t.handle("missing"));
+
+    int32_t i = 0;
+    for (const auto& row : t.rows()) {
+        EXPECT_EQ(row.get<int32_t>(id), i);
+        EXPECT_EQ(row[score].as<int32_t>(), i * 100);
+        EXPECT_EQ(row.get<int32_t>(database::result::column_key{"score"}), i * 100);
+        ++i;
+    }
+    EXPECT_FALSE(t.rows()[0][database::result::column_handle{}].as<int32_t>());
+}
+
+namespace {
+    struct positional_row {
+        int32_t id;
+        std::optional<std::string> name;
+    };
+
+    struct named_row {
+        std::string name;
+        int64_t id;
+        static constexpr std::array<std::string_view, 2> column_names = {"name", "id"};
+    };
+}
+
+TEST(ResultTableTest, MapsRowsByPosition) {
+    table t = result_builder({{"id", pg_oid::Int4}, {"name", pg_oid::Text}})
+        .value(0, 0, BigEndian32(1)).value(0, 1, "one")
+        .value(1, 0, BigEndian32(2)).null(1, 1)
+        .build();
+    auto rows = t.as<positional_row>();
+    ASSERT_TRUE(rows) << rows.error().to_str();
+    ASSERT_EQ(rows->size(), 2);
+    EXPECT_EQ((*rows)[0].id, 1);
+    EXPECT_EQ((*rows)[0].name, "one");
+    EXPECT_EQ((*rows)[1].id, 2);
+    EXPECT_FALSE((*rows)[1].name);
+}
+
+TEST(ResultTableTest, MapsRowsByName) {
+    table t = result_builder({{"id", pg_oid::Int4}, {"extra", pg_oid::Bool}, {"name", pg_oid::Varchar}})
+        .value(0, 0, BigEndian32(9)).value(0, 1, std::string(1, '\1')).value(0, 2, "nine")
+        .build();
+    auto rows = t.as<named_row>();
+    ASSERT_TRUE(rows) << rows.error().to_str();
+    ASSERT_EQ(rows->size(), 1);
+    EXPECT_EQ((*rows)[0].id, 9);
+    EXPECT_EQ((*rows)[0].name, "nine");
+}
+
+TEST(ResultTableTest, MappingMismatchesFail) {
+    using database::sql_error;
+    // Wrong type for a field.
+    table wrong_type = result_builder({{"id", pg_oid::Text}, {"name", pg_oid::Text}}).build();
+    auto a = wrong_type.as<positional_row>();
+    ASSERT_FALSE(a);
+    EXPECT_EQ(a.error().get_type(), sql_error::type::ResultMismatch);
+
+    // Column count differs from the field count.
+    table too_few = result_builder({{"id", pg_oid::Int4}}).build();
+    EXPECT_FALSE(too_few.as<positional_row>());
+
+    // Named column missing.
+    table missing = result_builder({{"id", pg_oid::Int8}}).build();
+    EXPECT_FALSE(missing.as<named_row>());
+
+    // NULL in a non-optional field.
+    table null_id = result_builder({{"id", pg_oid::Int4}, {"name", pg_oid::Text}}).null(0, 0).value(0, 1, "x").build();
+    EXPECT_FALSE(null_id.as<positional_row>());
+}
+
+namespace {
+    struct arena_row {
+        int32_t id;
+        std::optional<std::pmr::string> name;
+        static constexpr std::array<std::string_view, 2> column_names = {"id", "name"};
+    };
+
+    // A small arena with no fallback to the heap.
+    struct fixed_arena {
+        std::array<std::byte, 4096> buffer{};
+        std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    };
+
+    bool FromArena(const std::pmr::memory_resource* resource, const fixed_arena& a) {
+        return resource == &a.arena;
+    }
+}
+
+TEST(ResultTableTest, DecodesIntoMemoryResource) {
+    fixed_arena a;
+    table t = result_builder({{"id", pg_oid::Int4}, {"name", pg_oid::Text}, {"payload", pg_oid::Bytea}})
+        .value(0, 0, BigEndian32(1)).value(0, 1, "a name longer than any small string buffer").value(0, 2, "\x01\x02")
+        .value(1, 0, BigEndian32(2)).null(1, 1).null(1, 2)
+        .build();
+
+    const auto name = t.rows()[0].get<std::pmr::string>("name", &a.arena);
+    ASSERT_TRUE(name);
+    EXPECT_EQ(*name, "a name longer than any small string buffer");
+    EXPECT_TRUE(FromArena(name->get_allocator().resource(), a));
+    const auto payload = t.rows()[0]["payload"].as<std::pmr::vector<std::byte>>(&a.arena);
+    ASSERT_TRUE(payload);
+    EXPECT_EQ(payload->size(), 2);
+    EXPECT_TRUE(FromArena(payload->get_allocator().resource(), a));
+    // Without a resource the std::pmr types use the default one.
+    EXPECT_EQ(t.rows()[0]["name"].as<std::pmr::string>()->get_allocator().resource(), std::pmr::get_default_resource());
+
+    auto rows = t.as<arena_row>(&a.arena);
+    ASSERT_TRUE(rows) << rows.error().to_str();
+    ASSERT_EQ(rows->size(), 2);
+    EXPECT_TRUE(FromArena(rows->get_allocator().resource(), a));
+    EXPECT_EQ((*rows)[0].id, 1);
+    ASSERT_TRUE((*rows)[0].name);
+    EXPECT_EQ(*(*rows)[0].name, *name);
+    EXPECT_TRUE(FromArena((*rows)[0].name->get_allocator().resource(), a));
+    EXPECT_FALSE((*rows)[1].name);
+
+    auto names = t.column<std::pmr::string>("name", &a.arena);
+    ASSERT_TRUE(names) << names.error().to_str();
+    EXPECT_EQ(names->null_count, 1);
+    EXPECT_EQ(names->values[0], *name);
+    EXPECT_TRUE(FromArena(names->values[0].get_allocator().resource(), a));
+    EXPECT_TRUE(FromArena(names->validity.get_allocator().resource(), a));
+    auto ids = t.column<int32_t>("id", &a.arena);
+    ASSERT_TRUE(ids) << ids.error().to_str();
+    EXPECT_EQ(ids->values[1], 2);
+    EXPECT_TRUE(FromArena(ids->values.get_allocator().resource(), a));
+}
+
+namespace {
+    std::string BigEndian64(const int64_t v) {
+        const auto u = static_cast<uint64_t>(v);
+        std::string out(8, '\0');
+        for (int i = 0; i < 8; ++i)
+            out[i] = static_cast<char>(u >> (56 - 8 * i));
+        return out;
+    }
+
+    std::string BigEndianDouble(const double v) {
+        int64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return BigEndian64(bits);
+    }
+}
+
+TEST(ResultTableTest, ByteSwapKernelsMatchScalar) {
+    namespace pg_detail = database::result::pg_detail;
+    // Odd lengths exercise the vector loops and their scalar tails.
+    for (const std::size_t count : {0u, 1u, 3u, 7u, 8u, 17u, 33u, 100u}) {
+        std::vector<uint64_t> wide(count);
+        std::vector<uint32_t> mid(count);
+        std::vector<uint16_t> narrow(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            wide[i] = 0x0102030405060708ULL * (i + 1);
+            mid[i] = static_cast<uint32_t>(0x01020304u * (i + 1));
+            narrow[i] = static_cast<uint16_t>(0x0102u * (i + 1));
+        }
+        auto expect_wide = wide;
+        auto expect_mid = mid;
+        auto expect_narrow = narrow;
+        for (auto& v : expect_wide) v = std::byteswap(v);
+        for (auto& v : expect_mid) v = std::byteswap(v);
+        for (auto& v : expect_narrow) v = std::byteswap(v);
+
+        pg_detail::SwapBytes64(reinterpret_cast<std::byte*>(wide.data()), count);
+        pg_detail::SwapBytes32(reinterpret_cast<std::byte*>(mid.data()), count);
+        pg_detail::SwapBytes16(reinterpret_cast<std::byte*>(narrow.data()), count);
+        EXPECT_EQ(wide, expect_wide) << count;
+        EXPECT_EQ(mid, expect_mid) << count;
+        EXPECT_EQ(narrow, expect_narrow) << count;
+    }
+}
+
+TEST(ResultTableTest, ExtractsColumns) {
+    constexpr int rows = 70;
+    result_builder builder({{"id", pg_oid::Int8}, {"score", pg_oid::Float8}, {"n", pg_oid::Int4}, {"at", pg_oid::Timestamptz}});
+    for (int i = 0; i < rows; ++i) {
+        if (i % 5 == 0)
+            builder.null(i, 0);
+        else
+            builder.value(i, 0, BigEndian64(int64_t{i} << 33));
+        builder.value(i, 1, BigEndianDouble(i * 0.5)).value(i, 2, BigEndian32(-i)).value(i, 3, BigEndian64(i * 1'000'000LL));
+    }
+    table t = builder.build();
+
+    auto ids = t.column<int64_t>("id");
+    ASSERT_TRUE(ids) << ids.error().to_str();
+    ASSERT_EQ(ids->size(), rows);
+    EXPECT_EQ(ids->null_count, 14);
+    EXPECT_EQ(ids->validity.size(), database::result::BitmapBytes(rows));
+    for (int i = 0; i < rows; ++i) {
+        EXPECT_EQ(ids->is_null(i), i % 5 == 0) << i;
+        EXPECT_EQ(ids->values[i], i % 5 == 0 ? 0 : int64_t{i} << 33) << i;
+    }
+
+    auto scores = t.column<double>(t.handle("score"));
+    ASSERT_TRUE(scores);
+    EXPECT_EQ(scores->null_count, 0);
+    EXPECT_EQ(scores->values[69], 34.5);
+
+    // Int4 read as int64_t goes cell by cell.
+    auto widened = t.column<int64_t>("n");
+    ASSERT_TRUE(widened);
+    EXPECT_EQ(widened->values[7], -7);
+
+    auto at = t.column<database::result::timestamp>("at");
+    ASSERT_TRUE(at);
+    EXPECT_EQ(at->values[3], t.rows()[3].get<database::result::timestamp>("at"));
+
+    // Into caller storage, without a bitmap.
+    std::vector<int32_t> n(rows);
+    auto nulls = t.column<int32_t>("n", std::span{n});
+    ASSERT_TRUE(nulls);
+    EXPECT_EQ(*nulls, 0);
+    EXPECT_EQ(n[69], -69);
+}
+
+TEST(ResultTableTest, ExtractsNullAndInfiniteTimestamps) {
+    using database::result::timestamp;
+    constexpr int64_t kInfinity = std::numeric_limits<int64_t>::max();
+    table t = result_builder({{"at", pg_oid::Timestamptz}})
+        .value(0, 0, BigEndian64(0))
+        .null(1, 0)
+        .value(2, 0, BigEndian64(kInfinity))
+        .value(3, 0, BigEndian64(std::numeric_limits<int64_t>::min()))
+        .build();
+
+    auto at = t.column<timestamp>("at");
+    ASSERT_TRUE(at) << at.error().to_str();
+    EXPECT_EQ(at->values[0], std::chrono::sys_days{std::chrono::year{2000} / 1 / 1});
+    EXPECT_TRUE(at->is_null(1));
+    EXPECT_EQ(at->values[1], timestamp{});
+    EXPECT_EQ(at->values[2], timestamp::max());
+    EXPECT_EQ(at->values[3], timestamp::min());
+    EXPECT_EQ(t.rows()[2].get<timestamp>("at"), timestamp::max());
+}
+
+TEST(ResultTableTest, ColumnExtractionMismatchesFail) {
+    using database::sql_error;
+    table t = result_builder({{"n", pg_oid::Int4}, {"name", pg_oid::Text}})
+        .value(0, 0, BigEndian32(1)).value(0, 1, "one")
+        .value(1, 0, BigEndian32(2)).value(1, 1, "two")
+        .build();
+
+    auto names = t.column<std::string>("name");
+    ASSERT_TRUE(names);
+    EXPECT_EQ(names->values[1], "two");
+
+    auto wrong = t.column<double>("n");
+    ASSERT_FALSE(wrong);
+    EXPECT_EQ(wrong.error().get_type(), sql_error::type::ResultMismatch);
+    EXPECT_FALSE(t.column<int32_t>("missing"));
+
+    std::array<int32_t, 1> small{};
+    EXPECT_FALSE(t.column<int32_t>("n", std::span{small}));
+}
+
+TEST(ResultTableTest, ExportsArrowBatch) {
+    table t = result_builder({{"id", pg_oid::Int4}, {"name", pg_oid::Text}, {"ok", pg_oid::Bool}, {"at", pg_oid::Timestamptz}})
+        .value(0, 0, BigEndian32(1)).value(0, 1, "one").value(0, 2, std::string(1, '\1')).value(0, 3, BigEndian64(0))
+        .null(1, 0).value(1, 1, "").value(1, 2, std::string(1, '\0')).null(1, 3)
+        .value(2, 0, BigEndian32(3)).null(2, 1).null(2, 2).value(2, 3, BigEndian64(1'000'000))
+        .build();
+
+    ArrowSchema schema{};
+    ArrowArray array{};
+    ASSERT_TRUE(t.to_arrow(&schema, &array));
+    ASSERT_EQ(std::string_view{schema.format}, "+s");
+    ASSERT_EQ(schema.n_children, 4);
+    ASSERT_EQ(array.n_children, 4);
+    EXPECT_EQ(array.length, 3);
+
+    EXPECT_EQ(std::string_view{schema.children[0]->format}, "i");
+    EXPECT_EQ(std::string_view{schema.children[0]->name}, "id");
+    EXPECT_EQ(std::string_view{schema.children[1]->format}, "u");
+    EXPECT_EQ(std::string_view{schema.children[2]->format}, "b");
+    EXPECT_EQ(std::string_view{schema.children[3]->format}, "tsu:UTC");
+
+    const ArrowArray* ids = array.children[0];
+    EXPECT_EQ(ids->null_count, 1);
+    const auto* id_bits = static_cast<const uint8_t*>(ids->buffers[0]);
+    const auto* id_values = static_cast<const int32_t*>(ids->buffers[1]);
+    EXPECT_EQ(id_bits[0] & 0b111, 0b101);
+    EXPECT_EQ(id_values[0], 1);
+    EXPECT_EQ(id_values[2], 3);
+
+    const ArrowArray* names = array.children[1];
+    const auto* offsets = static_cast<const int32_t*>(names->buffers[1]);
+    const auto* chars = static_cast<const char*>(names->buffers[2]);
+    EXPECT_EQ(std::string_view(chars + offsets[0], offsets[1] - offsets[0]), "one");
+    EXPECT_EQ(offsets[2], offsets[1]);
+    EXPECT_EQ(offsets[3], offsets[2]);
+
+    const ArrowArray* oks = array.children[2];
+    EXPECT_EQ(static_cast<const uint8_t*>(oks->buffers[1])[0] & 0b11, 0b01);
+
+    const auto* at = static_cast<const int64_t*>(array.children[3]->buffers[1]);
+    EXPECT_EQ(at[0], 946684800LL * 1'000'000LL);
+    EXPECT_EQ(at[1], 0); // NULL slots are left zeroed
+    EXPECT_EQ(at[2], 946684801LL * 1'000'000LL);
+
+    // A consumer may move a child out and release it on its own.
+    ArrowArray moved = *array.children[1];
+    array.children[1]->release = nullptr;
+    array.release(&array);
+    EXPECT_EQ(array.release, nullptr);
+    moved.release(&moved);
+    schema.release(&schema);
+}
+
+TEST(ResultTableTest, ExportsInfiniteTimestampsAsLimits) {
+    constexpr int64_t kInfinity = std::numeric_limits<int64_t>::max();
+    table t = result_builder({{"at", pg_oid::Timestamp}})
+        .value(0, 0, BigEndian64(kInfinity))
+        .value(1, 0, BigEndian64(std::numeric_limits<int64_t>::min()))
+        .build();
+
+    ArrowSchema schema{};
+    ArrowArray array{};
+    ASSERT_TRUE(t.to_arrow(&schema, &array));
+    const auto* at = static_cast<const int64_t*>(array.children[0]->buffers[1]);
+    EXPECT_EQ(at[0], kInfinity);
+    EXPECT_EQ(at[1], std::numeric_limits<int64_t>::min());
+    array.release(&array);
+    schema.release(&schema);
+}
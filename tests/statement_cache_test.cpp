@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <database/internal/statement_cache.h>
+
+using database::internal::statement_cache;
+
+TEST(StatementCacheTest, MissThenHit) {
+    statement_cache cache(4);
+    const auto first = cache.acquire("SELECT 1");
+    EXPECT_FALSE(first.prepared);
+    EXPECT_FALSE(first.evicted);
+    const std::string name = first.name;
+
+    const auto second = cache.acquire("SELECT 1");
+    EXPECT_TRUE(second.prepared);
+    EXPECT_EQ(second.name, name);
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(StatementCacheTest, DistinctQueriesGetDistinctNames) {
+    statement_cache cache(4);
+    const std::string a = cache.acquire("SELECT 1").name;
+    const std::string b = cache.acquire("SELECT 2").name;
+    EXPECT_NE(a, b);
+}
+
+TEST(StatementCacheTest, EvictsLeastRecentlyUsed) {
+    statement_cache cache(2);
+    const std::string a = cache.acquire("SELECT 1").name;
+    const std::string b = cache.acquire("SELECT 2").name;
+    cache.acquire("SELECT 1"); // SELECT 2 is now the oldest
+
+    const auto c = cache.acquire("SELECT 3");
+    EXPECT_FALSE(c.prepared);
+    ASSERT_TRUE(c.evicted);
+    EXPECT_EQ(*c.evicted, b);
+    EXPECT_EQ(cache.size(), 2);
+
+    EXPECT_TRUE(cache.acquire("SELECT 1").prepared);
+    EXPECT_FALSE(cache.acquire("SELECT 2").prepared);
+}
+
+TEST(StatementCacheTest, NamesAreNeverReused) {
+    statement_cache cache(1);
+    const std::string a = cache.acquire("SELECT 1").name;
+    cache.acquire("SELECT 2");
+    const auto again = cache.acquire("SELECT 1");
+    EXPECT_FALSE(again.prepared);
+    EXPECT_NE(again.name, a);
+}
+
+TEST(StatementCacheTest, EraseForcesPrepare) {
+    statement_cache cache(4);
+    cache.acquire("SELECT 1");
+    cache.erase("SELECT 1");
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_FALSE(cache.acquire("SELECT 1").prepared);
+    cache.erase("SELECT unknown"); // no-op
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(StatementCacheTest, ClearDropsEverything) {
+    statement_cache cache(4);
+    cache.acquire("SELECT 1");
+    cache.acquire("SELECT 2");
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    const auto after = cache.acquire("SELECT 1");
+    EXPECT_FALSE(after.prepared);
+    EXPECT_FALSE(after.evicted);
+}
+
+TEST(StatementCacheTest, ZeroCapacityIsDisabled) {
+    EXPECT_FALSE(statement_cache(0).enabled());
+    EXPECT_TRUE(statement_cache(1).enabled());
+}
+
+TEST(StatementCacheTest, ParameterTypesAreKeyed) {
+    statement_cache cache(4);
+    const std::array<Oid, 1> int4{23};
+    const std::array<Oid, 1> int8{20};
+    const std::string a = cache.acquire("SELECT $1", int4).name;
+    const auto b = cache.acquire("SELECT $1", int8);
+    EXPECT_FALSE(b.prepared);
+    EXPECT_NE(b.name, a);
+    EXPECT_TRUE(cache.acquire("SELECT $1", int4).prepared);
+
+    cache.erase("SELECT $1", int8);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_TRUE(cache.acquire("SELECT $1", int4).prepared);
+}